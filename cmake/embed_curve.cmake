@@ -0,0 +1,59 @@
+# Turns a text curve file into a header with a constexpr curve_table.
+# usage: cmake -DINPUT=<curve.txt> -DOUTPUT=<header.hpp> -DNAME=<identifier>
+#              -P embed_curve.cmake
+
+file(READ "${INPUT}" CURVE_TEXT)
+string(STRIP "${CURVE_TEXT}" CURVE_TEXT)
+string(REGEX REPLACE "[ \t\r\n]+" ";" CURVE_TOKENS "${CURVE_TEXT}")
+
+# <num control pts> <num samples>, control pts, samples
+list(GET CURVE_TOKENS 0 NUM_CONTROL_PTS)
+list(GET CURVE_TOKENS 1 NUM_SAMPLES)
+math(EXPR FIRST_SAMPLE "2 + 2 * ${NUM_CONTROL_PTS}")
+list(SUBLIST CURVE_TOKENS ${FIRST_SAMPLE} ${NUM_SAMPLES} SAMPLES)
+list(LENGTH SAMPLES NUM_READ)
+if(NOT NUM_READ EQUAL NUM_SAMPLES)
+    message(FATAL_ERROR "${INPUT}: expected ${NUM_SAMPLES} samples, got ${NUM_READ}")
+endif()
+
+set(CONTROL_PTS_TEXT "")
+if(NUM_CONTROL_PTS GREATER 0)
+    math(EXPR LAST_CONTROL_PT "${NUM_CONTROL_PTS} - 1")
+    foreach(I RANGE ${LAST_CONTROL_PT})
+        math(EXPR X_TOKEN "2 + 2 * ${I}")
+        math(EXPR Y_TOKEN "3 + 2 * ${I}")
+        list(GET CURVE_TOKENS ${X_TOKEN} X)
+        list(GET CURVE_TOKENS ${Y_TOKEN} Y)
+        string(APPEND CONTROL_PTS_TEXT "\n        {${X}, ${Y}},")
+    endforeach()
+endif()
+
+string(MAKE_C_IDENTIFIER "${NAME}" NAME)
+list(JOIN SAMPLES ",\n        " SAMPLES_TEXT)
+
+file(WRITE "${OUTPUT}.tmp"
+"// generated from ${INPUT} by embed_curve.cmake, do not edit
+#pragma once
+
+#include \"dynamics/curve_table.hpp\"
+
+namespace embedded_curves {
+
+inline constexpr curve_table<${NUM_SAMPLES}, ${NUM_CONTROL_PTS}> ${NAME} =
+    make_curve_table<${NUM_SAMPLES}, ${NUM_CONTROL_PTS}>(
+        {
+        ${SAMPLES_TEXT}
+        },
+        {{${CONTROL_PTS_TEXT}
+        }}
+    );
+
+} // namespace embedded_curves
+")
+# only touch the header when it actually changed
+# (file(COPY_FILE ... ONLY_IF_DIFFERENT) would need CMake 3.21)
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}"
+    COMMAND_ERROR_IS_FATAL ANY
+)
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,232 @@
+#include "flight_env.h"
+
+#include "dynamics/pch.hpp"
+
+#include "fleet/fleet.hpp"
+
+static thread_local std::string last_error;
+
+// uniform in [-1, 1], from splitmix64, so a reset depends only on the seed,
+// the environment and how often it was reset
+static float random_unit(uint64_t &state) {
+	uint64_t z  = (state += 0x9e3779b97f4a7c15ull);
+	z           = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z           = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	z          ^= z >> 31;
+	return static_cast<float>(z >> 40) / static_cast<float>(1 << 23) - 1.0f;
+}
+
+struct flight_env {
+	flight_env_config  config;
+	fleet              aircraft;
+	fleet_inputs       inputs;
+	work_stealing_pool pool;
+
+	std::vector<uint32_t> steps;  // since the last reset, per environment
+	std::vector<uint64_t> resets; // per environment
+
+	flight_env(const char *aircraft_path, const flight_env_config &config)
+	    : config(config), pool(config.num_threads) {
+		if (config.num_envs == 0 || config.substeps == 0 ||
+		    !(config.physics_step > 0.0f)) {
+			throw std::invalid_argument(
+			    "num_envs, substeps and physics_step must be > 0."
+			);
+		}
+		aircraft.init(aircraft_path, config.num_envs);
+		inputs.resize(config.num_envs);
+		steps.resize(config.num_envs);
+		resets.resize(config.num_envs);
+	}
+
+	void reset(size_t i) {
+		uint64_t rng = config.seed ^ (i * 0xd1b54a32d192ed03ull) ^
+		               (resets[i]++ * 0x8cb92ba72f3d8dd7ull);
+		float altitude_factor = 1.0f + config.start_jitter * random_unit(rng);
+		float speed_factor    = 1.0f + config.start_jitter * random_unit(rng);
+
+		rigid_body body;
+		body.pos.z = config.start_altitude * altitude_factor;
+		body.vel.x = config.start_speed * speed_factor;
+		aircraft.reset(i, body);
+		inputs.set(i, control_input());
+		steps[i] = 0;
+	}
+
+	void write_obs(size_t i, float *obs) const {
+		const fleet_state &s        = aircraft.get_state();
+		rigid_body         body     = aircraft.get_body(i);
+		glm::vec3          vel      = body.to_body(body.vel);
+		glm::vec3          w        = body.to_body(body.ang_vel);
+		float              max_fuel = aircraft.get_def().mass.max_fuel;
+
+		float *row = obs + i * FLIGHT_ENV_OBS_DIM;
+		row[0]     = s.pos_z[i];
+		row[1]     = vel.x;
+		row[2]     = vel.y;
+		row[3]     = vel.z;
+		row[4]     = w.x;
+		row[5]     = w.y;
+		row[6]     = w.z;
+		row[7]     = s.rot_w[i];
+		row[8]     = s.rot_x[i];
+		row[9]     = s.rot_y[i];
+		row[10]    = s.rot_z[i];
+		row[11]    = s.throttle[i];
+		row[12]    = max_fuel > 0.0f ? s.fuel[i] / max_fuel : 0.0f;
+	}
+
+	// reward and done of one environment after a step
+	void score(size_t i, float *rewards, uint8_t *dones) {
+		const fleet_state &s = aircraft.get_state();
+		glm::vec3          vel(s.vel_x[i], s.vel_y[i], s.vel_z[i]);
+		glm::vec3          w(s.ang_vel_x[i], s.ang_vel_y[i], s.ang_vel_z[i]);
+		float              altitude = s.pos_z[i];
+		float              airspeed = glm::length(vel);
+
+		steps[i]++;
+		bool blew_up = !std::isfinite(altitude) || !std::isfinite(airspeed);
+		if (blew_up || altitude < config.min_altitude) {
+			rewards[i] = config.crash_reward;
+			dones[i]   = FLIGHT_ENV_TERMINATED;
+			return;
+		}
+		rewards[i] = -std::abs(altitude - config.target_altitude) / 100.0f -
+		             std::abs(airspeed - config.target_speed) / 50.0f -
+		             0.1f * glm::length(w);
+		dones[i] = config.max_steps && steps[i] >= config.max_steps
+		               ? FLIGHT_ENV_TRUNCATED
+		               : FLIGHT_ENV_RUNNING;
+	}
+};
+
+// runs f, turning exceptions into -1 and last_error
+template <typename F> static int guarded(F &&f) {
+	try {
+		f();
+		return 0;
+	} catch (const std::exception &e) {
+		last_error = e.what();
+	} catch (...) {
+		last_error = "unknown error";
+	}
+	return -1;
+}
+
+// enough environments per chunk to be worth taking, enough chunks to steal
+static constexpr size_t grain = 64;
+
+extern "C" {
+
+void flight_env_default_config(flight_env_config *config) {
+	*config = flight_env_config{
+	    .num_envs        = 64,
+	    .num_threads     = 0,
+	    .physics_step    = 1.0f / 1000.0f,
+	    .substeps        = 10,
+	    .max_steps       = 1000,
+	    .start_altitude  = 1000.0f,
+	    .start_speed     = 150.0f,
+	    .start_jitter    = 0.0f,
+	    .seed            = 0,
+	    .target_altitude = 1000.0f,
+	    .target_speed    = 150.0f,
+	    .min_altitude    = 50.0f,
+	    .crash_reward    = -100.0f,
+	};
+}
+
+flight_env *
+flight_env_create(const char *aircraft_path, const flight_env_config *config) {
+	flight_env *env = nullptr;
+	guarded([&] {
+		if (!aircraft_path || !config) {
+			throw std::invalid_argument("Need an aircraft and a config.");
+		}
+		env = new flight_env(aircraft_path, *config);
+	});
+	return env;
+}
+
+void flight_env_destroy(flight_env *env) {
+	delete env;
+}
+
+uint32_t flight_env_num_envs(const flight_env *env) {
+	return env ? env->config.num_envs : 0;
+}
+
+int flight_env_reset(flight_env *env, const uint8_t *mask, float *obs) {
+	return guarded([&] {
+		if (!env || !obs) {
+			throw std::invalid_argument("Need an environment and obs.");
+		}
+		env->pool.parallel_for(
+		    env->config.num_envs,
+		    grain,
+		    [&](size_t begin, size_t end, size_t) {
+			    for (size_t i = begin; i < end; ++i) {
+				    if (!mask || mask[i]) {
+					    env->reset(i);
+					    env->write_obs(i, obs);
+				    }
+			    }
+		    }
+		);
+	});
+}
+
+int flight_env_step(
+    flight_env *env, const float *actions, float *obs, float *rewards,
+    uint8_t *dones
+) {
+	return guarded([&] {
+		if (!env || !actions || !obs || !rewards || !dones) {
+			throw std::invalid_argument("Need every buffer.");
+		}
+		// std::clamp() passes NaN through, into every state it touches
+		size_t count = env->config.num_envs * FLIGHT_ENV_ACTION_DIM;
+		for (size_t j = 0; j < count; ++j) {
+			if (!std::isfinite(actions[j])) {
+				throw std::invalid_argument(
+				    "Action " + std::to_string(j % FLIGHT_ENV_ACTION_DIM) +
+				    " of environment " +
+				    std::to_string(j / FLIGHT_ENV_ACTION_DIM) +
+				    " isn't finite."
+				);
+			}
+		}
+		for (size_t i = 0; i < env->config.num_envs; ++i) {
+			const float  *a = actions + i * FLIGHT_ENV_ACTION_DIM;
+			control_input input;
+			input.throttle    = std::clamp(a[0], 0.0f, 1.0f);
+			input.pitch_down  = std::clamp(a[1], -1.0f, 1.0f);
+			input.roll_right  = std::clamp(a[2], -1.0f, 1.0f);
+			input.rudder_left = std::clamp(a[3], -1.0f, 1.0f);
+			env->inputs.set(i, input);
+		}
+
+		env->aircraft.step(
+		    env->inputs,
+		    env->config.physics_step,
+		    env->pool,
+		    static_cast<int>(env->config.substeps)
+		);
+
+		env->pool.parallel_for(
+		    env->config.num_envs,
+		    grain,
+		    [&](size_t begin, size_t end, size_t) {
+			    for (size_t i = begin; i < end; ++i) {
+				    env->write_obs(i, obs);
+				    env->score(i, rewards, dones);
+			    }
+		    }
+		);
+	});
+}
+
+const char *flight_env_last_error(void) {
+	return last_error.c_str();
+}
+}
@@ -0,0 +1,125 @@
+/*
+ * Vectorized flight environments behind a plain C ABI, for training control
+ * policies. One flight_env holds num_envs aircraft of one type, stepped
+ * together across all cores by the fleet engine.
+ *
+ * Every buffer belongs to the caller and is read or written in place, one
+ * contiguous row per environment:
+ *
+ *   actions  float   [num_envs][FLIGHT_ENV_ACTION_DIM]
+ *   obs      float   [num_envs][FLIGHT_ENV_OBS_DIM]
+ *   rewards  float   [num_envs]
+ *   dones    uint8_t [num_envs]
+ *   mask     uint8_t [num_envs]
+ *
+ * so C-contiguous NumPy arrays can be passed as they are, e.g. with
+ * obs.ctypes.data_as(ctypes.POINTER(ctypes.c_float)) and ctypes.CDLL.
+ *
+ * Functions returning int return 0 on success and -1 on failure, with the
+ * reason in flight_env_last_error(). A flight_env may be used by one thread
+ * at a time.
+ */
+
+#ifndef FLIGHT_ENV_H
+#define FLIGHT_ENV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define FLIGHT_ENV_API __declspec(dllexport)
+#else
+#define FLIGHT_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Actions, clamped to their ranges. A NaN or infinite one fails the step
+ * before any environment moves:
+ *   0 throttle     (0, 1)
+ *   1 pitch down   (-1, 1)
+ *   2 roll right   (-1, 1)
+ *   3 rudder left  (-1, 1)
+ */
+#define FLIGHT_ENV_ACTION_DIM 4
+
+/*
+ * Observations:
+ *   0      altitude, m
+ *   1..3   velocity in the body frame (forward, left, up), m/s
+ *   4..6   angular velocity in the body frame, rad/s
+ *   7..10  attitude quaternion w, x, y, z
+ *   11     throttle
+ *   12     fuel left, fraction of full tanks
+ */
+#define FLIGHT_ENV_OBS_DIM 13
+
+/* values in dones */
+#define FLIGHT_ENV_RUNNING 0
+#define FLIGHT_ENV_TERMINATED 1 /* below min_altitude or state blew up */
+#define FLIGHT_ENV_TRUNCATED 2  /* max_steps reached */
+
+typedef struct flight_env flight_env;
+
+/*
+ * Reward per step, for holding an altitude and an airspeed:
+ *
+ *   -|altitude - target_altitude| / 100 - |airspeed - target_speed| / 50
+ *   - 0.1 * |angular velocity|
+ *
+ * or crash_reward on the step an environment terminates.
+ */
+typedef struct flight_env_config {
+	uint32_t num_envs;
+	uint32_t num_threads;  /* 0 for one per hardware thread */
+	float    physics_step; /* s */
+	uint32_t substeps;     /* physics steps per flight_env_step() */
+	uint32_t max_steps;    /* flight_env_step()s until truncated, 0 never */
+
+	/* level flight along +x after a reset, each scaled by a random
+	   factor in [1 - start_jitter, 1 + start_jitter] */
+	float    start_altitude; /* m */
+	float    start_speed;    /* m/s */
+	float    start_jitter;
+	uint64_t seed;
+
+	float target_altitude; /* m */
+	float target_speed;    /* m/s */
+	float min_altitude;    /* m, terminated below */
+	float crash_reward;
+} flight_env_config;
+
+/* 64 environments, 1 ms physics, 10 substeps, 1000 steps, 1000 m at 150 m/s */
+FLIGHT_ENV_API void flight_env_default_config(flight_env_config *config);
+
+/* aircraft_path is an .acb or .aircraft file. NULL on failure. Call
+   flight_env_reset() before the first step. */
+FLIGHT_ENV_API flight_env *
+flight_env_create(const char *aircraft_path, const flight_env_config *config);
+
+FLIGHT_ENV_API void flight_env_destroy(flight_env *env);
+
+FLIGHT_ENV_API uint32_t flight_env_num_envs(const flight_env *env);
+
+/* Resets the environments with mask[i] != 0, all of them if mask is NULL,
+   and writes their observations. Rows of the others are left alone. */
+FLIGHT_ENV_API int
+flight_env_reset(flight_env *env, const uint8_t *mask, float *obs);
+
+/* Steps every environment, finished ones included, until they're reset. */
+FLIGHT_ENV_API int flight_env_step(
+    flight_env *env, const float *actions, float *obs, float *rewards,
+    uint8_t *dones
+);
+
+/* why the last call on this thread failed */
+FLIGHT_ENV_API const char *flight_env_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
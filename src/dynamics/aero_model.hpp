@@ -0,0 +1,317 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "fastmath.hpp"
+#include "wing.hpp"
+#include "wing_3d_helper.hpp"
+
+// All lifting surfaces of an aircraft flattened into structure-of-arrays
+// form and evaluated together, instead of one calc_wing_forces_3d() call per
+// surface. Results match the per-surface path to float rounding.
+//
+// Every stage is one loop over all sections (or forces) with no per-surface
+// calls, but the sections still read their surface's frame and root through
+// an index and do vec3 math, so the loops run scalar. Only the aoa stage is
+// batched for SIMD, through sim_atan2_many().
+template <typename T> class basic_aero_model {
+public:
+	using vec3              = glm::vec<3, T>;
+	using quat              = glm::qua<T>;
+	using wing_force_vec_3d = basic_wing_force_vec_3d<T>;
+
+	struct surface_controls {
+		T incidence_deg = T(0);
+		T aileron_deg   = T(0);
+		T flap_deg      = T(0);
+		T slat_deg      = T(0);
+	};
+
+	struct totals {
+		vec3 force  = vec3(0); // in the body frame
+		vec3 torque = vec3(0); // about the center of mass
+	};
+
+	// Copies what it needs from the wing (geometry and airfoil handle),
+	// surfaces are evaluated in the order they were added. Conventions are
+	// the ones of calc_wing_forces_3d().
+	size_t add_surface(
+	    const basic_wing<T> &wing,
+	    vec3                 root_pos,
+	    bool                 is_right_wing,
+	    vec3                 incidence_axis = vec3(0, -1, 0)
+	) {
+		const basic_wing_geometry<T>    &geo      = wing.get_geometry();
+		const std::vector<wing_section> &sections = wing.get_sections();
+		size_t                           n        = sections.size();
+		T                                side     = is_right_wing ? -1 : 1;
+
+		surface surf;
+		surf.airfoil_               = wing.get_airfoil();
+		surf.root_pos               = root_pos;
+		surf.incidence_axis         = incidence_axis;
+		surf.side                   = side;
+		surf.induced_slot           = num_forces_ + 2 * n;
+		surf.total_area             = geo.total_area;
+		surf.inv_total_area         = geo.inv_total_area;
+		surf.induced_drag_factor    = geo.induced_drag_factor;
+		surf.induced_origin_forward = -geo.induced_drag_chordwise;
+		surf.induced_origin_left    = side * geo.total_span * T(0.5);
+
+		for (size_t i = 0; i < n; ++i) {
+			section_surface.push_back(static_cast<uint32_t>(surfaces.size()));
+			section_lift_slot.push_back(num_forces_ + i);
+			section_drag_slot.push_back(num_forces_ + n + i);
+			section_left.push_back(side * geo.center_spanwise[i]);
+			section_center_forward.push_back(-geo.center_chordwise[i]);
+			section_lift_forward.push_back(-geo.lift_chordwise[i]);
+			section_drag_forward.push_back(-geo.drag_chordwise[i]);
+			section_area.push_back(geo.areas[i]);
+			section_aileron_mask.push_back(sections[i].has_aileron);
+			section_flap_mask.push_back(sections[i].has_flap);
+			section_slat_mask.push_back(sections[i].has_slat);
+		}
+		surfaces.push_back(surf);
+		num_forces_ += 2 * n + 1;
+
+		// per-step buffers, sized here so that evaluate() doesn't allocate
+		size_t num_sections = section_surface.size();
+		section_move_dir.resize(num_sections);
+		section_speed.resize(num_sections);
+		section_cos_up.resize(num_sections);
+		section_cos_forward.resize(num_sections);
+		section_aoa.resize(num_sections);
+		section_lift.resize(num_sections);
+		section_drag.resize(num_sections);
+		force_vec.resize(num_forces_);
+		force_origin.resize(num_forces_);
+
+		return surfaces.size() - 1;
+	}
+
+	size_t num_surfaces() const {
+		return surfaces.size();
+	}
+
+	size_t num_sections() const {
+		return section_surface.size();
+	}
+
+	// sectional lift and drag for every section + induced drag per surface
+	size_t num_forces() const {
+		return num_forces_;
+	}
+
+	// forces of the last evaluate(), per surface in gather_wing_forces_3d()
+	// order (sectional lift, sectional drag, induced drag)
+	wing_force_vec_3d get_force(size_t i) const {
+		return {force_vec.get(i), force_origin.get(i)};
+	}
+
+	totals evaluate(
+	    std::span<const surface_controls> controls,
+	    vec3                              linear_velocity,
+	    vec3                              angular_velocity,
+	    vec3                              center_of_mass,
+	    T                                 air_density = T(1.225)
+	) {
+		if (controls.size() != surfaces.size()) {
+			throw std::invalid_argument("need controls for every surface");
+		}
+
+		// surface frames
+		for (size_t s = 0; s < surfaces.size(); ++s) {
+			surface &surf = surfaces[s];
+			quat     rot  = glm::normalize(glm::angleAxis(
+                glm::radians(controls[s].incidence_deg), surf.incidence_axis
+            ));
+			surf.dirs.forward  = rot * vec3(1, 0, 0);
+			surf.dirs.left     = rot * vec3(0, 1, 0);
+			surf.dirs.up       = rot * vec3(0, 0, 1);
+			surf.mean_cl       = T(0);
+			surf.mean_speed    = T(0);
+			surf.mean_move_dir = vec3(0);
+		}
+
+		// sectional airspeed and aoa
+		for (size_t i = 0; i < section_surface.size(); ++i) {
+			const surface &surf   = surfaces[section_surface[i]];
+			const frame   &f      = surf.dirs;
+			vec3           center = f.forward * section_center_forward[i] +
+			                        f.left * section_left[i] + surf.root_pos;
+			vec3 vel = wing_local_velocity(
+			    center, linear_velocity, angular_velocity, center_of_mass
+			);
+			section_move_dir.set(i, sim_normalize(vel));
+
+			vec3 vel_in_plane = vel - glm::dot(vel, f.left) * f.left;
+			vec3 dir          = sim_normalize(vel_in_plane);
+			T    cos_forward  = glm::dot(f.forward, dir);
+			T    cos_up       = glm::dot(f.up, dir);
+			cos_forward       = std::isnan(cos_forward)
+			                      ? T(1)
+			                      : std::clamp(cos_forward, T(-1), T(1));
+			cos_up =
+			    std::isnan(cos_up) ? T(0) : std::clamp(cos_up, T(-1), T(1));
+
+			section_speed[i]       = glm::length(vel_in_plane);
+			section_cos_up[i]      = cos_up;
+			section_cos_forward[i] = cos_forward;
+		}
+
+		// aoa as one batch, so that fast math can run it in SIMD
+		sim_atan2_many<T>(section_cos_up, section_cos_forward, section_aoa);
+		for (size_t i = 0; i < section_surface.size(); ++i) {
+			section_aoa[i] = -glm::degrees(section_aoa[i]);
+		}
+
+		// coefficients and force magnitudes
+		for (size_t i = 0; i < section_surface.size(); ++i) {
+			surface                &surf = surfaces[section_surface[i]];
+			const surface_controls &c    = controls[section_surface[i]];
+			T control = section_aileron_mask[i] * c.aileron_deg +
+			            section_flap_mask[i] * c.flap_deg;
+			auto [cl, cd] = surf.airfoil_->calc_coeffs(
+			    section_aoa[i], control, section_slat_mask[i] * c.slat_deg
+			);
+
+			T speed         = section_speed[i];
+			T area          = section_area[i];
+			T q             = air_density * speed * speed * T(0.5);
+			section_lift[i] = cl * q * area;
+			section_drag[i] = cd * q * area;
+
+			// area weighted means for induced drag
+			if (q != T(0)) {
+				surf.mean_cl += cl * area;
+			}
+			surf.mean_speed    += speed * area;
+			surf.mean_move_dir += section_move_dir.get(i) * area;
+		}
+
+		// sectional 3d forces
+		for (size_t i = 0; i < section_surface.size(); ++i) {
+			const surface &surf = surfaces[section_surface[i]];
+			const frame   &f    = surf.dirs;
+			vec3           root = surf.root_pos;
+			auto [lift_dir, drag_dir] =
+			    wing_force_dirs(section_move_dir.get(i), f.left);
+			vec3 lift_origin = f.forward * section_lift_forward[i] +
+			                   f.left * section_left[i] + root;
+			vec3 drag_origin = f.forward * section_drag_forward[i] +
+			                   f.left * section_left[i] + root;
+
+			force_vec.set(section_lift_slot[i], section_lift[i] * lift_dir);
+			force_origin.set(section_lift_slot[i], lift_origin);
+			force_vec.set(section_drag_slot[i], section_drag[i] * drag_dir);
+			force_origin.set(section_drag_slot[i], drag_origin);
+		}
+
+		// induced drag, see wing::calc_forces()
+		for (const surface &surf : surfaces) {
+			T mean_cl    = surf.mean_cl * surf.inv_total_area;
+			T mean_speed = surf.mean_speed * surf.inv_total_area;
+			T cd         = mean_cl * mean_cl * surf.induced_drag_factor;
+			T q_mean     = air_density * mean_speed * mean_speed * T(0.5);
+			T drag       = cd * q_mean * surf.total_area / T(2);
+
+			const frame &f        = surf.dirs;
+			vec3         move_dir = surf.mean_move_dir * surf.inv_total_area;
+			vec3         drag_dir = wing_force_dirs(move_dir, f.left).second;
+			vec3         origin   = f.forward * surf.induced_origin_forward +
+			                f.left * surf.induced_origin_left + surf.root_pos;
+			force_vec.set(surf.induced_slot, drag * drag_dir);
+			force_origin.set(surf.induced_slot, origin);
+		}
+
+		// total force and torque
+		totals result;
+		for (size_t i = 0; i < num_forces_; ++i) {
+			vec3 force     = force_vec.get(i);
+			vec3 r         = force_origin.get(i) - center_of_mass;
+			result.force  += force;
+			result.torque += glm::cross(r, force);
+		}
+		return result;
+	}
+
+private:
+	struct frame {
+		vec3 forward = vec3(1, 0, 0);
+		vec3 left    = vec3(0, 1, 0);
+		vec3 up      = vec3(0, 0, 1);
+	};
+
+	struct surface {
+		airfoil_handle airfoil_;
+		vec3           root_pos               = vec3(0);
+		vec3           incidence_axis         = vec3(0, -1, 0);
+		T              side                   = T(1); // -1 for right wings
+		size_t         induced_slot           = 0;
+		T              total_area             = T(0);
+		T              inv_total_area         = T(0);
+		T              induced_drag_factor    = T(0);
+		T              induced_origin_forward = T(0);
+		T              induced_origin_left    = T(0);
+
+		// per step
+		frame dirs;
+		T     mean_cl       = T(0);
+		T     mean_speed    = T(0);
+		vec3  mean_move_dir = vec3(0);
+	};
+
+	struct vec3_array {
+		std::vector<T> x, y, z;
+
+		void resize(size_t n) {
+			x.resize(n);
+			y.resize(n);
+			z.resize(n);
+		}
+
+		vec3 get(size_t i) const {
+			return {x[i], y[i], z[i]};
+		}
+
+		void set(size_t i, vec3 v) {
+			x[i] = v.x;
+			y[i] = v.y;
+			z[i] = v.z;
+		}
+	};
+
+	std::vector<surface> surfaces;
+	size_t               num_forces_ = 0;
+
+	// per section, fixed
+	std::vector<uint32_t> section_surface;
+	std::vector<size_t>   section_lift_slot;
+	std::vector<size_t>   section_drag_slot;
+	std::vector<T>        section_left; // spanwise, sign flipped on the right
+	std::vector<T>        section_center_forward;
+	std::vector<T>        section_lift_forward;
+	std::vector<T>        section_drag_forward;
+	std::vector<T>        section_area;
+	std::vector<T>        section_aileron_mask; // 0 or 1
+	std::vector<T>        section_flap_mask;
+	std::vector<T>        section_slat_mask;
+
+	// per section, per step
+	vec3_array     section_move_dir;
+	std::vector<T> section_speed;
+	std::vector<T> section_cos_up;
+	std::vector<T> section_cos_forward;
+	std::vector<T> section_aoa;
+	std::vector<T> section_lift;
+	std::vector<T> section_drag;
+
+	// per force, per step
+	vec3_array force_vec;
+	vec3_array force_origin;
+};
+
+using aero_model = basic_aero_model<float>;
+
+extern template class basic_aero_model<float>;
+extern template class basic_aero_model<double>;
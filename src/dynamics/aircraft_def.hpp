@@ -0,0 +1,857 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "aero_model.hpp"
+#include "airfoil.hpp"
+#include "mapped_file.hpp"
+#include "wing.hpp"
+
+// Airframe description: mass, engine, airfoils, wings, and where the wings
+// are mounted together with their control mixing. Loaded either from a text
+// .aircraft file or from the binary .acb form written by
+// tools/aircraft_compiler, load_from_file() tells them apart by the magic.
+//
+// TEXT FORMAT: one statement per line, '#' starts a comment. Blocks are
+// opened by `mass`, `engine`, `airfoil <name>`, `wing <name>` or
+// `surface <name>` and closed by `end`. Names have to be defined before they
+// are referenced. See aircraft/su34.aircraft for every statement.
+//
+// BINARY FORMAT (little-endian): file_header, the aircraft name, mass_props,
+// engine_props, then the airfoil, wing, section and surface arrays. Records
+// are stored exactly as the structs below, so loading is a size check and a
+// memcpy per array.
+class aircraft_def {
+public:
+	static constexpr char     magic[4]  = {'A', 'C', 'F', 'T'};
+	static constexpr uint32_t version   = 3;
+	static constexpr size_t   name_size = 32;
+	static constexpr size_t   path_size = 128;
+
+	// pilot inputs the control mixing gains apply to
+	enum input : uint32_t {
+		input_pitch, // pitch down, [-1, 1]
+		input_roll,  // roll right, [-1, 1]
+		input_yaw,   // rudder left, [-1, 1]
+		input_flaps, // 0 or 1
+		num_inputs
+	};
+
+	// per surface outputs of the control mixing, all in degrees
+	enum channel : uint32_t {
+		channel_incidence,
+		channel_aileron,
+		channel_flap,
+		channel_slat,
+		num_channels
+	};
+
+	// see mass_properties for how empty and fuel are combined
+	struct mass_props {
+		float     empty_mass     = 0.0f;            // kg
+		float     max_fuel       = 0.0f;            // kg
+		glm::vec3 center_of_mass = glm::vec3(0.0f); // m, empty
+		glm::vec3 inertia        = glm::vec3(0.0f); // principal, kg m^2, empty
+		glm::vec3 fuel_center    = glm::vec3(0.0f); // m, center of the fuel
+		glm::vec3 fuel_inertia   = glm::vec3(0.0f); // principal, full tanks
+	};
+
+	struct engine_props {
+		float     max_thrust_dry = 0.0f;            // N
+		float     max_thrust_wet = 0.0f;            // N, afterburner
+		glm::vec3 position       = glm::vec3(0.0f); // thrust origin
+		float     incidence_deg  = 0.0f;            // nose-down tilt
+		float     throttle_rate  = 0.5f;            // units/s
+		float     tsfc_dry       = 0.0f;            // kg/(N s) of fuel
+		float     tsfc_wet       = 0.0f;            // kg/(N s), afterburner
+	};
+
+	// parameters of the airfoil() constructor, with the same defaults
+	struct airfoil_def {
+		char     name[name_size]     = {};
+		char     curve[path_size]    = {}; // file, embedded:<name> or
+		                                   // pack:<file>:<name>
+		float    curve_max_cl        = 2.4f;
+		float    curve_max_aoa_deg   = 30.0f;
+		float    sweep_deg           = 40.0f;
+		float    flap_eff_per_deg    = 0.015f;
+		float    slat_eff_per_deg    = 0.015f;
+		float    base_cd             = 0.02f;
+		float    cd_aoa2_scale       = 0.0002f;
+		float    flap_cd_eff_per_deg = 0.001f;
+		float    slat_cd_eff_per_deg = 0.001f;
+		uint32_t spline              = 0; // through the control points
+		uint32_t coeff_table[3]      = {}; // aoa, flap, slat points of a
+		                                   // baked table, 0: analytic
+
+		// what a file may ask bake_coeff_table() for, per axis and in all,
+		// the latter 32 MB of (cl, cd)
+		static constexpr uint32_t max_table_points  = 4096;
+		static constexpr uint64_t max_table_entries = uint64_t(1) << 22;
+
+		airfoil build(curve_handle cl_vs_aoa_source) const {
+			airfoil result(
+			    std::move(cl_vs_aoa_source),
+			    curve_max_cl,
+			    curve_max_aoa_deg,
+			    sweep_deg,
+			    flap_eff_per_deg,
+			    slat_eff_per_deg,
+			    base_cd,
+			    cd_aoa2_scale,
+			    flap_cd_eff_per_deg,
+			    slat_cd_eff_per_deg,
+			    spline ? curve::interpolation::cubic_spline
+			           : curve::interpolation::linear_samples
+			);
+			if (coeff_table[0] != 0) {
+				result.bake_coeff_table({
+				    .num_aoa  = coeff_table[0],
+				    .num_flap = coeff_table[1],
+				    .num_slat = coeff_table[2],
+				});
+			}
+			return result;
+		}
+	};
+
+	struct section_def {
+		float   span            = 0.0f;
+		float   chord           = 0.0f;
+		float   chordwise_shift = 0.0f;
+		uint8_t has_aileron     = 0;
+		uint8_t has_flap        = 0;
+		uint8_t has_slat        = 0;
+		uint8_t reserved        = 0;
+	};
+
+	struct wing_def {
+		char     name[name_size] = {};
+		uint32_t airfoil         = 0; // index into airfoils
+		uint32_t first_section   = 0; // index into sections
+		uint32_t num_sections    = 0;
+		float    span_efficiency = 0.85f;
+	};
+
+	// output = base + sum(gains[input] * input value)
+	struct control_mix {
+		float base              = 0.0f;
+		float gains[num_inputs] = {};
+	};
+
+	struct surface_def {
+		char        name[name_size] = {};
+		uint32_t    wing            = 0; // index into wings
+		uint32_t    is_right_wing   = 0;
+		glm::vec3   root_pos        = glm::vec3(0.0f);
+		glm::vec3   incidence_axis  = glm::vec3(0.0f, -1.0f, 0.0f);
+		control_mix mix[num_channels];
+	};
+
+	struct file_header {
+		char     magic[4];
+		uint32_t version;
+		uint32_t num_airfoils;
+		uint32_t num_wings;
+		uint32_t num_sections;
+		uint32_t num_surfaces;
+		uint32_t record_sizes[6]; // mass, engine, airfoil, wing, section,
+		                          // surface; catches layout changes
+	};
+
+	static_assert(sizeof(glm::vec3) == 3 * sizeof(float));
+	static_assert(std::is_trivially_copyable_v<surface_def>);
+	static_assert(
+	    std::endian::native == std::endian::little,
+	    "aircraft binaries are little-endian"
+	);
+
+	char                     name[name_size] = {};
+	mass_props               mass;
+	engine_props             engine;
+	std::vector<airfoil_def> airfoils;
+	std::vector<wing_def>    wings;
+	std::vector<section_def> sections;
+	std::vector<surface_def> surfaces;
+
+	void load_from_file(const std::filesystem::path &path) {
+		mapped_file file;
+		file.open(path);
+		if (file.size() >= sizeof(magic) &&
+		    std::memcmp(file.data(), magic, sizeof(magic)) == 0) {
+			load_from_binary({file.data(), file.size()}, path.string());
+		} else {
+			std::string_view text(
+			    reinterpret_cast<const char *>(file.data()), file.size()
+			);
+			load_from_text(text, path.string());
+		}
+	}
+
+	void load_from_text(std::string_view text, const std::string &source) {
+		aircraft_def def;
+		def.parse_text(text, source);
+		def.throw_if_invalid(source);
+		*this = std::move(def);
+	}
+
+	void load_from_binary(
+	    std::span<const uint8_t> data, const std::string &source
+	) {
+		auto fail = [&](const std::string &what) {
+			return std::runtime_error(
+			    "Invalid aircraft binary " + source + ": " + what
+			);
+		};
+
+		file_header hdr;
+		if (data.size() < sizeof(hdr)) {
+			throw fail("too small");
+		}
+		std::memcpy(&hdr, data.data(), sizeof(hdr));
+		if (std::memcmp(hdr.magic, magic, sizeof(magic)) != 0) {
+			throw fail("bad magic");
+		}
+		if (hdr.version != version ||
+		    !std::equal(
+		        std::begin(hdr.record_sizes),
+		        std::end(hdr.record_sizes),
+		        std::begin(record_sizes)
+		    )) {
+			throw fail("unsupported version");
+		}
+
+		aircraft_def def;
+		size_t       offset = sizeof(hdr);
+		auto         read   = [&](void *dst, size_t size) {
+            if (data.size() - offset < size) {
+                throw fail("truncated");
+            }
+            std::memcpy(dst, data.data() + offset, size);
+            offset += size;
+		};
+		auto read_array = [&](auto &vec, uint32_t count) {
+			// checked before resizing, a bad count mustn't allocate
+			if ((data.size() - offset) / sizeof(vec[0]) < count) {
+				throw fail("truncated");
+			}
+			vec.resize(count);
+			read(vec.data(), count * sizeof(vec[0]));
+		};
+		read(def.name, sizeof(def.name));
+		read(&def.mass, sizeof(def.mass));
+		read(&def.engine, sizeof(def.engine));
+		read_array(def.airfoils, hdr.num_airfoils);
+		read_array(def.wings, hdr.num_wings);
+		read_array(def.sections, hdr.num_sections);
+		read_array(def.surfaces, hdr.num_surfaces);
+		if (offset != data.size()) {
+			throw fail("trailing data");
+		}
+
+		// names are read as C strings from here on
+		auto check_name = [&](const auto &field, const std::string &what) {
+			if (field[sizeof(field) - 1] != '\0') {
+				throw fail(what + " not terminated");
+			}
+		};
+		check_name(def.name, "name");
+		for (const airfoil_def &a : def.airfoils) {
+			check_name(a.name, "airfoil name");
+			check_name(a.curve, "airfoil curve");
+		}
+		for (const wing_def &w : def.wings) {
+			check_name(w.name, "wing name");
+		}
+		for (const surface_def &s : def.surfaces) {
+			check_name(s.name, "surface name");
+		}
+
+		def.throw_if_invalid(source);
+		*this = std::move(def);
+	}
+
+	std::vector<uint8_t> save_to_binary() const {
+		file_header hdr = {};
+		std::memcpy(hdr.magic, magic, sizeof(magic));
+		hdr.version      = version;
+		hdr.num_airfoils = static_cast<uint32_t>(airfoils.size());
+		hdr.num_wings    = static_cast<uint32_t>(wings.size());
+		hdr.num_sections = static_cast<uint32_t>(sections.size());
+		hdr.num_surfaces = static_cast<uint32_t>(surfaces.size());
+		std::copy(
+		    std::begin(record_sizes),
+		    std::end(record_sizes),
+		    std::begin(hdr.record_sizes)
+		);
+
+		std::vector<uint8_t> data;
+		auto                 write = [&](const void *src, size_t size) {
+            const uint8_t *bytes = static_cast<const uint8_t *>(src);
+            data.insert(data.end(), bytes, bytes + size);
+		};
+		write(&hdr, sizeof(hdr));
+		write(name, sizeof(name));
+		write(&mass, sizeof(mass));
+		write(&engine, sizeof(engine));
+		write(airfoils.data(), airfoils.size() * sizeof(airfoil_def));
+		write(wings.data(), wings.size() * sizeof(wing_def));
+		write(sections.data(), sections.size() * sizeof(section_def));
+		write(surfaces.data(), surfaces.size() * sizeof(surface_def));
+		return data;
+	}
+
+	// every problem found, empty if the definition is usable
+	std::vector<std::string> validate() const {
+		std::vector<std::string> errors;
+		auto error = [&](const std::string &where, const std::string &what) {
+			errors.push_back(where + ": " + what);
+		};
+
+		// comparisons are written so that NaN fails them, binaries don't go
+		// through parse_float()
+		if (!(mass.empty_mass > 0.0f && mass.max_fuel >= 0.0f)) {
+			error("mass", "empty_mass must be > 0 and max_fuel >= 0");
+		}
+		glm::vec3 inertia = mass.inertia;
+		if (!(inertia.x > 0.0f && inertia.y > 0.0f && inertia.z > 0.0f)) {
+			error("mass", "inertia must be > 0 on every axis");
+		}
+		glm::vec3 fuel = mass.fuel_inertia;
+		if (!(fuel.x >= 0.0f && fuel.y >= 0.0f && fuel.z >= 0.0f)) {
+			error("mass", "fuel_inertia must be >= 0 on every axis");
+		}
+		if (!is_finite(mass.center_of_mass) || !is_finite(mass.fuel_center)) {
+			error("mass", "center_of_mass and fuel_center must be finite");
+		}
+		if (!(engine.max_thrust_dry >= 0.0f &&
+		      engine.max_thrust_wet >= engine.max_thrust_dry)) {
+			error("engine", "need 0 <= max_thrust_dry <= max_thrust_wet");
+		}
+		if (!(engine.throttle_rate > 0.0f)) {
+			error("engine", "throttle_rate must be > 0");
+		}
+		if (!(engine.tsfc_dry >= 0.0f && engine.tsfc_wet >= 0.0f)) {
+			error("engine", "tsfc_dry and tsfc_wet must be >= 0");
+		}
+		if (!is_finite(engine.position) ||
+		    !std::isfinite(engine.incidence_deg)) {
+			error("engine", "position and incidence must be finite");
+		}
+
+		for (const airfoil_def &a : airfoils) {
+			std::string where = "airfoil " + std::string(a.name);
+			if (a.curve[0] == '\0') {
+				error(where, "missing curve");
+			}
+			if (!(a.curve_max_cl > 0.0f && a.curve_max_aoa_deg > 0.0f)) {
+				error(where, "curve ranges must be > 0");
+			}
+			float params[] = {
+			    a.sweep_deg,
+			    a.flap_eff_per_deg,
+			    a.slat_eff_per_deg,
+			    a.base_cd,
+			    a.cd_aoa2_scale,
+			    a.flap_cd_eff_per_deg,
+			    a.slat_cd_eff_per_deg,
+			};
+			if (!std::all_of(std::begin(params), std::end(params), [](float x) {
+				    return std::isfinite(x);
+			    })) {
+				error(where, "parameters must be finite");
+			}
+			if (a.spline > 1) {
+				error(where, "spline must be 0 or 1");
+			}
+			const uint32_t *table = a.coeff_table;
+			if (table[0] != 0) {
+				auto [fewest, most] =
+				    std::minmax({table[0], table[1], table[2]});
+				uint64_t entries = uint64_t(table[0]) * table[1] * table[2];
+				if (fewest < 2 || most > airfoil_def::max_table_points) {
+					error(where, "coeff_table needs 2 to 4096 points per axis");
+				} else if (entries > airfoil_def::max_table_entries) {
+					error(where, "coeff_table has too many entries");
+				}
+			}
+		}
+
+		for (const wing_def &w : wings) {
+			std::string where = "wing " + std::string(w.name);
+			if (w.airfoil >= airfoils.size()) {
+				error(where, "airfoil index out of range");
+			}
+			if (w.num_sections == 0 ||
+			    uint64_t(w.first_section) + w.num_sections >
+			        sections.size()) {
+				error(where, "section range out of bounds or empty");
+				continue;
+			}
+			if (!(w.span_efficiency > 0.0f && w.span_efficiency <= 1.0f)) {
+				error(where, "span_efficiency must be in (0, 1]");
+			}
+			for (uint32_t i = 0; i < w.num_sections; ++i) {
+				const section_def &sec = sections[w.first_section + i];
+				std::string        sec_where =
+				    where + " section " + std::to_string(i);
+				if (!(sec.span > 0.0f && sec.chord > 0.0f)) {
+					error(sec_where, "span and chord must be > 0");
+				}
+				if (!std::isfinite(sec.chordwise_shift)) {
+					error(sec_where, "shift must be finite");
+				}
+				if (sec.has_aileron && sec.has_flap) {
+					error(sec_where, "cannot have both aileron and flap");
+				}
+			}
+		}
+
+		for (const surface_def &s : surfaces) {
+			std::string where = "surface " + std::string(s.name);
+			if (s.wing >= wings.size()) {
+				error(where, "wing index out of range");
+			}
+			if (!(glm::length(s.incidence_axis) >= 1e-6f)) {
+				error(where, "incidence_axis must not be zero");
+			}
+			if (!is_finite(s.root_pos)) {
+				error(where, "root must be finite");
+			}
+			for (const control_mix &mix : s.mix) {
+				if (!std::isfinite(mix.base) ||
+				    !std::all_of(
+				        std::begin(mix.gains),
+				        std::end(mix.gains),
+				        [](float x) { return std::isfinite(x); }
+				    )) {
+					error(where, "control mixing must be finite");
+				}
+			}
+		}
+		if (surfaces.empty()) {
+			error("aircraft", "no surfaces");
+		}
+
+		return errors;
+	}
+
+	std::vector<wing_section> get_wing_sections(const wing_def &w) const {
+		std::vector<wing_section> result;
+		for (uint32_t i = 0; i < w.num_sections; ++i) {
+			const section_def &sec = sections[w.first_section + i];
+			result.push_back({
+			    .span            = sec.span,
+			    .chord           = sec.chord,
+			    .chordwise_shift = sec.chordwise_shift,
+			    .has_aileron     = sec.has_aileron != 0,
+			    .has_flap        = sec.has_flap != 0,
+			    .has_slat        = sec.has_slat != 0,
+			});
+		}
+		return result;
+	}
+
+	// airfoils with the same curve and parameters get the same key, for
+	// deduplication in airfoil_registry
+	static std::string get_airfoil_key(const airfoil_def &a) {
+		std::ostringstream key;
+		key << a.curve << '|' << a.curve_max_cl << '|' << a.curve_max_aoa_deg
+		    << '|' << a.sweep_deg << '|' << a.flap_eff_per_deg << '|'
+		    << a.slat_eff_per_deg << '|' << a.base_cd << '|'
+		    << a.cd_aoa2_scale << '|' << a.flap_cd_eff_per_deg << '|'
+		    << a.slat_cd_eff_per_deg << '|' << a.spline << '|'
+		    << a.coeff_table[0] << 'x' << a.coeff_table[1] << 'x'
+		    << a.coeff_table[2];
+		return key.str();
+	}
+
+	// inputs are indexed by input_*, writes one entry per surface
+	template <typename T>
+	void mix_controls(
+	    const std::array<T, num_inputs>                           &inputs,
+	    std::span<typename basic_aero_model<T>::surface_controls>  out
+	) const {
+		if (out.size() < surfaces.size()) {
+			throw std::invalid_argument("need controls for every surface");
+		}
+		for (size_t s = 0; s < surfaces.size(); ++s) {
+			T value[num_channels];
+			for (uint32_t c = 0; c < num_channels; ++c) {
+				const control_mix &mix = surfaces[s].mix[c];
+				value[c]               = mix.base;
+				for (uint32_t i = 0; i < num_inputs; ++i) {
+					value[c] += mix.gains[i] * inputs[i];
+				}
+			}
+
+			// clamped to the airfoil's control ranges
+			typename basic_aero_model<T>::surface_controls &c = out[s];
+			c.incidence_deg = value[channel_incidence];
+			c.aileron_deg   = std::clamp(value[channel_aileron], T(-45), T(45));
+			c.flap_deg      = std::clamp(value[channel_flap], T(-45), T(45));
+			c.slat_deg      = std::clamp(value[channel_slat], T(0), T(45));
+		}
+	}
+
+private:
+	static constexpr uint32_t record_sizes[6] = {
+	    sizeof(mass_props),
+	    sizeof(engine_props),
+	    sizeof(airfoil_def),
+	    sizeof(wing_def),
+	    sizeof(section_def),
+	    sizeof(surface_def),
+	};
+
+	void throw_if_invalid(const std::string &source) const {
+		std::vector<std::string> errors = validate();
+		if (!errors.empty()) {
+			std::string msg = "Invalid aircraft " + source + ":";
+			for (const std::string &e : errors) {
+				msg += "\n  " + e;
+			}
+			throw std::runtime_error(msg);
+		}
+	}
+
+	static bool is_finite(glm::vec3 v) {
+		return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+	}
+
+	// copies a name into a fixed-size, NUL-terminated field
+	template <size_t N>
+	static void set_name(char (&dst)[N], std::string_view src) {
+		if (src.size() >= N) {
+			throw std::invalid_argument(
+			    "name too long (max " + std::to_string(N - 1) +
+			    " chars): " + std::string(src)
+			);
+		}
+		std::memset(dst, 0, N);
+		std::memcpy(dst, src.data(), src.size());
+	}
+
+	template <typename T>
+	static uint32_t
+	find_by_name(const std::vector<T> &items, std::string_view name) {
+		for (size_t i = 0; i < items.size(); ++i) {
+			if (name == items[i].name) {
+				return static_cast<uint32_t>(i);
+			}
+		}
+		throw std::invalid_argument("undefined name: " + std::string(name));
+	}
+
+	void parse_text(std::string_view text, const std::string &source) {
+		enum class block { none, mass, engine, airfoil, wing, surface };
+		block cur_block = block::none;
+		bool  has_mass = false, has_engine = false;
+
+		size_t line_no = 0;
+		while (!text.empty()) {
+			size_t           eol  = text.find('\n');
+			std::string_view line = text.substr(0, eol);
+			text = eol == text.npos ? std::string_view() : text.substr(eol + 1);
+			++line_no;
+			line = line.substr(0, line.find('#'));
+
+			std::istringstream       stream{std::string(line)};
+			std::vector<std::string> tok;
+			for (std::string t; stream >> t;) {
+				tok.push_back(t);
+			}
+			if (tok.empty()) {
+				continue;
+			}
+
+			try {
+				auto args = [&](size_t n) {
+					if (tok.size() != n + 1) {
+						throw std::invalid_argument(
+						    "'" + tok[0] + "' takes " + std::to_string(n) +
+						    " argument(s)"
+						);
+					}
+				};
+				auto num = [&](size_t i) { return parse_float(tok[i]); };
+				auto vec = [&](size_t i) {
+					return glm::vec3(num(i), num(i + 1), num(i + 2));
+				};
+				const std::string &key = tok[0];
+
+				if (cur_block == block::none) {
+					if (key == "name") {
+						args(1);
+						set_name(name, tok[1]);
+					} else if (key == "mass") {
+						args(0);
+						cur_block = block::mass;
+						has_mass  = true;
+					} else if (key == "engine") {
+						args(0);
+						cur_block  = block::engine;
+						has_engine = true;
+					} else if (key == "airfoil") {
+						args(1);
+						cur_block = block::airfoil;
+						set_name(airfoils.emplace_back().name, tok[1]);
+					} else if (key == "wing") {
+						args(1);
+						cur_block = block::wing;
+						wing_def &w = wings.emplace_back();
+						set_name(w.name, tok[1]);
+						w.first_section =
+						    static_cast<uint32_t>(sections.size());
+					} else if (key == "surface") {
+						args(1);
+						cur_block = block::surface;
+						set_name(surfaces.emplace_back().name, tok[1]);
+					} else {
+						throw std::invalid_argument("unknown block: " + key);
+					}
+				} else if (key == "end") {
+					args(0);
+					cur_block = block::none;
+				} else if (cur_block == block::mass) {
+					if (key == "empty_mass") {
+						args(1);
+						mass.empty_mass = num(1);
+					} else if (key == "max_fuel") {
+						args(1);
+						mass.max_fuel = num(1);
+					} else if (key == "center_of_mass") {
+						args(3);
+						mass.center_of_mass = vec(1);
+					} else if (key == "inertia") {
+						args(3);
+						mass.inertia = vec(1);
+					} else if (key == "fuel_center") {
+						args(3);
+						mass.fuel_center = vec(1);
+					} else if (key == "fuel_inertia") {
+						args(3);
+						mass.fuel_inertia = vec(1);
+					} else {
+						throw std::invalid_argument("unknown mass key: " + key);
+					}
+				} else if (cur_block == block::engine) {
+					if (key == "max_thrust_dry") {
+						args(1);
+						engine.max_thrust_dry = num(1);
+					} else if (key == "max_thrust_wet") {
+						args(1);
+						engine.max_thrust_wet = num(1);
+					} else if (key == "position") {
+						args(3);
+						engine.position = vec(1);
+					} else if (key == "incidence") {
+						args(1);
+						engine.incidence_deg = num(1);
+					} else if (key == "throttle_rate") {
+						args(1);
+						engine.throttle_rate = num(1);
+					} else if (key == "tsfc_dry") {
+						args(1);
+						engine.tsfc_dry = num(1);
+					} else if (key == "tsfc_wet") {
+						args(1);
+						engine.tsfc_wet = num(1);
+					} else {
+						throw std::invalid_argument(
+						    "unknown engine key: " + key
+						);
+					}
+				} else if (cur_block == block::airfoil) {
+					parse_airfoil_key(airfoils.back(), tok);
+				} else if (cur_block == block::wing) {
+					wing_def &w = wings.back();
+					if (key == "airfoil") {
+						args(1);
+						w.airfoil = find_by_name(airfoils, tok[1]);
+					} else if (key == "span_efficiency") {
+						args(1);
+						w.span_efficiency = num(1);
+					} else if (key == "section") {
+						sections.push_back(parse_section(tok));
+						++w.num_sections;
+					} else {
+						throw std::invalid_argument("unknown wing key: " + key);
+					}
+				} else if (cur_block == block::surface) {
+					parse_surface_key(surfaces.back(), tok);
+				}
+			} catch (const std::invalid_argument &e) {
+				throw std::runtime_error(
+				    source + ":" + std::to_string(line_no) + ": " + e.what()
+				);
+			}
+		}
+
+		if (cur_block != block::none) {
+			throw std::runtime_error(source + ": missing 'end'");
+		}
+		if (!has_mass || !has_engine) {
+			throw std::runtime_error(source + ": missing mass/engine block");
+		}
+	}
+
+	static float parse_float(const std::string &token) {
+		size_t end   = 0;
+		float  value = 0.0f;
+		try {
+			value = std::stof(token, &end);
+		} catch (const std::exception &) {
+			end = 0;
+		}
+		if (end != token.size() || !std::isfinite(value)) {
+			throw std::invalid_argument("not a number: " + token);
+		}
+		return value;
+	}
+
+	void parse_airfoil_key(
+	    airfoil_def &a, const std::vector<std::string> &tok
+	) {
+		if (tok[0] == "coeff_table") {
+			// coeff_table <aoa points> <flap points> <slat points>
+			if (tok.size() != 4) {
+				throw std::invalid_argument("'coeff_table' takes 3 arguments");
+			}
+			for (size_t i = 0; i < 3; ++i) {
+				float points = parse_float(tok[i + 1]);
+				if (points < 2.0f ||
+				    points > float(airfoil_def::max_table_points) ||
+				    points != std::floor(points)) {
+					throw std::invalid_argument(
+					    "coeff_table points must be whole, 2 to 4096"
+					);
+				}
+				a.coeff_table[i] = static_cast<uint32_t>(points);
+			}
+			return;
+		}
+		if (tok.size() != 2) {
+			throw std::invalid_argument("'" + tok[0] + "' takes 1 argument");
+		}
+		if (tok[0] == "curve") {
+			set_name(a.curve, tok[1]);
+			return;
+		}
+		if (tok[0] == "interpolation") {
+			if (tok[1] != "linear" && tok[1] != "spline") {
+				throw std::invalid_argument(
+				    "interpolation must be linear or spline"
+				);
+			}
+			a.spline = tok[1] == "spline";
+			return;
+		}
+		std::pair<const char *, float *> keys[] = {
+		    {"curve_max_cl", &a.curve_max_cl},
+		    {"curve_max_aoa", &a.curve_max_aoa_deg},
+		    {"sweep", &a.sweep_deg},
+		    {"flap_eff_per_deg", &a.flap_eff_per_deg},
+		    {"slat_eff_per_deg", &a.slat_eff_per_deg},
+		    {"base_cd", &a.base_cd},
+		    {"cd_aoa2_scale", &a.cd_aoa2_scale},
+		    {"flap_cd_eff_per_deg", &a.flap_cd_eff_per_deg},
+		    {"slat_cd_eff_per_deg", &a.slat_cd_eff_per_deg},
+		};
+		for (auto [key, value] : keys) {
+			if (tok[0] == key) {
+				*value = parse_float(tok[1]);
+				return;
+			}
+		}
+		throw std::invalid_argument("unknown airfoil key: " + tok[0]);
+	}
+
+	// section span <m> chord <m> [shift <m>] [aileron] [flap] [slat]
+	static section_def parse_section(const std::vector<std::string> &tok) {
+		section_def sec;
+		for (size_t i = 1; i < tok.size(); ++i) {
+			auto value = [&]() {
+				if (++i >= tok.size()) {
+					throw std::invalid_argument(
+					    "missing value for " + tok[i - 1]
+					);
+				}
+				return parse_float(tok[i]);
+			};
+			if (tok[i] == "span") {
+				sec.span = value();
+			} else if (tok[i] == "chord") {
+				sec.chord = value();
+			} else if (tok[i] == "shift") {
+				sec.chordwise_shift = value();
+			} else if (tok[i] == "aileron") {
+				sec.has_aileron = 1;
+			} else if (tok[i] == "flap") {
+				sec.has_flap = 1;
+			} else if (tok[i] == "slat") {
+				sec.has_slat = 1;
+			} else {
+				throw std::invalid_argument("unknown section key: " + tok[i]);
+			}
+		}
+		return sec;
+	}
+
+	void parse_surface_key(
+	    surface_def &s, const std::vector<std::string> &tok
+	) {
+		const std::string &key = tok[0];
+		if (key == "wing" && tok.size() == 2) {
+			s.wing = find_by_name(wings, tok[1]);
+		} else if (key == "side" && tok.size() == 2) {
+			if (tok[1] != "left" && tok[1] != "right") {
+				throw std::invalid_argument("side must be left or right");
+			}
+			s.is_right_wing = tok[1] == "right";
+		} else if (key == "root" && tok.size() == 4) {
+			s.root_pos = glm::vec3(
+			    parse_float(tok[1]), parse_float(tok[2]), parse_float(tok[3])
+			);
+		} else if (key == "incidence_axis" && tok.size() == 4) {
+			s.incidence_axis = glm::vec3(
+			    parse_float(tok[1]), parse_float(tok[2]), parse_float(tok[3])
+			);
+		} else if (key == "incidence" || key == "aileron" || key == "flap" ||
+		           key == "slat") {
+			// <channel> <base> [<input> <gain>]...
+			channel c = key == "incidence" ? channel_incidence
+			            : key == "aileron" ? channel_aileron
+			            : key == "flap"    ? channel_flap
+			                               : channel_slat;
+			if (tok.size() < 2 || tok.size() % 2 != 0) {
+				throw std::invalid_argument(
+				    "expected: " + key + " <base> [<input> <gain>]..."
+				);
+			}
+			control_mix mix;
+			mix.base = parse_float(tok[1]);
+			for (size_t i = 2; i < tok.size(); i += 2) {
+				mix.gains[parse_input(tok[i])] = parse_float(tok[i + 1]);
+			}
+			s.mix[c] = mix;
+		} else {
+			throw std::invalid_argument(
+			    "unknown or malformed surface key: " + key
+			);
+		}
+	}
+
+	static input parse_input(const std::string &token) {
+		if (token == "pitch") {
+			return input_pitch;
+		} else if (token == "roll") {
+			return input_roll;
+		} else if (token == "yaw") {
+			return input_yaw;
+		} else if (token == "flaps") {
+			return input_flaps;
+		}
+		throw std::invalid_argument("unknown input: " + token);
+	}
+};
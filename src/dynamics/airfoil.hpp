@@ -1,13 +1,16 @@
 #pragma once
 
-#include "../pch.hpp"
+#include "pch.hpp"
 
 #include "curve.hpp"
+#include "fastmath.hpp"
 
 class airfoil {
 public:
-	// lift
-	curve cl_vs_aoa_curve;
+	// lift; the curve is a ranged copy sharing the source's samples, the
+	// handle keeps the source registered (see airfoil_registry)
+	curve_handle cl_vs_aoa_source;
+	curve        cl_vs_aoa_curve;
 	float max_sampled_stall_angle = 0.0f;
 	float min_sampled_stall_angle = 0.0f;
 	float max_sampled_cl          = 0.0f;
@@ -21,40 +24,72 @@ public:
 	float flap_cd_eff_per_deg;
 	float slat_cd_eff_per_deg;
 
-	struct coeffs {
-		float cl; // lift coefficient
-		float cd; // drag coefficient
+	template <typename T> struct basic_coeffs {
+		T cl; // lift coefficient
+		T cd; // drag coefficient
 	};
+	using coeffs = basic_coeffs<float>;
 
 	airfoil() = default;
 
 	airfoil(
-	    const curve &cl_vs_aoa_curve,
-	    float        curve_max_cl        = 2.4f,
-	    float        curve_max_aoa_deg   = 30.0f,
-	    float        sweep_deg           = 40.0f,
-	    float        flap_eff_per_deg    = 0.015f,
-	    float        slat_eff_per_deg    = 0.015f,
-	    float        base_cd             = 0.02f,
-	    float        cd_aoa2_scale       = 0.0002f,
-	    float        flap_cd_eff_per_deg = 0.001f,
-	    float        slat_cd_eff_per_deg = 0.001f
+	    curve_handle         cl_vs_aoa_source,
+	    float                curve_max_cl        = 2.4f,
+	    float                curve_max_aoa_deg   = 30.0f,
+	    float                sweep_deg           = 40.0f,
+	    float                flap_eff_per_deg    = 0.015f,
+	    float                slat_eff_per_deg    = 0.015f,
+	    float                base_cd             = 0.02f,
+	    float                cd_aoa2_scale       = 0.0002f,
+	    float                flap_cd_eff_per_deg = 0.001f,
+	    float                slat_cd_eff_per_deg = 0.001f,
+	    curve::interpolation cl_interpolation =
+	        curve::interpolation::linear_samples
 	) {
+		if (!cl_vs_aoa_source) {
+			throw std::invalid_argument("Airfoil needs a lift curve.");
+		}
 		// lift
-		this->cl_vs_aoa_curve = cl_vs_aoa_curve;
+		this->cl_vs_aoa_source = std::move(cl_vs_aoa_source);
+		this->cl_vs_aoa_curve  = *this->cl_vs_aoa_source;
+		// not-a-knot goes through the samples tools/spline_generator wrote
+		this->cl_vs_aoa_curve.set_interpolation(
+		    cl_interpolation, curve::spline_boundary::not_a_knot
+		);
 		this->cl_vs_aoa_curve.set_x_range(
 		    -curve_max_aoa_deg, curve_max_aoa_deg
 		);
 		this->cl_vs_aoa_curve.set_y_range(-curve_max_cl, curve_max_cl);
-		for (float x = -curve_max_aoa_deg; x <= curve_max_aoa_deg; x += 0.1f) {
-			float y = this->cl_vs_aoa_curve.sample(x);
-			if (y > this->max_sampled_cl) {
-				this->max_sampled_cl          = y;
-				this->max_sampled_stall_angle = x;
+		if (const auto &stall = this->cl_vs_aoa_curve.get_stall_data()) {
+			// precomputed by the curve source, no need to scan
+			float max_cl =
+			    glm::mix(-curve_max_cl, curve_max_cl, stall->max_y01);
+			float min_cl =
+			    glm::mix(-curve_max_cl, curve_max_cl, stall->min_y01);
+			if (max_cl > 0.0f) {
+				this->max_sampled_cl          = max_cl;
+				this->max_sampled_stall_angle = glm::mix(
+				    -curve_max_aoa_deg, curve_max_aoa_deg, stall->max_x01
+				);
 			}
-			if (y < this->min_sampled_cl) {
-				this->min_sampled_cl          = y;
-				this->min_sampled_stall_angle = x;
+			if (min_cl < 0.0f) {
+				this->min_sampled_cl          = min_cl;
+				this->min_sampled_stall_angle = glm::mix(
+				    -curve_max_aoa_deg, curve_max_aoa_deg, stall->min_x01
+				);
+			}
+		} else {
+			for (float x  = -curve_max_aoa_deg; x <= curve_max_aoa_deg;
+			     x       += 0.1f) {
+				float y = this->cl_vs_aoa_curve.sample(x);
+				if (y > this->max_sampled_cl) {
+					this->max_sampled_cl          = y;
+					this->max_sampled_stall_angle = x;
+				}
+				if (y < this->min_sampled_cl) {
+					this->min_sampled_cl          = y;
+					this->min_sampled_stall_angle = x;
+				}
 			}
 		}
 		this->sweep_deg        = sweep_deg;
@@ -67,56 +102,261 @@ public:
 		this->slat_cd_eff_per_deg = slat_cd_eff_per_deg;
 	}
 
-	coeffs
-	calc_coeffs(float aoa_deg, float flap_deg = 0.0f, float slat_deg = 0.0f) {
-		// sanity checks
-		aoa_deg =
-		    glm::clamp(aoa_deg, cl_vs_aoa_curve.x_min, cl_vs_aoa_curve.x_max);
-		if (flap_deg < -45.0f || flap_deg > 45.0f) {
+	// resolution of the baked (cl, cd) grid, every axis needs >= 2 points;
+	// cl and cd are piecewise linear in flap with the kink at 0, so the
+	// default 3 flap points (-45, 0, 45) are exact
+	struct coeff_table_config {
+		size_t num_aoa  = 241; // 0.25 deg steps over +-30 deg
+		size_t num_flap = 3;
+		size_t num_slat = 10; // 5 deg steps
+	};
+
+	struct coeff_table_error {
+		float max_cl_error = 0.0f;
+		float max_cd_error = 0.0f;
+		float rms_cl_error = 0.0f;
+		float rms_cd_error = 0.0f;
+	};
+
+	// Evaluates the analytic model once per grid point; calc_coeffs() then
+	// interpolates trilinearly. Bake after the airfoil parameters are final,
+	// the table is not updated when they change.
+	void bake_coeff_table() {
+		bake_coeff_table(coeff_table_config{});
+	}
+
+	void bake_coeff_table(const coeff_table_config &config) {
+		if (config.num_aoa < 2 || config.num_flap < 2 || config.num_slat < 2) {
 			throw std::invalid_argument(
-			    "flap_deg must be in [-45, 45] degrees"
+			    "coeff table needs at least 2 points per axis"
 			);
 		}
-		if (slat_deg < 0.0f || slat_deg > 45.0f) {
-			throw std::invalid_argument("slat_deg must be in [0, 45] degrees");
+		coeff_table.clear();
+		table_config       = config;
+		table_aoa_min      = cl_vs_aoa_curve.x_min;
+		table_inv_aoa_step =
+		    (config.num_aoa - 1) / (cl_vs_aoa_curve.x_max - table_aoa_min);
+		table_inv_flap_step = (config.num_flap - 1) / (max_flap - min_flap);
+		table_inv_slat_step = (config.num_slat - 1) / (max_slat - min_slat);
+
+		std::vector<coeffs> table;
+		table.reserve(config.num_aoa * config.num_flap * config.num_slat);
+		for (size_t s = 0; s < config.num_slat; ++s) {
+			float slat = min_slat + s / table_inv_slat_step;
+			for (size_t f = 0; f < config.num_flap; ++f) {
+				float flap = min_flap + f / table_inv_flap_step;
+				for (size_t a = 0; a < config.num_aoa; ++a) {
+					float aoa = table_aoa_min + a / table_inv_aoa_step;
+					table.push_back(calc_coeffs_analytic(aoa, flap, slat));
+				}
+			}
+		}
+		coeff_table = std::move(table);
+	}
+
+	void clear_coeff_table() {
+		coeff_table.clear();
+	}
+
+	bool has_coeff_table() const {
+		return !coeff_table.empty();
+	}
+
+	// bytes owned by this airfoil, excluding the lift curve samples which
+	// are shared between copies of the curve
+	size_t get_memory_usage() const {
+		return sizeof(*this) + cl_vs_aoa_curve.get_heap_usage() +
+		       coeff_table.capacity() * sizeof(coeffs);
+	}
+
+	// compares the baked table against the analytic model on a grid that is
+	// offset from (and finer than) the table grid
+	coeff_table_error
+	report_coeff_table_error(size_t samples_per_axis = 64) const {
+		if (coeff_table.empty()) {
+			throw std::runtime_error("No coeff table baked.");
+		}
+		coeff_table_error err;
+		double            sum_cl2 = 0.0, sum_cd2 = 0.0;
+		size_t            n       = samples_per_axis;
+		float aoa_range = cl_vs_aoa_curve.x_max - cl_vs_aoa_curve.x_min;
+		for (size_t s = 0; s < n; ++s) {
+			float slat = min_slat + (s + 0.5f) / n * (max_slat - min_slat);
+			for (size_t f = 0; f < n; ++f) {
+				float flap = min_flap + (f + 0.5f) / n * (max_flap - min_flap);
+				for (size_t a = 0; a < n * 8; ++a) {
+					float aoa = cl_vs_aoa_curve.x_min +
+					            (a + 0.5f) / (n * 8) * aoa_range;
+					coeffs exact = calc_coeffs_analytic(aoa, flap, slat);
+					coeffs baked = sample_coeff_table(aoa, flap, slat);
+					float  e_cl  = std::abs(exact.cl - baked.cl);
+					float  e_cd  = std::abs(exact.cd - baked.cd);
+					err.max_cl_error = std::max(err.max_cl_error, e_cl);
+					err.max_cd_error = std::max(err.max_cd_error, e_cd);
+					sum_cl2 += double(e_cl) * e_cl;
+					sum_cd2 += double(e_cd) * e_cd;
+				}
+			}
+		}
+		double count     = double(n) * n * n * 8;
+		err.rms_cl_error = float(std::sqrt(sum_cl2 / count));
+		err.rms_cd_error = float(std::sqrt(sum_cd2 / count));
+		return err;
+	}
+
+	// evaluated in T, the table and the parameters stay float
+	template <typename T = float>
+	basic_coeffs<T> calc_coeffs(
+	    T aoa_deg, T flap_deg = T(0), T slat_deg = T(0)
+	) const {
+		if (!coeff_table.empty()) {
+			check_control_ranges(flap_deg, slat_deg);
+			return sample_coeff_table(aoa_deg, flap_deg, slat_deg);
 		}
+		return calc_coeffs_analytic(aoa_deg, flap_deg, slat_deg);
+	}
+
+	template <typename T = float>
+	basic_coeffs<T> calc_coeffs_analytic(
+	    T aoa_deg, T flap_deg = T(0), T slat_deg = T(0)
+	) const {
+		const curve &cl_curve = cl_vs_aoa_curve;
+
+		// sanity checks
+		aoa_deg = glm::clamp(aoa_deg, T(cl_curve.x_min), T(cl_curve.x_max));
+		check_control_ranges(flap_deg, slat_deg);
 
 		// lift
 
 		// slat effect
-		float d_cl_max    = slat_eff_per_deg * slat_deg;
-		float cl_max      = cl_vs_aoa_curve.y_max;
-		float curve_scale = (cl_max + d_cl_max) / cl_max; // [1, 1.something]
+		T d_cl_max    = slat_eff_per_deg * slat_deg;
+		T cl_max      = cl_curve.y_max;
+		T curve_scale = (cl_max + d_cl_max) / cl_max; // [1, 1.something]
 
-		float cl = cl_vs_aoa_curve.sample(aoa_deg / curve_scale) * curve_scale;
+		T cl = cl_curve.sample(aoa_deg / curve_scale) * curve_scale;
 
 		// flap effect
-		float flap_eff_factor;
-		if (aoa_deg > 0.0f) {
-			flap_eff_factor = 1.0f - glm::smoothstep(
-			                             max_sampled_stall_angle,
-			                             this->cl_vs_aoa_curve.x_max,
+		T flap_eff_factor;
+		if (aoa_deg > T(0)) {
+			flap_eff_factor = T(1) - glm::smoothstep(
+			                             T(max_sampled_stall_angle),
+			                             T(cl_curve.x_max),
 			                             aoa_deg
 			                         );
 		} else {
 			flap_eff_factor = glm::smoothstep(
-			    this->cl_vs_aoa_curve.x_min, min_sampled_stall_angle, aoa_deg
+			    T(cl_curve.x_min), T(min_sampled_stall_angle), aoa_deg
 			);
 		}
 		cl += flap_eff_factor * flap_eff_per_deg * flap_deg;
 
 		// sweep effect
 		if (this->sweep_deg > 0.0f) {
-			cl *= glm::cos(glm::radians(this->sweep_deg));
+			cl *= sim_cos(glm::radians(T(this->sweep_deg)));
 		}
 
 		// drag
 
-		float cd  = base_cd + cd_aoa2_scale * aoa_deg * aoa_deg;
-		cd       += flap_cd_eff_per_deg * std::abs(flap_deg);
-		cd       += slat_cd_eff_per_deg * std::abs(slat_deg);
-		cd        = glm::clamp(cd, base_cd, 1.5f);
+		T cd  = base_cd + cd_aoa2_scale * aoa_deg * aoa_deg;
+		cd   += flap_cd_eff_per_deg * std::abs(flap_deg);
+		cd   += slat_cd_eff_per_deg * std::abs(slat_deg);
+		cd    = glm::clamp(cd, T(base_cd), T(1.5));
 
 		return {cl, cd};
 	}
+
+private:
+	static constexpr float min_flap = -45.0f, max_flap = 45.0f;
+	static constexpr float min_slat = 0.0f, max_slat = 45.0f;
+
+	// aoa varies fastest, then flap, then slat
+	std::vector<coeffs> coeff_table;
+	coeff_table_config  table_config;
+	float               table_aoa_min       = 0.0f;
+	float               table_inv_aoa_step  = 0.0f;
+	float               table_inv_flap_step = 0.0f;
+	float               table_inv_slat_step = 0.0f;
+
+	template <typename T>
+	static void check_control_ranges(T flap_deg, T slat_deg) {
+		if (flap_deg < min_flap || flap_deg > max_flap) {
+			throw std::invalid_argument(
+			    "flap_deg must be in [-45, 45] degrees"
+			);
+		}
+		if (slat_deg < min_slat || slat_deg > max_slat) {
+			throw std::invalid_argument("slat_deg must be in [0, 45] degrees");
+		}
+	}
+
+	// continuous grid coordinate, clamped so that the upper neighbour exists
+	template <typename T>
+	static void locate_in_grid(
+	    T       v,
+	    float   v_min,
+	    float   inv_step,
+	    size_t  n,
+	    size_t &idx,
+	    T      &t
+	) {
+		T pos = glm::clamp((v - v_min) * inv_step, T(0), T(n - 1));
+		// int32 truncation is a single instruction, size_t is not
+		int32_t i = glm::min(static_cast<int32_t>(pos), int32_t(n - 2));
+		idx       = static_cast<size_t>(i);
+		t         = pos - static_cast<T>(i);
+	}
+
+	template <typename T>
+	basic_coeffs<T> sample_coeff_table(T aoa_deg, T flap_deg, T slat_deg)
+	    const {
+		size_t ia, iff, is;
+		T      ta, tf, ts;
+		locate_in_grid(
+		    aoa_deg,
+		    table_aoa_min,
+		    table_inv_aoa_step,
+		    table_config.num_aoa,
+		    ia,
+		    ta
+		);
+		locate_in_grid(
+		    flap_deg,
+		    min_flap,
+		    table_inv_flap_step,
+		    table_config.num_flap,
+		    iff,
+		    tf
+		);
+		locate_in_grid(
+		    slat_deg,
+		    min_slat,
+		    table_inv_slat_step,
+		    table_config.num_slat,
+		    is,
+		    ts
+		);
+
+		size_t stride_flap = table_config.num_aoa;
+		size_t stride_slat = table_config.num_aoa * table_config.num_flap;
+		const coeffs *c0 =
+		    &coeff_table[is * stride_slat + iff * stride_flap + ia];
+		const coeffs *c1 = c0 + stride_slat;
+
+		using coeffs_t = basic_coeffs<T>;
+		auto lerp_aoa  = [&](const coeffs *row) {
+            return coeffs_t{
+                row[0].cl + (row[1].cl - row[0].cl) * ta,
+                row[0].cd + (row[1].cd - row[0].cd) * ta,
+            };
+		};
+		auto lerp = [](coeffs_t a, coeffs_t b, T t) {
+			return coeffs_t{a.cl + (b.cl - a.cl) * t, a.cd + (b.cd - a.cd) * t};
+		};
+		coeffs_t slat0 = lerp(lerp_aoa(c0), lerp_aoa(c0 + stride_flap), tf);
+		coeffs_t slat1 = lerp(lerp_aoa(c1), lerp_aoa(c1 + stride_flap), tf);
+		return lerp(slat0, slat1, ts);
+	}
 };
+
+// airfoils are shared read-only between wings, see airfoil_registry
+using airfoil_handle = std::shared_ptr<const airfoil>;
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "curve.hpp"
+#include "mapped_file.hpp"
+
+// Packed binary collection of named curves (lift polars etc.), produced by
+// tools/airfoil_pack/make_airfoil_pack.py from the text curve files.
+//
+// LAYOUT (little-endian, offsets in bytes from the start of the file):
+// header         16 B
+// entries        num_curves * 96 B
+// sample arrays  float32, each starting at a 64 B aligned samples_offset
+//
+// Curves returned by get_curve() sample straight from the mapped pages, the
+// mapping lives until the last curve referencing it is gone.
+class airfoil_pack {
+public:
+	static constexpr char     magic[4] = {'A', 'F', 'P', 'K'};
+	static constexpr uint32_t version  = 1;
+
+	struct header {
+		char     magic[4];
+		uint32_t version;
+		uint32_t num_curves;
+		uint32_t entry_size; // sizeof(entry), for sanity checking
+	};
+
+	struct entry {
+		char     name[48]; // NUL-padded
+		float    x_min, x_max;
+		float    y_min, y_max;
+		float    stall_max_x, stall_max_y; // in x/y range units
+		float    stall_min_x, stall_min_y;
+		uint32_t num_samples;
+		uint32_t reserved;
+		uint64_t samples_offset;
+	};
+
+	static_assert(sizeof(header) == 16);
+	static_assert(sizeof(entry) == 96);
+	static_assert(
+	    std::endian::native == std::endian::little,
+	    "airfoil packs are little-endian"
+	);
+
+	void load_from_file(const std::filesystem::path &path) {
+		auto file = std::make_shared<mapped_file>();
+		file->open(path);
+
+		// validate everything up front so lookups can't read out of bounds
+		if (file->size() < sizeof(header)) {
+			throw std::runtime_error(
+			    "Airfoil pack too small: " + path.string()
+			);
+		}
+		const header *hdr = reinterpret_cast<const header *>(file->data());
+		if (std::memcmp(hdr->magic, magic, sizeof(magic)) != 0) {
+			throw std::runtime_error("Not an airfoil pack: " + path.string());
+		}
+		if (hdr->version != version || hdr->entry_size != sizeof(entry)) {
+			throw std::runtime_error(
+			    "Unsupported airfoil pack version: " + path.string()
+			);
+		}
+		if (sizeof(header) + uint64_t(hdr->num_curves) * sizeof(entry) >
+		    file->size()) {
+			throw std::runtime_error(
+			    "Airfoil pack entry table truncated: " + path.string()
+			);
+		}
+		const entry *entries =
+		    reinterpret_cast<const entry *>(file->data() + sizeof(header));
+		for (uint32_t i = 0; i < hdr->num_curves; ++i) {
+			const entry &e   = entries[i];
+			uint64_t     end = e.samples_offset +
+			               uint64_t(e.num_samples) * sizeof(float);
+			if (e.num_samples == 0 || e.samples_offset % alignof(float) != 0 ||
+			    end > file->size()) {
+				throw std::runtime_error(
+				    "Airfoil pack entry " + std::to_string(i) +
+				    " is corrupt: " + path.string()
+				);
+			}
+			if (e.name[sizeof(e.name) - 1] != '\0') {
+				throw std::runtime_error(
+				    "Airfoil pack entry " + std::to_string(i) +
+				    " name is not terminated: " + path.string()
+				);
+			}
+			// get_curve() divides by both ranges, NaN fails these too
+			if (!(e.x_max > e.x_min) ||
+			    !(std::abs(e.y_max - e.y_min) > 0.0f)) {
+				throw std::runtime_error(
+				    "Airfoil pack entry " + std::to_string(i) +
+				    " has an empty range: " + path.string()
+				);
+			}
+		}
+
+		this->file    = file;
+		this->entries = {entries, hdr->num_curves};
+	}
+
+	size_t size() const {
+		return entries.size();
+	}
+
+	std::span<const entry> get_entries() const {
+		return entries;
+	}
+
+	const entry *find(std::string_view name) const {
+		for (const entry &e : entries) {
+			if (name == e.name) {
+				return &e;
+			}
+		}
+		return nullptr;
+	}
+
+	// no parse, no copy: the returned curve points into the mapping
+	curve get_curve(std::string_view name) const {
+		const entry *e = find(name);
+		if (e == nullptr) {
+			throw std::runtime_error(
+			    "Curve not found in airfoil pack: " + std::string(name)
+			);
+		}
+
+		curve result;
+		result.set_x_range(e->x_min, e->x_max);
+		result.set_y_range(e->y_min, e->y_max);
+
+		// stall metadata is stored in range units, curve keeps it normalized
+		curve::stall_data stall;
+		stall.max_x01 = (e->stall_max_x - e->x_min) / (e->x_max - e->x_min);
+		stall.max_y01 = (e->stall_max_y - e->y_min) / (e->y_max - e->y_min);
+		stall.min_x01 = (e->stall_min_x - e->x_min) / (e->x_max - e->x_min);
+		stall.min_y01 = (e->stall_min_y - e->y_min) / (e->y_max - e->y_min);
+
+		const float *samples = reinterpret_cast<const float *>(
+		    file->data() + e->samples_offset
+		);
+		result.load_from_memory({samples, e->num_samples}, file, stall);
+		return result;
+	}
+
+private:
+	std::shared_ptr<const mapped_file> file;
+	std::span<const entry>             entries;
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "airfoil.hpp"
+#include "airfoil_pack.hpp"
+#include "curve.hpp"
+#include "curve_table.hpp"
+
+// Flyweight store for curves and airfoils. Entries are deduplicated by a
+// source key (file path, embedded table name, pack + curve name, or a
+// caller-chosen airfoil name) and handed out as shared handles, so every
+// aircraft built from the same data references a single copy of it.
+class airfoil_registry {
+public:
+	struct airfoil_memory_usage {
+		std::string key;
+		size_t      airfoil_bytes = 0; // airfoil, spline and coeff table
+		size_t      sample_bytes  = 0; // lift curve samples, may be shared
+		long        num_users     = 0; // handles held outside the registry
+	};
+
+	// process-wide instance used by the entities
+	static airfoil_registry &shared() {
+		static airfoil_registry registry;
+		return registry;
+	}
+
+	curve_handle load_curve_from_file(const std::filesystem::path &path) {
+		// same file through different relative paths is still one source
+		std::string key =
+		    "file:" + std::filesystem::weakly_canonical(path).string();
+		return find_or_add(curves, key, [&] {
+			curve result;
+			result.load_from_file(path);
+			return result;
+		});
+	}
+
+	template <size_t N, size_t M>
+	curve_handle load_curve_from_table(
+	    std::string_view name, const curve_table<N, M> &table
+	) {
+		return find_or_add(curves, "table:" + std::string(name), [&] {
+			curve result;
+			result.load_from_table(table);
+			return result;
+		});
+	}
+
+	// pack_key identifies the pack, e.g. the path it was loaded from
+	curve_handle load_curve_from_pack(
+	    std::string_view    pack_key,
+	    const airfoil_pack &pack,
+	    std::string_view    name
+	) {
+		std::string key =
+		    "pack:" + std::string(pack_key) + ":" + std::string(name);
+		return find_or_add(curves, key, [&] {
+			return pack.get_curve(name);
+		});
+	}
+
+	// the pack is only mapped if the curve isn't registered yet
+	curve_handle load_curve_from_pack(
+	    const std::filesystem::path &path, std::string_view name
+	) {
+		std::string pack_key = std::filesystem::weakly_canonical(path).string();
+		std::string key = "pack:" + pack_key + ":" + std::string(name);
+		return find_or_add(curves, key, [&] {
+			airfoil_pack pack;
+			pack.load_from_file(path);
+			return pack.get_curve(name);
+		});
+	}
+
+	// make() runs only if no airfoil is registered under key yet; it should
+	// fully set up the airfoil (incl. bake_coeff_table()) since the
+	// registered instance can no longer be modified
+	airfoil_handle get_airfoil(
+	    const std::string &key, const std::function<airfoil()> &make
+	) {
+		return find_or_add(airfoils, key, make);
+	}
+
+	std::vector<airfoil_memory_usage> report_memory_usage() const {
+		std::lock_guard lock(mutex);
+		std::vector<airfoil_memory_usage> report;
+		report.reserve(airfoils.size());
+		for (const auto &[key, handle] : airfoils) {
+			report.push_back({
+			    .key           = key,
+			    .airfoil_bytes = handle->get_memory_usage(),
+			    .sample_bytes =
+			        handle->cl_vs_aoa_curve.get_samples().size_bytes(),
+			    .num_users = handle.use_count() - 1,
+			});
+		}
+		std::sort(report.begin(), report.end(), [](auto &a, auto &b) {
+			return a.key < b.key;
+		});
+		return report;
+	}
+
+	// drops entries that nothing outside the registry references anymore
+	void collect_unused() {
+		std::lock_guard lock(mutex);
+		auto unused = [](const auto &entry) {
+			return entry.second.use_count() == 1;
+		};
+		std::erase_if(airfoils, unused);
+		std::erase_if(curves, unused);
+	}
+
+private:
+	mutable std::mutex                              mutex;
+	std::unordered_map<std::string, curve_handle>   curves;
+	std::unordered_map<std::string, airfoil_handle> airfoils;
+
+	// make() runs unlocked so it can register dependencies (an airfoil
+	// loading its curve); if two threads race, the first insert wins
+	template <typename T, typename F>
+	std::shared_ptr<const T> find_or_add(
+	    std::unordered_map<std::string, std::shared_ptr<const T>> &map,
+	    const std::string                                          &key,
+	    const F                                                    &make
+	) {
+		{
+			std::lock_guard lock(mutex);
+			if (auto it = map.find(key); it != map.end()) {
+				return it->second;
+			}
+		}
+		auto created = std::make_shared<const T>(make());
+		std::lock_guard lock(mutex);
+		return map.try_emplace(key, std::move(created)).first->second;
+	}
+};
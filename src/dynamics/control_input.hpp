@@ -0,0 +1,18 @@
+#pragma once
+
+#include "pch.hpp"
+
+// What the pilot commands for one control step, however it was produced.
+// Sticks come in already smoothed, the aircraft definition mixes them into
+// surface deflections.
+struct control_input {
+	float throttle    = 0.0f; // (0, 1)
+	bool  afterburner = false;
+	float pitch_down  = 0.0f; // (-1, 1)
+	float roll_right  = 0.0f; // (-1, 1)
+	float rudder_left = 0.0f; // (-1, 1)
+	bool  flaps_down  = false;
+
+	// debug, turns the body directly, deg/s about the world y and z axes
+	glm::vec2 debug_turn = glm::vec2(0.0f);
+};
@@ -1,12 +1,43 @@
 #pragma once
 
-#include "../pch.hpp"
+#include "pch.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+template <size_t N, size_t M> struct curve_table;
 
 class curve {
 public:
 	float x_min = 0.0f, x_max = 1.0f;
 	float y_min = 0.0f, y_max = 1.0f;
 
+	// extremes of the curve, stored in normalized [0, 1] space so that they
+	// survive set_x_range/set_y_range
+	struct stall_data {
+		float max_x01 = 0.0f, max_y01 = 0.0f;
+		float min_x01 = 0.0f, min_y01 = 0.0f;
+	};
+
+	// spline knot in normalized [0, 1] space, as made by
+	// tools/spline_generator/cubic_spline.py
+	struct control_point {
+		float x = 0.0f;
+		float y = 0.0f;
+	};
+
+	enum class interpolation {
+		linear_samples, // lerp between the pre-sampled values (default)
+		cubic_spline,   // cubic spline through the control points
+	};
+
+	enum class spline_boundary {
+		natural,    // zero curvature at both ends
+		not_a_knot, // scipy's CubicSpline default, reproduces the samples
+		            // written by tools/spline_generator
+	};
+
 	void load_from_file(const std::filesystem::path &path) {
 		// structure:
 		// <num control pts> <num samples>
@@ -24,35 +55,161 @@ public:
 		}
 		size_t num_control_pts, num_samples;
 		file >> num_control_pts >> num_samples;
-		// skip control points
+		// load control points
+		std::vector<control_point> control_pts(num_control_pts);
 		for (size_t i = 0; i < num_control_pts; ++i) {
-			float x, y;
-			file >> x >> y;
+			file >> control_pts[i].x >> control_pts[i].y;
 		}
 		// load samples
-		y_data.resize(num_samples);
+		auto samples = std::make_shared<std::vector<float>>(num_samples);
 		for (size_t i = 0; i < num_samples; ++i) {
-			file >> y_data[i];
+			file >> (*samples)[i];
 		}
 		file.close();
+
+		y_storage = samples;
+		y_data    = *samples;
+		stall.reset();
+		set_control_points(control_pts);
+	}
+
+	// samples are referenced, not copied; owner keeps them alive for as long
+	// as this curve (or any copy of it) exists
+	void load_from_memory(
+	    std::span<const float>            samples,
+	    std::shared_ptr<const void>       owner,
+	    const std::optional<stall_data> &stall = std::nullopt
+	) {
+		y_storage   = std::move(owner);
+		y_data      = samples;
+		this->stall = stall;
+	}
+
+	// tables have static storage duration, nothing to keep alive
+	template <size_t N, size_t M>
+	void load_from_table(const curve_table<N, M> &table) {
+		load_from_memory(table.samples, nullptr, table.stall);
+		set_control_points(table.control_pts);
 	}
 
-	float sample(float x) {
+	// drops back to linear_samples, the spline is rebuilt on the next
+	// set_interpolation(interpolation::cubic_spline)
+	void set_control_points(std::span<const control_point> control_pts) {
+		for (size_t i = 1; i < control_pts.size(); ++i) {
+			if (control_pts[i].x <= control_pts[i - 1].x) {
+				throw std::invalid_argument(
+				    "spline control points must be sorted by x"
+				);
+			}
+		}
+		this->control_pts.assign(control_pts.begin(), control_pts.end());
+		mode = interpolation::linear_samples;
+		spline.clear();
+		spline_stall.reset();
+	}
+
+	// spline coefficients are solved here once, never while sampling
+	void set_interpolation(
+	    interpolation   mode,
+	    spline_boundary boundary = spline_boundary::natural
+	) {
+		if (mode == interpolation::cubic_spline) {
+			if (control_pts.size() < 2) {
+				throw std::runtime_error(
+				    "Curve needs at least 2 control points for a spline."
+				);
+			}
+			build_spline(boundary);
+		}
+		this->mode = mode;
+	}
+
+	interpolation get_interpolation() const {
+		return mode;
+	}
+
+	// evaluated in T, the samples and spline coefficients stay float
+	template <typename T = float> T sample(T x) const {
+		T x_min = this->x_min, x_max = this->x_max;
+		T y_min = this->y_min, y_max = this->y_max;
+
+		// clamped so that NaN lands on x_min, like in sample_many()
+		x = x > x_min ? glm::min(x, x_max) : x_min;
+
+		if (mode == interpolation::cubic_spline) {
+			x = (x - x_min) / (x_max - x_min); // normalize to [0, 1]
+
+			const spline_segment &seg   = find_segment(x);
+			T                     t     = x - T(seg.x0);
+			T                     val01 = T(seg.a) +
+			              t * (T(seg.b) + t * (T(seg.c) + t * T(seg.d)));
+
+			return val01 * (y_max - y_min) + y_min; // denormalize
+		}
+
 		if (y_data.empty()) {
 			throw std::runtime_error("Curve data is empty.");
 		}
-		x = glm::clamp(x, x_min, x_max);
 		x = (x - x_min) / (x_max - x_min); // normalize to [0, 1]
 
 		// Perform sampling (linear interpolation, etc.)
 		size_t idx_low  = static_cast<size_t>(x * (y_data.size() - 1));
 		size_t idx_high = glm::min(idx_low + 1, y_data.size() - 1);
-		float  t        = (x * (y_data.size() - 1)) - idx_low;
-		float  val01    = glm::mix(y_data[idx_low], y_data[idx_high], t);
+		T      t        = (x * (y_data.size() - 1)) - idx_low;
+		T val01 = glm::mix(T(y_data[idx_low]), T(y_data[idx_high]), t);
 
 		return val01 * (y_max - y_min) + y_min; // denormalize
 	}
 
+	// Batched sample(): validity is checked once per call and the ranges are
+	// turned into reciprocals once, then an AVX2 (8 lanes), SSE2 (4 lanes) or
+	// scalar kernel runs over the whole batch, picked at compile time.
+	// Results differ from sample() by at most sample_many_max_ulp ULPs of
+	// max(|y_min|, |y_max|), because the normalization multiplies by the
+	// reciprocal instead of dividing.
+	static constexpr int sample_many_max_ulp = 8;
+
+	void sample_many(std::span<const float> x, std::span<float> out) const {
+		if (out.size() < x.size()) {
+			throw std::invalid_argument("sample_many: output span too small");
+		}
+		if (mode == interpolation::cubic_spline) {
+			sample_many_spline(x, out);
+			return;
+		}
+		if (y_data.size() < 2) {
+			throw std::runtime_error("Curve data is empty.");
+		}
+		sample_many_linear(x, out);
+	}
+
+	// dy/dx in range units (e.g. dCL/dAoA per degree), zero outside the x
+	// range where sample() is clamped, and for NaN; like sample_many(), the
+	// linear path needs at least two samples
+	template <typename T = float> T sample_derivative(T x) const {
+		T x_min = this->x_min, x_max = this->x_max;
+		if (!(x >= x_min && x <= x_max)) {
+			return T(0);
+		}
+		T scale = (T(y_max) - T(y_min)) / (x_max - x_min);
+		x       = (x - x_min) / (x_max - x_min);
+
+		if (mode == interpolation::cubic_spline) {
+			const spline_segment &seg = find_segment(x);
+			T                     t   = x - T(seg.x0);
+			return (T(seg.b) + t * (T(2) * T(seg.c) + t * T(3) * T(seg.d))) *
+			       scale;
+		}
+
+		if (y_data.size() < 2) {
+			throw std::runtime_error("Curve data is empty.");
+		}
+		size_t last    = y_data.size() - 1;
+		size_t idx_low = glm::min(static_cast<size_t>(x * last), last - 1);
+		T slope01 = (T(y_data[idx_low + 1]) - T(y_data[idx_low])) * T(last);
+		return slope01 * scale;
+	}
+
 	void set_x_range(float x_min, float x_max) {
 		this->x_min = x_min;
 		this->x_max = x_max;
@@ -63,6 +220,282 @@ public:
 		this->y_max = y_max;
 	}
 
+	std::span<const float> get_samples() const {
+		return y_data;
+	}
+
+	// heap memory owned by this curve alone; samples are excluded since
+	// copies share them (and they may live in a mapping or in .rodata)
+	size_t get_heap_usage() const {
+		return control_pts.capacity() * sizeof(control_point) +
+		       spline.capacity() * sizeof(spline_segment);
+	}
+
+	// set when the source carries precomputed stall metadata, or when the
+	// spline is in use (exact extremes found while building it)
+	const std::optional<stall_data> &get_stall_data() const {
+		return mode == interpolation::cubic_spline ? spline_stall : stall;
+	}
+
 private:
-	std::vector<float> y_data;
+	// y = a + b t + c t^2 + d t^3, t = x - x0
+	struct spline_segment {
+		float x0, a, b, c, d;
+	};
+
+	std::shared_ptr<const void> y_storage; // owns the memory y_data points to
+	std::span<const float>      y_data;
+	std::optional<stall_data>   stall;
+
+	interpolation               mode = interpolation::linear_samples;
+	std::vector<control_point>  control_pts;
+	std::vector<spline_segment> spline;
+	std::optional<stall_data>   spline_stall;
+
+	void build_spline(spline_boundary boundary) {
+		size_t n = control_pts.size();
+		if (n < 4) {
+			boundary = spline_boundary::natural; // not-a-knot needs 4 points
+		}
+
+		// solve for the second derivatives m at the knots; there are only a
+		// handful of knots, so a dense solve with partial pivoting is fine
+		std::vector<double> h(n - 1), m(n, 0.0);
+		std::vector<double> a(n * n, 0.0); // row-major, right-hand side in m
+		for (size_t i = 0; i < n - 1; ++i) {
+			h[i] = double(control_pts[i + 1].x) - control_pts[i].x;
+		}
+		for (size_t i = 1; i < n - 1; ++i) {
+			a[i * n + i - 1] = h[i - 1];
+			a[i * n + i]     = 2.0 * (h[i - 1] + h[i]);
+			a[i * n + i + 1] = h[i];
+			double slope_prev =
+			    (double(control_pts[i].y) - control_pts[i - 1].y) / h[i - 1];
+			double slope_next =
+			    (double(control_pts[i + 1].y) - control_pts[i].y) / h[i];
+			m[i] = 6.0 * (slope_next - slope_prev);
+		}
+		if (boundary == spline_boundary::natural) {
+			a[0]         = 1.0;
+			a[n * n - 1] = 1.0;
+		} else {
+			// continuous third derivative across the second and second to
+			// last knots
+			a[0]         = h[1];
+			a[1]         = -(h[0] + h[1]);
+			a[2]         = h[0];
+			a[n * n - 3] = h[n - 2];
+			a[n * n - 2] = -(h[n - 3] + h[n - 2]);
+			a[n * n - 1] = h[n - 3];
+		}
+		for (size_t col = 0; col < n; ++col) {
+			size_t pivot = col;
+			for (size_t row = col + 1; row < n; ++row) {
+				if (std::abs(a[row * n + col]) > std::abs(a[pivot * n + col])) {
+					pivot = row;
+				}
+			}
+			if (pivot != col) {
+				std::swap_ranges(
+				    a.begin() + col * n,
+				    a.begin() + col * n + n,
+				    a.begin() + pivot * n
+				);
+				std::swap(m[col], m[pivot]);
+			}
+			for (size_t row = col + 1; row < n; ++row) {
+				double f = a[row * n + col] / a[col * n + col];
+				for (size_t k = col; k < n; ++k) {
+					a[row * n + k] -= f * a[col * n + k];
+				}
+				m[row] -= f * m[col];
+			}
+		}
+		for (size_t row = n; row-- > 0;) {
+			for (size_t k = row + 1; k < n; ++k) {
+				m[row] -= a[row * n + k] * m[k];
+			}
+			m[row] /= a[row * n + row];
+		}
+
+		// per-segment polynomial in t = x - x0
+		spline.resize(n - 1);
+		for (size_t i = 0; i < n - 1; ++i) {
+			double y0 = control_pts[i].y, y1 = control_pts[i + 1].y;
+			double b  = (y1 - y0) / h[i] - h[i] * (2.0 * m[i] + m[i + 1]) / 6.0;
+			spline[i] = {
+			    .x0 = control_pts[i].x,
+			    .a  = float(y0),
+			    .b  = float(b),
+			    .c  = float(m[i] * 0.5),
+			    .d  = float((m[i + 1] - m[i]) / (6.0 * h[i])),
+			};
+		}
+		spline_stall = find_spline_stall();
+	}
+
+	// as max then min do in the vector kernels: NaN goes to 0, where
+	// std::clamp would pass it through and index out of bounds
+	static float clamp01(float x01) {
+		return x01 > 0.0f ? std::min(x01, 1.0f) : 0.0f;
+	}
+
+	void sample_many_linear(std::span<const float> x, std::span<float> out)
+	    const {
+		const float *y       = y_data.data();
+		const float  last    = static_cast<float>(y_data.size() - 1);
+		const float  max_idx = last - 1.0f;
+		const float  inv_x   = 1.0f / (x_max - x_min);
+		const float  y_range = y_max - y_min;
+
+		size_t i = 0;
+#if defined(__AVX2__)
+		const __m256 v_x_min   = _mm256_set1_ps(x_min);
+		const __m256 v_inv_x   = _mm256_set1_ps(inv_x);
+		const __m256 v_zero    = _mm256_setzero_ps();
+		const __m256 v_one     = _mm256_set1_ps(1.0f);
+		const __m256 v_last    = _mm256_set1_ps(last);
+		const __m256 v_max_idx = _mm256_set1_ps(max_idx);
+		const __m256 v_y_range = _mm256_set1_ps(y_range);
+		const __m256 v_y_min   = _mm256_set1_ps(y_min);
+		for (; i + 8 <= x.size(); i += 8) {
+			__m256 x01 = _mm256_mul_ps(
+			    _mm256_sub_ps(_mm256_loadu_ps(x.data() + i), v_x_min), v_inv_x
+			);
+			x01 = _mm256_min_ps(_mm256_max_ps(x01, v_zero), v_one);
+			__m256  pos = _mm256_mul_ps(x01, v_last);
+			__m256i idx = _mm256_cvttps_epi32(_mm256_min_ps(pos, v_max_idx));
+			__m256  t   = _mm256_sub_ps(pos, _mm256_cvtepi32_ps(idx));
+			__m256  y0  = _mm256_i32gather_ps(y, idx, 4);
+			__m256  y1  = _mm256_i32gather_ps(y + 1, idx, 4);
+			__m256  val01 =
+			    _mm256_add_ps(y0, _mm256_mul_ps(_mm256_sub_ps(y1, y0), t));
+			_mm256_storeu_ps(
+			    out.data() + i,
+			    _mm256_add_ps(_mm256_mul_ps(val01, v_y_range), v_y_min)
+			);
+		}
+#elif defined(__SSE2__)
+		const __m128 v_x_min   = _mm_set1_ps(x_min);
+		const __m128 v_inv_x   = _mm_set1_ps(inv_x);
+		const __m128 v_zero    = _mm_setzero_ps();
+		const __m128 v_one     = _mm_set1_ps(1.0f);
+		const __m128 v_last    = _mm_set1_ps(last);
+		const __m128 v_max_idx = _mm_set1_ps(max_idx);
+		const __m128 v_y_range = _mm_set1_ps(y_range);
+		const __m128 v_y_min   = _mm_set1_ps(y_min);
+		for (; i + 4 <= x.size(); i += 4) {
+			__m128 x01 = _mm_mul_ps(
+			    _mm_sub_ps(_mm_loadu_ps(x.data() + i), v_x_min), v_inv_x
+			);
+			x01 = _mm_min_ps(_mm_max_ps(x01, v_zero), v_one);
+			__m128  pos = _mm_mul_ps(x01, v_last);
+			__m128i idx = _mm_cvttps_epi32(_mm_min_ps(pos, v_max_idx));
+			__m128  t   = _mm_sub_ps(pos, _mm_cvtepi32_ps(idx));
+			// no gather before AVX2
+			alignas(16) int32_t lanes[4];
+			_mm_store_si128(reinterpret_cast<__m128i *>(lanes), idx);
+			__m128 y0 = _mm_setr_ps(
+			    y[lanes[0]], y[lanes[1]], y[lanes[2]], y[lanes[3]]
+			);
+			__m128 y1 = _mm_setr_ps(
+			    y[lanes[0] + 1],
+			    y[lanes[1] + 1],
+			    y[lanes[2] + 1],
+			    y[lanes[3] + 1]
+			);
+			__m128 val01 = _mm_add_ps(y0, _mm_mul_ps(_mm_sub_ps(y1, y0), t));
+			_mm_storeu_ps(
+			    out.data() + i,
+			    _mm_add_ps(_mm_mul_ps(val01, v_y_range), v_y_min)
+			);
+		}
+#endif
+		// scalar fallback and tail, same operations as the vector kernels
+		for (; i < x.size(); ++i) {
+			float x01   = clamp01((x[i] - x_min) * inv_x);
+			float pos   = x01 * last;
+			auto  idx   = static_cast<int32_t>(std::min(pos, max_idx));
+			float t     = pos - static_cast<float>(idx);
+			float val01 = y[idx] + (y[idx + 1] - y[idx]) * t;
+			out[i]      = val01 * y_range + y_min;
+		}
+	}
+
+	void sample_many_spline(std::span<const float> x, std::span<float> out)
+	    const {
+		const float inv_x   = 1.0f / (x_max - x_min);
+		const float y_range = y_max - y_min;
+		for (size_t i = 0; i < x.size(); ++i) {
+			float x01 = clamp01((x[i] - x_min) * inv_x);
+			const spline_segment &seg = find_segment(x01);
+			float                 t   = x01 - seg.x0;
+			float                 val01 =
+			    seg.a + t * (seg.b + t * (seg.c + t * seg.d));
+			out[i] = val01 * y_range + y_min;
+		}
+	}
+
+	template <typename T>
+	const spline_segment &find_segment(T x01) const {
+		// a handful of knots, a linear scan beats a binary search
+		size_t i = 0;
+		while (i + 1 < spline.size() && x01 >= T(spline[i + 1].x0)) {
+			++i;
+		}
+		return spline[i];
+	}
+
+	stall_data find_spline_stall() const {
+		stall_data result;
+		result.max_y01 = -std::numeric_limits<float>::infinity();
+		result.min_y01 = std::numeric_limits<float>::infinity();
+
+		auto consider = [&](float x01, float y01) {
+			if (y01 > result.max_y01) {
+				result.max_x01 = x01;
+				result.max_y01 = y01;
+			}
+			if (y01 < result.min_y01) {
+				result.min_x01 = x01;
+				result.min_y01 = y01;
+			}
+		};
+
+		for (size_t i = 0; i < spline.size(); ++i) {
+			const spline_segment &seg = spline[i];
+			float                 h   = control_pts[i + 1].x - seg.x0;
+			auto eval = [&](float t) {
+				return seg.a + t * (seg.b + t * (seg.c + t * seg.d));
+			};
+			consider(seg.x0, seg.a);
+			consider(seg.x0 + h, eval(h));
+
+			// interior extremes: roots of b + 2c t + 3d t^2 = 0
+			float qa = 3.0f * seg.d, qb = 2.0f * seg.c, qc = seg.b;
+			float roots[2];
+			int   num_roots = 0;
+			if (std::abs(qa) < 1e-9f) {
+				if (std::abs(qb) > 1e-9f) {
+					roots[num_roots++] = -qc / qb;
+				}
+			} else {
+				float disc = qb * qb - 4.0f * qa * qc;
+				if (disc >= 0.0f) {
+					float sq           = std::sqrt(disc);
+					roots[num_roots++] = (-qb + sq) / (2.0f * qa);
+					roots[num_roots++] = (-qb - sq) / (2.0f * qa);
+				}
+			}
+			for (int r = 0; r < num_roots; ++r) {
+				if (roots[r] > 0.0f && roots[r] < h) {
+					consider(seg.x0 + roots[r], eval(roots[r]));
+				}
+			}
+		}
+		return result;
+	}
 };
+
+// curves are shared read-only between airfoils, see airfoil_registry
+using curve_handle = std::shared_ptr<const curve>;
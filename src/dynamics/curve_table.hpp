@@ -0,0 +1,40 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "curve.hpp"
+
+// Curve samples baked into the binary at build time (see
+// cmake/embed_curve.cmake). Stall data is found while compiling, so curves
+// made from a table skip both the file I/O and the stall scan at startup.
+template <size_t N, size_t M> struct curve_table {
+	static_assert(N >= 2, "curve table needs at least two samples");
+
+	std::array<float, N>                samples;
+	std::array<curve::control_point, M> control_pts;
+	curve::stall_data                   stall;
+};
+
+template <size_t N, size_t M>
+constexpr curve_table<N, M> make_curve_table(
+    const std::array<float, N>                &samples,
+    const std::array<curve::control_point, M> &control_pts
+) {
+	curve_table<N, M> table{samples, control_pts, {}};
+
+	size_t i_max = 0, i_min = 0;
+	for (size_t i = 1; i < N; ++i) {
+		if (samples[i] > samples[i_max]) {
+			i_max = i;
+		}
+		if (samples[i] < samples[i_min]) {
+			i_min = i;
+		}
+	}
+	table.stall.max_x01 = static_cast<float>(i_max) / (N - 1);
+	table.stall.max_y01 = samples[i_max];
+	table.stall.min_x01 = static_cast<float>(i_min) / (N - 1);
+	table.stall.min_y01 = samples[i_min];
+
+	return table;
+}
@@ -0,0 +1,23 @@
+// Explicit instantiations of the scalar-generic dynamics. float is what the
+// simulator runs on, double is for validation and long trajectories.
+
+#include "aero_model.hpp"
+#include "integrator.hpp"
+#include "mass_properties.hpp"
+#include "rigid_body.hpp"
+#include "wing.hpp"
+
+template class basic_wing<float>;
+template class basic_wing<double>;
+
+template class basic_aero_model<float>;
+template class basic_aero_model<double>;
+
+template class basic_integrator<float>;
+template class basic_integrator<double>;
+
+template class basic_mass_properties<float>;
+template class basic_mass_properties<double>;
+
+template struct basic_rigid_body<float>;
+template struct basic_rigid_body<double>;
@@ -0,0 +1,441 @@
+#pragma once
+
+#include "pch.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Polynomial approximations of the libm calls on the aero hot path, in
+// scalar (float) and SIMD (SSE2 4 lanes, AVX2 8 lanes) forms. The SIMD forms
+// run the same operations in the same order as the scalar ones.
+//
+// Max errors below were measured against double precision libm over the
+// stated ranges. NaN inputs give unspecified results, and signed zeros are
+// only honored where noted.
+//
+// The dynamics don't call these directly but through the sim_*() functions at
+// the end of this file, which pick the approximations for float when
+// FLIGHT_SIM_FAST_MATH is defined and libm otherwise. double always uses
+// libm, since it's there for validation runs.
+
+// fast_atan2(): max error 2e-6 rad for any finite y, x. Returns 0 for (0, 0)
+// and keeps the sign of y.
+static constexpr float fast_atan2_max_error = 2.0e-6f;
+// fast_acos(): max error 5e-7 rad on [-1, 1], inputs are clamped to it.
+static constexpr float fast_acos_max_error = 5.0e-7f;
+// fast_cos(): max error 3e-7 for |x| <= 100 rad. The range reduction is good
+// up to |x| < 2^22, with an error that grows with |x|.
+static constexpr float fast_cos_max_error = 3.0e-7f;
+// fast_rsqrt(), fast_normalize(): max relative error 3e-7 on normal floats.
+// Zero gives NaN, so a zero vector normalizes to NaN like glm::normalize().
+static constexpr float fast_rsqrt_max_rel_error = 3.0e-7f;
+
+namespace fastmath_detail {
+
+constexpr float pi         = 3.14159265f;
+constexpr float half_pi    = 1.57079633f;
+constexpr float inv_two_pi = 0.159154943f;
+// 2 pi split in two, k * two_pi_hi is exact for the k we reduce by
+constexpr float two_pi_hi = 6.28125f;
+constexpr float two_pi_lo = 1.93530717e-3f;
+// adding and subtracting 1.5 * 2^23 rounds to the nearest integer
+constexpr float round_magic = 12582912.0f;
+
+// atan(z) on [0, 1], odd minimax polynomial
+constexpr float atan_c0 = 0.99997726f;
+constexpr float atan_c1 = -0.33262347f;
+constexpr float atan_c2 = 0.19354346f;
+constexpr float atan_c3 = -0.11643287f;
+constexpr float atan_c4 = 0.05265332f;
+constexpr float atan_c5 = -0.01172120f;
+
+// acos(x) = sqrt(1 - x) * p(x) on [0, 1], Abramowitz & Stegun 4.4.46
+constexpr float acos_c0 = 1.5707963050f;
+constexpr float acos_c1 = -0.2145988016f;
+constexpr float acos_c2 = 0.0889789874f;
+constexpr float acos_c3 = -0.0501743046f;
+constexpr float acos_c4 = 0.0308918810f;
+constexpr float acos_c5 = -0.0170881256f;
+constexpr float acos_c6 = 0.0066700901f;
+constexpr float acos_c7 = -0.0012624911f;
+
+// cos(t) on [0, pi / 2], Taylor series up to t^12
+constexpr float cos_c1 = -1.0f / 2.0f;
+constexpr float cos_c2 = 1.0f / 24.0f;
+constexpr float cos_c3 = -1.0f / 720.0f;
+constexpr float cos_c4 = 1.0f / 40320.0f;
+constexpr float cos_c5 = -1.0f / 3628800.0f;
+constexpr float cos_c6 = 1.0f / 479001600.0f;
+
+} // namespace fastmath_detail
+
+inline float fast_atan2(float y, float x) {
+	using namespace fastmath_detail;
+	float ax = std::abs(x);
+	float ay = std::abs(y);
+	float hi = std::max(ax, ay);
+	float lo = std::min(ax, ay);
+	float z  = hi > 0.0f ? lo / hi : 0.0f;
+	float z2 = z * z;
+	float a  = atan_c5;
+	a        = a * z2 + atan_c4;
+	a        = a * z2 + atan_c3;
+	a        = a * z2 + atan_c2;
+	a        = a * z2 + atan_c1;
+	a        = a * z2 + atan_c0;
+	a       *= z;
+	a        = ay > ax ? half_pi - a : a;
+	a        = x < 0.0f ? pi - a : a;
+	return std::copysign(a, y);
+}
+
+inline float fast_acos(float x) {
+	using namespace fastmath_detail;
+	x        = std::clamp(x, -1.0f, 1.0f);
+	float ax = std::abs(x);
+	float p  = acos_c7;
+	p        = p * ax + acos_c6;
+	p        = p * ax + acos_c5;
+	p        = p * ax + acos_c4;
+	p        = p * ax + acos_c3;
+	p        = p * ax + acos_c2;
+	p        = p * ax + acos_c1;
+	p        = p * ax + acos_c0;
+	float r  = std::sqrt(1.0f - ax) * p;
+	return x < 0.0f ? pi - r : r;
+}
+
+inline float fast_cos(float x) {
+	using namespace fastmath_detail;
+	// to [-pi, pi], cos is even so only |x| matters
+	float k = (x * inv_two_pi + round_magic) - round_magic;
+	float t = std::abs((x - k * two_pi_hi) - k * two_pi_lo);
+	// to [0, pi / 2], cos(pi - t) = -cos(t)
+	bool flip = t > half_pi;
+	t         = flip ? pi - t : t;
+	float t2  = t * t;
+	float c   = cos_c6;
+	c         = c * t2 + cos_c5;
+	c         = c * t2 + cos_c4;
+	c         = c * t2 + cos_c3;
+	c         = c * t2 + cos_c2;
+	c         = c * t2 + cos_c1;
+	c         = c * t2 + 1.0f;
+	return flip ? -c : c;
+}
+
+inline float fast_rsqrt(float x) {
+#if defined(__SSE2__)
+	float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+	// one newton step, from 12 to ~22 bits
+	return y * (1.5f - 0.5f * x * y * y);
+#else
+	if (x == 0.0f) {
+		return std::numeric_limits<float>::quiet_NaN(); // as the SSE path
+	}
+	uint32_t bits = 0x5f375a86u - (std::bit_cast<uint32_t>(x) >> 1);
+	float    y    = std::bit_cast<float>(bits);
+	y *= 1.5f - 0.5f * x * y * y;
+	y *= 1.5f - 0.5f * x * y * y;
+	y *= 1.5f - 0.5f * x * y * y;
+	return y;
+#endif
+}
+
+inline glm::vec3 fast_normalize(glm::vec3 v) {
+	return v * fast_rsqrt(glm::dot(v, v));
+}
+
+#if defined(__SSE2__)
+namespace fastmath_detail {
+
+inline __m128 abs_ps(__m128 v) {
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// mask ? a : b
+inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+} // namespace fastmath_detail
+
+inline __m128 fast_atan2(__m128 y, __m128 x) {
+	using namespace fastmath_detail;
+	__m128 ax = abs_ps(x);
+	__m128 ay = abs_ps(y);
+	__m128 hi = _mm_max_ps(ax, ay);
+	__m128 lo = _mm_min_ps(ax, ay);
+	__m128 z  = _mm_and_ps(
+        _mm_cmpgt_ps(hi, _mm_setzero_ps()), _mm_div_ps(lo, hi)
+    );
+	__m128 z2 = _mm_mul_ps(z, z);
+	__m128 a  = _mm_set1_ps(atan_c5);
+	a         = _mm_add_ps(_mm_mul_ps(a, z2), _mm_set1_ps(atan_c4));
+	a         = _mm_add_ps(_mm_mul_ps(a, z2), _mm_set1_ps(atan_c3));
+	a         = _mm_add_ps(_mm_mul_ps(a, z2), _mm_set1_ps(atan_c2));
+	a         = _mm_add_ps(_mm_mul_ps(a, z2), _mm_set1_ps(atan_c1));
+	a         = _mm_add_ps(_mm_mul_ps(a, z2), _mm_set1_ps(atan_c0));
+	a         = _mm_mul_ps(a, z);
+	a         = select_ps(
+        _mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(half_pi), a), a
+    );
+	a = select_ps(
+	    _mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(pi), a), a
+	);
+	return _mm_or_ps(a, _mm_and_ps(y, _mm_set1_ps(-0.0f)));
+}
+
+inline __m128 fast_acos(__m128 x) {
+	using namespace fastmath_detail;
+	x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+	__m128 ax = abs_ps(x);
+	__m128 p  = _mm_set1_ps(acos_c7);
+	p         = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(acos_c6));
+	p         = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(acos_c5));
+	p         = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(acos_c4));
+	p         = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(acos_c3));
+	p         = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(acos_c2));
+	p         = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(acos_c1));
+	p         = _mm_add_ps(_mm_mul_ps(p, ax), _mm_set1_ps(acos_c0));
+	__m128 r  = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), ax)), p);
+	return select_ps(
+	    _mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(pi), r), r
+	);
+}
+
+inline __m128 fast_cos(__m128 x) {
+	using namespace fastmath_detail;
+	const __m128 v_magic = _mm_set1_ps(round_magic);
+	__m128       k       = _mm_sub_ps(
+        _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(inv_two_pi)), v_magic), v_magic
+    );
+	__m128 t = abs_ps(_mm_sub_ps(
+	    _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(two_pi_hi))),
+	    _mm_mul_ps(k, _mm_set1_ps(two_pi_lo))
+	));
+	__m128 flip = _mm_cmpgt_ps(t, _mm_set1_ps(half_pi));
+	t           = select_ps(flip, _mm_sub_ps(_mm_set1_ps(pi), t), t);
+	__m128 t2   = _mm_mul_ps(t, t);
+	__m128 c    = _mm_set1_ps(cos_c6);
+	c           = _mm_add_ps(_mm_mul_ps(c, t2), _mm_set1_ps(cos_c5));
+	c           = _mm_add_ps(_mm_mul_ps(c, t2), _mm_set1_ps(cos_c4));
+	c           = _mm_add_ps(_mm_mul_ps(c, t2), _mm_set1_ps(cos_c3));
+	c           = _mm_add_ps(_mm_mul_ps(c, t2), _mm_set1_ps(cos_c2));
+	c           = _mm_add_ps(_mm_mul_ps(c, t2), _mm_set1_ps(cos_c1));
+	c           = _mm_add_ps(_mm_mul_ps(c, t2), _mm_set1_ps(1.0f));
+	return _mm_xor_ps(c, _mm_and_ps(flip, _mm_set1_ps(-0.0f)));
+}
+
+inline __m128 fast_rsqrt(__m128 x) {
+	__m128 y   = _mm_rsqrt_ps(x);
+	__m128 xyy = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(y, y));
+	return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), xyy));
+}
+
+// 4 vectors in SoA form, normalized in place
+inline void fast_normalize(__m128 &x, __m128 &y, __m128 &z) {
+	__m128 len2 = _mm_add_ps(
+	    _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)
+	);
+	__m128 inv_len = fast_rsqrt(len2);
+	x              = _mm_mul_ps(x, inv_len);
+	y              = _mm_mul_ps(y, inv_len);
+	z              = _mm_mul_ps(z, inv_len);
+}
+#endif
+
+#if defined(__AVX2__)
+namespace fastmath_detail {
+
+inline __m256 abs_ps(__m256 v) {
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+} // namespace fastmath_detail
+
+inline __m256 fast_atan2(__m256 y, __m256 x) {
+	using namespace fastmath_detail;
+	__m256 ax = abs_ps(x);
+	__m256 ay = abs_ps(y);
+	__m256 hi = _mm256_max_ps(ax, ay);
+	__m256 lo = _mm256_min_ps(ax, ay);
+	__m256 z  = _mm256_and_ps(
+        _mm256_cmp_ps(hi, _mm256_setzero_ps(), _CMP_GT_OQ),
+        _mm256_div_ps(lo, hi)
+    );
+	__m256 z2 = _mm256_mul_ps(z, z);
+	__m256 a  = _mm256_set1_ps(atan_c5);
+	a = _mm256_add_ps(_mm256_mul_ps(a, z2), _mm256_set1_ps(atan_c4));
+	a = _mm256_add_ps(_mm256_mul_ps(a, z2), _mm256_set1_ps(atan_c3));
+	a = _mm256_add_ps(_mm256_mul_ps(a, z2), _mm256_set1_ps(atan_c2));
+	a = _mm256_add_ps(_mm256_mul_ps(a, z2), _mm256_set1_ps(atan_c1));
+	a = _mm256_add_ps(_mm256_mul_ps(a, z2), _mm256_set1_ps(atan_c0));
+	a = _mm256_mul_ps(a, z);
+	a = _mm256_blendv_ps(
+	    a,
+	    _mm256_sub_ps(_mm256_set1_ps(half_pi), a),
+	    _mm256_cmp_ps(ay, ax, _CMP_GT_OQ)
+	);
+	a = _mm256_blendv_ps(
+	    a,
+	    _mm256_sub_ps(_mm256_set1_ps(pi), a),
+	    _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ)
+	);
+	return _mm256_or_ps(a, _mm256_and_ps(y, _mm256_set1_ps(-0.0f)));
+}
+
+inline __m256 fast_acos(__m256 x) {
+	using namespace fastmath_detail;
+	x = _mm256_min_ps(
+	    _mm256_max_ps(x, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f)
+	);
+	__m256 ax = abs_ps(x);
+	__m256 p  = _mm256_set1_ps(acos_c7);
+	p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(acos_c6));
+	p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(acos_c5));
+	p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(acos_c4));
+	p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(acos_c3));
+	p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(acos_c2));
+	p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(acos_c1));
+	p = _mm256_add_ps(_mm256_mul_ps(p, ax), _mm256_set1_ps(acos_c0));
+	__m256 r = _mm256_mul_ps(
+	    _mm256_sqrt_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), ax)), p
+	);
+	return _mm256_blendv_ps(
+	    r,
+	    _mm256_sub_ps(_mm256_set1_ps(pi), r),
+	    _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ)
+	);
+}
+
+inline __m256 fast_cos(__m256 x) {
+	using namespace fastmath_detail;
+	const __m256 v_magic = _mm256_set1_ps(round_magic);
+	__m256       k       = _mm256_sub_ps(
+        _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(inv_two_pi)), v_magic),
+        v_magic
+    );
+	__m256 t = abs_ps(_mm256_sub_ps(
+	    _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(two_pi_hi))),
+	    _mm256_mul_ps(k, _mm256_set1_ps(two_pi_lo))
+	));
+	__m256 flip = _mm256_cmp_ps(t, _mm256_set1_ps(half_pi), _CMP_GT_OQ);
+	t  = _mm256_blendv_ps(t, _mm256_sub_ps(_mm256_set1_ps(pi), t), flip);
+	__m256 t2 = _mm256_mul_ps(t, t);
+	__m256 c  = _mm256_set1_ps(cos_c6);
+	c = _mm256_add_ps(_mm256_mul_ps(c, t2), _mm256_set1_ps(cos_c5));
+	c = _mm256_add_ps(_mm256_mul_ps(c, t2), _mm256_set1_ps(cos_c4));
+	c = _mm256_add_ps(_mm256_mul_ps(c, t2), _mm256_set1_ps(cos_c3));
+	c = _mm256_add_ps(_mm256_mul_ps(c, t2), _mm256_set1_ps(cos_c2));
+	c = _mm256_add_ps(_mm256_mul_ps(c, t2), _mm256_set1_ps(cos_c1));
+	c = _mm256_add_ps(_mm256_mul_ps(c, t2), _mm256_set1_ps(1.0f));
+	return _mm256_xor_ps(c, _mm256_and_ps(flip, _mm256_set1_ps(-0.0f)));
+}
+
+inline __m256 fast_rsqrt(__m256 x) {
+	__m256 y   = _mm256_rsqrt_ps(x);
+	__m256 xyy = _mm256_mul_ps(
+	    _mm256_mul_ps(_mm256_set1_ps(0.5f), x), _mm256_mul_ps(y, y)
+	);
+	return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), xyy));
+}
+
+// 8 vectors in SoA form, normalized in place
+inline void fast_normalize(__m256 &x, __m256 &y, __m256 &z) {
+	__m256 len2 = _mm256_add_ps(
+	    _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)),
+	    _mm256_mul_ps(z, z)
+	);
+	__m256 inv_len = fast_rsqrt(len2);
+	x              = _mm256_mul_ps(x, inv_len);
+	y              = _mm256_mul_ps(y, inv_len);
+	z              = _mm256_mul_ps(z, inv_len);
+}
+#endif
+
+// Batched fast_atan2(), AVX2, SSE2 or scalar picked at compile time like
+// curve::sample_many().
+inline void fast_atan2_many(
+    std::span<const float> y, std::span<const float> x, std::span<float> out
+) {
+	if (x.size() != y.size() || out.size() < x.size()) {
+		throw std::invalid_argument("fast_atan2_many: span size mismatch");
+	}
+	size_t i = 0;
+#if defined(__AVX2__)
+	for (; i + 8 <= x.size(); i += 8) {
+		_mm256_storeu_ps(
+		    out.data() + i,
+		    fast_atan2(
+		        _mm256_loadu_ps(y.data() + i), _mm256_loadu_ps(x.data() + i)
+		    )
+		);
+	}
+#elif defined(__SSE2__)
+	for (; i + 4 <= x.size(); i += 4) {
+		_mm_storeu_ps(
+		    out.data() + i,
+		    fast_atan2(_mm_loadu_ps(y.data() + i), _mm_loadu_ps(x.data() + i))
+		);
+	}
+#endif
+	for (; i < x.size(); ++i) {
+		out[i] = fast_atan2(y[i], x[i]);
+	}
+}
+
+#if defined(FLIGHT_SIM_FAST_MATH)
+static constexpr bool fast_math_enabled = true;
+#else
+static constexpr bool fast_math_enabled = false;
+#endif
+
+template <typename T>
+static constexpr bool use_fast_math =
+    fast_math_enabled && std::is_same_v<T, float>;
+
+template <typename T> inline T sim_atan2(T y, T x) {
+	if constexpr (use_fast_math<T>) {
+		return fast_atan2(y, x);
+	} else {
+		return std::atan2(y, x);
+	}
+}
+
+template <typename T> inline T sim_acos(T x) {
+	if constexpr (use_fast_math<T>) {
+		return fast_acos(x);
+	} else {
+		return glm::acos(x);
+	}
+}
+
+template <typename T> inline T sim_cos(T x) {
+	if constexpr (use_fast_math<T>) {
+		return fast_cos(x);
+	} else {
+		return std::cos(x);
+	}
+}
+
+template <typename T> inline glm::vec<3, T> sim_normalize(glm::vec<3, T> v) {
+	if constexpr (use_fast_math<T>) {
+		return fast_normalize(v);
+	} else {
+		return glm::normalize(v);
+	}
+}
+
+template <typename T>
+inline void
+sim_atan2_many(std::span<const T> y, std::span<const T> x, std::span<T> out) {
+	if constexpr (use_fast_math<T>) {
+		fast_atan2_many(y, x, out);
+	} else {
+		for (size_t i = 0; i < x.size(); ++i) {
+			out[i] = std::atan2(y[i], x[i]);
+		}
+	}
+}
@@ -0,0 +1,203 @@
+#include "input_source.hpp"
+
+#include <charconv>
+
+void write_input_header(std::ostream &out) {
+	out << "time,throttle,afterburner,pitch_down,roll_right,rudder_left,"
+	       "flaps_down,debug_turn_y,debug_turn_z\n";
+}
+
+void write_input(std::ostream &out, const timed_input &row) {
+	const control_input &i = row.input;
+
+	// enough digits for every float and double to read back as itself
+	auto precision = out.precision();
+	out << std::setprecision(std::numeric_limits<double>::max_digits10)
+	    << row.time << ','
+	    << std::setprecision(std::numeric_limits<float>::max_digits10)
+	    << i.throttle << ',' << i.afterburner << ',' << i.pitch_down << ','
+	    << i.roll_right << ',' << i.rudder_left << ',' << i.flaps_down << ','
+	    << i.debug_turn.x << ',' << i.debug_turn.y << '\n';
+	out.precision(precision);
+}
+
+// The whole field as a T, blanks around it aside (hand-written files, CRLF),
+// throws otherwise. Unlike std::stof(), takes the subnormals write_input()
+// writes, e.g. a released stick smoothed down to ~1e-43.
+template <typename T> static T parse_number(const std::string &field) {
+	size_t first = field.find_first_not_of(" \t\r");
+	size_t last  = field.find_last_not_of(" \t\r");
+	if (first == std::string::npos) {
+		throw std::runtime_error("Empty column.");
+	}
+
+	T                      value{};
+	const char            *begin  = field.data() + first;
+	const char            *end    = field.data() + last + 1;
+	std::from_chars_result result = std::from_chars(begin, end, value);
+	if (result.ec != std::errc() || result.ptr != end) {
+		throw std::runtime_error("Not a number: " + field);
+	}
+	return value;
+}
+
+// one CSV row, throws unless it has every column
+static timed_input parse_input(const std::string &line) {
+	std::array<std::string, 9> fields;
+	std::istringstream         stream(line);
+	for (std::string &field : fields) {
+		if (!std::getline(stream, field, ',')) {
+			throw std::runtime_error("Too few columns: " + line);
+		}
+	}
+
+	timed_input row;
+	row.time               = parse_number<double>(fields[0]);
+	row.input.throttle     = parse_number<float>(fields[1]);
+	row.input.afterburner  = parse_number<int>(fields[2]) != 0;
+	row.input.pitch_down   = parse_number<float>(fields[3]);
+	row.input.roll_right   = parse_number<float>(fields[4]);
+	row.input.rudder_left  = parse_number<float>(fields[5]);
+	row.input.flaps_down   = parse_number<int>(fields[6]) != 0;
+	row.input.debug_turn.x = parse_number<float>(fields[7]);
+	row.input.debug_turn.y = parse_number<float>(fields[8]);
+	return row;
+}
+
+std::vector<timed_input> read_inputs(const std::filesystem::path &path) {
+	std::ifstream in(path);
+	if (!in) {
+		throw std::runtime_error("Failed to open file: " + path.string());
+	}
+
+	std::vector<timed_input> rows;
+	std::string              line;
+	std::getline(in, line); // header
+	for (size_t n = 2; std::getline(in, line); ++n) {
+		if (line.empty()) {
+			continue;
+		}
+		try {
+			rows.push_back(parse_input(line));
+		} catch (const std::exception &e) {
+			throw std::runtime_error(
+			    path.string() + ":" + std::to_string(n) + ": " + e.what()
+			);
+		}
+	}
+	if (rows.empty()) {
+		throw std::runtime_error("No inputs in " + path.string());
+	}
+	return rows;
+}
+
+programmatic_input::programmatic_input(const control_input &input)
+    : input(input) {}
+
+void programmatic_input::set(const control_input &input) {
+	this->input = input;
+}
+
+control_input programmatic_input::poll(double, float) {
+	return input;
+}
+
+void timeline_input::add(double time, const control_input &input) {
+	if (!keyframes.empty() && time <= keyframes.back().time) {
+		throw std::invalid_argument("Keyframes must be in increasing time.");
+	}
+	keyframes.push_back({time, input});
+}
+
+void timeline_input::load(const std::filesystem::path &path) {
+	keyframes.clear();
+	for (const timed_input &row : read_inputs(path)) {
+		add(row.time, row.input);
+	}
+}
+
+size_t timeline_input::size() const {
+	return keyframes.size();
+}
+
+control_input timeline_input::poll(double time, float) {
+	if (keyframes.empty()) {
+		return control_input();
+	}
+
+	// first keyframe after time
+	auto next = std::upper_bound(
+	    keyframes.begin(),
+	    keyframes.end(),
+	    time,
+	    [](double t, const timed_input &k) { return t < k.time; }
+	);
+	if (next == keyframes.begin()) {
+		return next->input;
+	}
+	if (next == keyframes.end()) {
+		return keyframes.back().input;
+	}
+
+	const control_input &a = std::prev(next)->input;
+	const control_input &b = next->input;
+
+	// how far from one keyframe to the next
+	double from = std::prev(next)->time;
+	float  t    = static_cast<float>((time - from) / (next->time - from));
+
+	control_input input = a;
+	input.throttle      = glm::mix(a.throttle, b.throttle, t);
+	input.pitch_down    = glm::mix(a.pitch_down, b.pitch_down, t);
+	input.roll_right    = glm::mix(a.roll_right, b.roll_right, t);
+	input.rudder_left   = glm::mix(a.rudder_left, b.rudder_left, t);
+	return input;
+}
+
+void recorded_input::load(const std::filesystem::path &path) {
+	rows = read_inputs(path);
+	next = 0;
+}
+
+size_t recorded_input::size() const {
+	return rows.size();
+}
+
+bool recorded_input::is_done() const {
+	return next >= rows.size();
+}
+
+control_input recorded_input::poll(double time, float dt) {
+	if (rows.empty()) {
+		return control_input();
+	}
+	if (is_done()) {
+		return rows.back().input;
+	}
+
+	const timed_input &row = rows[next++];
+	if (std::abs(time - row.time) >= 0.5 * dt) {
+		throw std::runtime_error(
+		    "Replay polled at " + std::to_string(time) + " s for an input "
+		    "recorded at " + std::to_string(row.time) +
+		    " s, is the control rate the recorded one?"
+		);
+	}
+	return row.input;
+}
+
+input_recorder::input_recorder(
+    input_source &source, const std::filesystem::path &path
+)
+    : source(source), out(path) {
+	if (!out) {
+		throw std::runtime_error("Failed to open file: " + path.string());
+	}
+	write_input_header(out);
+}
+
+control_input input_recorder::poll(double time, float dt) {
+	control_input input = source.poll(time, dt);
+	write_input(out, {time, input});
+	return input;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "control_input.hpp"
+
+// Where an aircraft's control_input comes from, polled once per control step
+// in time order. The keyboard, a recording, a timeline or code all look the
+// same to the model, so a flight flown on one can be flown again on another,
+// with or without a window.
+class input_source {
+public:
+	virtual ~input_source() = default;
+
+	// the input for the control step that starts at time (s) and lasts dt
+	virtual control_input poll(double time, float dt) = 0;
+};
+
+// A control_input at a point in time, a row of an input file. Input files are
+// CSV with a header, see write_input_header(). Floats are written with all
+// their digits, so reading a file back gives the same bits.
+struct timed_input {
+	double        time = 0.0; // s
+	control_input input;
+};
+
+void write_input_header(std::ostream &out);
+void write_input(std::ostream &out, const timed_input &row);
+
+// Throws if the file can't be read, has no rows or a row is malformed.
+std::vector<timed_input> read_inputs(const std::filesystem::path &path);
+
+// whatever the program last set, held until it sets another
+class programmatic_input : public input_source {
+public:
+	programmatic_input() = default;
+	explicit programmatic_input(const control_input &input);
+
+	void set(const control_input &input);
+
+	control_input poll(double time, float dt) override;
+
+private:
+	control_input input;
+};
+
+// Keyframes in time, e.g. a test maneuver written by hand. Throttle and
+// sticks ramp linearly from one keyframe to the next, switches and
+// debug_turn hold from theirs until the next. Before the first keyframe and
+// after the last, the nearest one holds.
+class timeline_input : public input_source {
+public:
+	// keyframes must come in increasing time, throws otherwise
+	void add(double time, const control_input &input);
+	void load(const std::filesystem::path &path);
+
+	size_t size() const;
+
+	control_input poll(double time, float dt) override;
+
+private:
+	std::vector<timed_input> keyframes;
+};
+
+// Replays what an input_recorder wrote: the nth poll gets the nth recorded
+// input, bit for bit, so a replay with the same aircraft, step and
+// integrator flies exactly the recorded flight. Throws when a poll is half a
+// step or more off its row's time, i.e. the control rate isn't the recorded
+// one. Past the end, the last input holds.
+class recorded_input : public input_source {
+public:
+	void load(const std::filesystem::path &path);
+
+	size_t size() const;
+	bool   is_done() const; // every row was replayed
+
+	control_input poll(double time, float dt) override;
+
+private:
+	std::vector<timed_input> rows;
+	size_t                   next = 0;
+};
+
+// Passes another source's inputs through and writes each to a file as it
+// goes, for recorded_input to replay or timeline_input to load.
+class input_recorder : public input_source {
+public:
+	// throws if the file can't be opened
+	input_recorder(input_source &source, const std::filesystem::path &path);
+
+	control_input poll(double time, float dt) override;
+
+private:
+	input_source &source;
+	std::ofstream out;
+};
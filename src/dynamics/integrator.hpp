@@ -0,0 +1,239 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "mass_properties.hpp"
+#include "rigid_body.hpp"
+
+// Advances a rigid body by one outer step. The loads callable is
+// basic_rigid_body<T>::loads(const basic_rigid_body<T> &) and gets called once
+// per stage, so anything it depends on besides the state (controls, thrust,
+// air density) is held for the whole step.
+//
+// - semi_implicit_euler: one evaluation, velocities first, then positions
+//   with the new velocities. Rotates exactly about the center of mass.
+// - rk4: classic fourth order, four evaluations.
+// - rk45: Dormand-Prince 5(4) with error control. Splits the outer step into
+//   as many substeps as the tolerances ask for and remembers the step size
+//   for the next call.
+template <typename T> class basic_integrator {
+public:
+	using body       = basic_rigid_body<T>;
+	using loads      = typename body::loads;
+	using derivative = typename body::derivative;
+	using vec3       = glm::vec<3, T>;
+	using quat       = glm::qua<T>;
+
+	// num_methods counts up to the last method, move it when appending one
+	enum class method { semi_implicit_euler, rk4, rk45 };
+	static constexpr int num_methods = static_cast<int>(method::rk45) + 1;
+
+	// rk45 tolerances, per component of pos, rot, vel and ang_vel
+	struct tolerances {
+		T abs_tol  = T(1e-4);
+		T rel_tol  = T(1e-5);
+		T min_step = T(1e-5); // s, accepted as is when the error is still high
+	};
+
+	explicit basic_integrator(method m = method::semi_implicit_euler)
+	    : m(m) {}
+
+	void set_method(method new_method) {
+		m         = new_method;
+		next_step = T(0);
+	}
+
+	method get_method() const {
+		return m;
+	}
+
+	static const char *get_method_name(method m) {
+		switch (m) {
+		case method::semi_implicit_euler:
+			return "semi-implicit Euler";
+		case method::rk4:
+			return "RK4";
+		case method::rk45:
+			return "RK45";
+		}
+		return "unknown";
+	}
+
+	void set_tolerances(const tolerances &new_tolerances) {
+		tol = new_tolerances;
+	}
+
+	// loads evaluations so far, the cost measure for comparing methods
+	uint64_t get_evaluations() const {
+		return evaluations;
+	}
+
+	// rk45 substeps thrown away for being over the tolerances
+	uint64_t get_rejected_steps() const {
+		return rejected_steps;
+	}
+
+	// Returns the world acceleration at the start of the step, gravity
+	// included.
+	template <typename Loads>
+	vec3 step(
+	    body                           &b,
+	    const basic_mass_properties<T> &mass,
+	    Loads                         &&loads_at,
+	    T                               dt
+	) {
+		auto derive = [&](const body &state) {
+			evaluations++;
+			return state.derive(
+			    loads_at(state),
+			    mass.get_mass(),
+			    mass.get_inertia(),
+			    mass.get_inverse_inertia(),
+			    mass.get_center_of_mass()
+			);
+		};
+
+		switch (m) {
+		case method::semi_implicit_euler:
+			return step_semi_implicit_euler(b, mass, derive(b), dt);
+		case method::rk4:
+			return step_rk4(b, derive, dt);
+		case method::rk45:
+			return step_rk45(b, derive, dt);
+		}
+		return vec3(0);
+	}
+
+private:
+	method     m;
+	tolerances tol;
+	T          next_step      = T(0); // rk45 step size carried between calls
+	uint64_t   evaluations    = 0;
+	uint64_t   rejected_steps = 0;
+
+	vec3 step_semi_implicit_euler(
+	    body                           &b,
+	    const basic_mass_properties<T> &mass,
+	    const derivative               &d,
+	    T                               dt
+	) {
+		b.vel     += d.accel * dt;     // m/s
+		b.ang_vel += d.ang_accel * dt; // rvec, rad/s
+		b.pos     += b.vel * dt;       // m
+		if (glm::length(b.ang_vel) > T(1e-6)) {
+			quat d_rot = glm::angleAxis(
+			    glm::length(b.ang_vel) * dt, glm::normalize(b.ang_vel)
+			);
+			// turn about the center of mass, not the model origin
+			vec3 com_offset  = b.to_world(mass.get_center_of_mass());
+			b.pos           -= d_rot * com_offset - com_offset;
+			b.rotate(d_rot);
+		}
+		return d.accel;
+	}
+
+	template <typename Derive> vec3 step_rk4(body &b, Derive &derive, T dt) {
+		derivative k1 = derive(b);
+		derivative k2 = derive(b.advanced(k1, dt / 2));
+		derivative k3 = derive(b.advanced(k2, dt / 2));
+		derivative k4 = derive(b.advanced(k3, dt));
+		b = b.advanced((k1 + k2 * T(2) + k3 * T(2) + k4) * (T(1) / 6), dt);
+		return k1.accel;
+	}
+
+	template <typename Derive> vec3 step_rk45(body &b, Derive &derive, T dt) {
+		// Dormand-Prince tableau
+		constexpr T a21 = T(1.0 / 5);
+		constexpr T a31 = T(3.0 / 40), a32 = T(9.0 / 40);
+		constexpr T a41 = T(44.0 / 45), a42 = T(-56.0 / 15),
+		            a43 = T(32.0 / 9);
+		constexpr T a51 = T(19372.0 / 6561), a52 = T(-25360.0 / 2187),
+		            a53 = T(64448.0 / 6561), a54 = T(-212.0 / 729);
+		constexpr T a61 = T(9017.0 / 3168), a62 = T(-355.0 / 33),
+		            a63 = T(46732.0 / 5247), a64 = T(49.0 / 176),
+		            a65 = T(-5103.0 / 18656);
+		// fifth order weights, also the last stage
+		constexpr T b1 = T(35.0 / 384), b3 = T(500.0 / 1113),
+		            b4 = T(125.0 / 192), b5 = T(-2187.0 / 6784),
+		            b6 = T(11.0 / 84);
+		// fifth minus fourth order weights
+		constexpr T e1 = T(71.0 / 57600), e3 = T(-71.0 / 16695),
+		            e4 = T(71.0 / 1920), e5 = T(-17253.0 / 339200),
+		            e6 = T(22.0 / 525), e7 = T(-1.0 / 40);
+
+		derivative k1    = derive(b);
+		vec3       accel = k1.accel;
+		T          left  = dt;
+		T          h     = next_step > T(0) ? std::min(next_step, dt) : dt;
+		while (left > T(0)) {
+			// don't leave a sliver at the end
+			bool last = h >= left * T(0.999);
+			if (last) {
+				h = left;
+			}
+
+			derivative k2 = derive(b.advanced(k1 * a21, h));
+			derivative k3 = derive(b.advanced(k1 * a31 + k2 * a32, h));
+			derivative k4 =
+			    derive(b.advanced(k1 * a41 + k2 * a42 + k3 * a43, h));
+			derivative k5 = derive(b.advanced(
+			    k1 * a51 + k2 * a52 + k3 * a53 + k4 * a54, h
+			));
+			derivative k6 = derive(b.advanced(
+			    k1 * a61 + k2 * a62 + k3 * a63 + k4 * a64 + k5 * a65, h
+			));
+			derivative slope =
+			    k1 * b1 + k3 * b3 + k4 * b4 + k5 * b5 + k6 * b6;
+			body       next = b.advanced(slope, h);
+			derivative k7   = derive(next);
+			derivative error =
+			    k1 * e1 + k3 * e3 + k4 * e4 + k5 * e5 + k6 * e6 + k7 * e7;
+
+			T    err    = error_norm(b, next, error, h);
+			bool accept = err <= T(1) || h <= tol.min_step;
+			if (accept) {
+				b     = next;
+				k1    = k7; // first same as last
+				left -= h;
+			} else {
+				rejected_steps++;
+			}
+
+			// usual controller, shrinks at most 5x and grows at most 5x
+			T fac   = err > T(0) ? T(0.9) * std::pow(err, T(-0.2)) : T(5);
+			T new_h = std::max(h * std::clamp(fac, T(0.2), T(5)), tol.min_step);
+			if (!(accept && last)) {
+				h = std::min(new_h, left);
+			} else {
+				next_step = new_h;
+			}
+		}
+		return accel;
+	}
+
+	// largest error over the state, scaled so that 1 is right at tolerance
+	T error_norm(
+	    const body &from, const body &to, const derivative &error, T h
+	) const {
+		T max_err = T(0);
+		auto check = [&](T err, T from_val, T to_val) {
+			T mag   = std::max(std::abs(from_val), std::abs(to_val));
+			T scale = tol.abs_tol + tol.rel_tol * mag;
+			max_err = std::max(max_err, std::abs(err * h) / scale);
+		};
+		for (int i = 0; i < 3; ++i) {
+			check(error.vel[i], from.pos[i], to.pos[i]);
+			check(error.accel[i], from.vel[i], to.vel[i]);
+			check(error.ang_accel[i], from.ang_vel[i], to.ang_vel[i]);
+		}
+		for (int i = 0; i < 4; ++i) {
+			check(error.rot[i], from.rot[i], to.rot[i]);
+		}
+		return max_err;
+	}
+};
+
+using integrator = basic_integrator<float>;
+
+extern template class basic_integrator<float>;
+extern template class basic_integrator<double>;
@@ -0,0 +1,175 @@
+#include "jet_model.hpp"
+
+#include "airfoil_registry.hpp"
+#include "curves/registry.hpp"
+
+// "embedded:<name>" curves are compiled in, "pack:<file>:<name>" curves come
+// from an airfoil pack ('#' would start a comment in .aircraft files),
+// everything else is a file path
+curve_handle
+load_airfoil_curve(airfoil_registry &registry, std::string_view source) {
+	if (source.starts_with("pack:")) {
+		std::string_view rest  = source.substr(5);
+		size_t           colon = rest.rfind(':');
+		if (colon == std::string_view::npos || colon + 1 == rest.size()) {
+			throw std::runtime_error(
+			    "Expected pack:<file>:<name>: " + std::string(source)
+			);
+		}
+		return registry.load_curve_from_pack(
+		    std::filesystem::path(rest.substr(0, colon)), rest.substr(colon + 1)
+		);
+	}
+	if (source.starts_with("embedded:")) {
+		std::string_view name = source.substr(9);
+		curve_handle     result;
+		if (!embedded_curves::find(name, [&](const auto &table) {
+			    result = registry.load_curve_from_table(name, table);
+		    })) {
+			throw std::runtime_error(
+			    "Unknown embedded curve: " + std::string(source)
+			);
+		}
+		return result;
+	}
+	return registry.load_curve_from_file(source);
+}
+
+std::vector<airfoil_handle> load_airfoils(const aircraft_def &def) {
+	airfoil_registry           &registry = airfoil_registry::shared();
+	std::vector<airfoil_handle> airfoils;
+	for (const aircraft_def::airfoil_def &a : def.airfoils) {
+		airfoils.push_back(registry.get_airfoil(
+		    aircraft_def::get_airfoil_key(a),
+		    [&] {
+			    return a.build(load_airfoil_curve(registry, a.curve));
+		    }
+		));
+	}
+	return airfoils;
+}
+
+void log_telemetry(const jet_snapshot &snapshot) {
+	glm::vec3 accel = snapshot.acceleration;
+	std::cout << "vel: " << glm::length(snapshot.body.vel) << " m/s"
+	          << std::endl;
+	float g = glm::length(accel + glm::vec3(0.0f, 0.0f, 9.81f)) / 9.81f;
+	std::cout << "pulling " << g << " Gs" << std::endl;
+}
+
+void jet_model::init(const std::filesystem::path &aircraft_path) {
+	def.load_from_file(aircraft_path);
+	aero = build_aero_model<float>(def);
+	controls.resize(aero.num_surfaces());
+	mass = mass_properties(def.mass);
+	forces.reserve(aero.num_forces() + 1); // + thrust
+}
+
+void jet_model::update_physics_from_input(
+    const control_input &input, float dt
+) {
+	update_controls(input, dt);
+	update_physics(dt);
+}
+
+void jet_model::update_controls(const control_input &input, float dt) {
+	last_input     = input;
+	throttle_level = std::clamp(input.throttle, 0.0f, 1.0f);
+	afterburner_on = input.afterburner;
+
+	// debug rotate body
+	if (input.debug_turn.x != 0.0f) {
+		body.rotate(glm::angleAxis(
+		    glm::radians(input.debug_turn.x * dt), glm::vec3(0.0f, 1.0f, 0.0f)
+		));
+	}
+	if (input.debug_turn.y != 0.0f) {
+		body.rotate(glm::angleAxis(
+		    glm::radians(input.debug_turn.y * dt), glm::vec3(0.0f, 0.0f, 1.0f)
+		));
+	}
+
+	// per surface controls, mixed as the aircraft definition says
+	const std::array<float, aircraft_def::num_inputs> inputs = {
+	    input.pitch_down,
+	    input.roll_right,
+	    input.rudder_left,
+	    input.flaps_down ? 1.0f : 0.0f,
+	};
+	def.mix_controls(inputs, controls);
+}
+
+void jet_model::update_physics(float dt) {
+	prev_body = body;
+
+	jet_force_vec thrust_force;
+	last_accel = step_jet_body(
+	    def.engine,
+	    aero,
+	    controls,
+	    throttle_level,
+	    afterburner_on,
+	    integrator_,
+	    body,
+	    mass,
+	    dt,
+	    &thrust_force
+	);
+
+	// save forces for debug, from the integrator's last evaluation
+	forces.clear();
+	forces.push_back(thrust_force);
+	for (size_t i = 0; i < aero.num_forces(); ++i) {
+		wing_force_vec_3d f = aero.get_force(i);
+		forces.push_back({f.force, f.origin});
+	}
+}
+
+
+void jet_model::write_snapshot(jet_snapshot &out) const {
+	out.prev_body      = prev_body;
+	out.body           = body;
+	out.center_of_mass = mass.get_center_of_mass();
+	out.acceleration   = last_accel;
+	out.input          = last_input;
+	// room for all forces on the first call, so later ones don't allocate
+	out.forces.reserve(forces.capacity());
+	out.forces.assign(forces.begin(), forces.end());
+}
+
+void jet_model::set_integrator(integrator::method method) {
+	integrator_.set_method(method);
+}
+
+integrator::method jet_model::get_integrator() const {
+	return integrator_.get_method();
+}
+
+const aircraft_def &jet_model::get_def() const {
+	return def;
+}
+
+const aero_model &jet_model::get_aero() const {
+	return aero;
+}
+
+const rigid_body &jet_model::get_body() const {
+	return body;
+}
+
+const mass_properties &jet_model::get_mass() const {
+	return mass;
+}
+
+glm::vec3 jet_model::get_acceleration() const {
+	return last_accel;
+}
+
+float jet_model::get_throttle() const {
+	return throttle_level;
+}
+
+void jet_model::set_body(const rigid_body &state) {
+	body      = state;
+	prev_body = state;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "aero_model.hpp"
+#include "aircraft_def.hpp"
+#include "control_input.hpp"
+#include "integrator.hpp"
+#include "mass_properties.hpp"
+#include "rigid_body.hpp"
+
+class airfoil_registry;
+
+// the lift curve an airfoil_def names, see airfoil_def::curve for the forms
+curve_handle
+load_airfoil_curve(airfoil_registry &registry, std::string_view source);
+
+// the airfoils of def in order, built once and shared by every jet using them
+std::vector<airfoil_handle> load_airfoils(const aircraft_def &def);
+
+// all surfaces of def evaluated in one pass, in definition order
+template <typename T>
+basic_aero_model<T> build_aero_model(const aircraft_def &def) {
+	using vec3 = glm::vec<3, T>;
+
+	std::vector<airfoil_handle> airfoils = load_airfoils(def);
+	basic_aero_model<T>         aero;
+	for (const aircraft_def::surface_def &s : def.surfaces) {
+		const aircraft_def::wing_def &w = def.wings[s.wing];
+		basic_wing<T>                 surface_wing(
+            airfoils[w.airfoil], def.get_wing_sections(w), w.span_efficiency
+        );
+		aero.add_surface(
+		    surface_wing,
+		    vec3(s.root_pos),
+		    s.is_right_wing != 0,
+		    vec3(s.incidence_axis)
+		);
+	}
+	return aero;
+}
+
+struct jet_force_vec {
+	glm::vec3 force  = glm::vec3(0.0f);
+	glm::vec3 origin = glm::vec3(0.0f);
+};
+
+// What the renderer needs of a jet, published by the simulation after every
+// batch of steps.
+struct jet_snapshot {
+	rigid_body    prev_body; // before the last physics step
+	rigid_body    body;
+	glm::vec3     center_of_mass = glm::vec3(0.0f); // body frame
+	glm::vec3     acceleration   = glm::vec3(0.0f); // world, gravity included
+	control_input input; // as of the last update_controls()
+	// thrust first, then the wing forces, body frame
+	std::vector<jet_force_vec> forces;
+};
+
+// speed and load factor, to stdout
+void log_telemetry(const jet_snapshot &snapshot);
+
+template <typename T>
+using jet_surface_controls = typename basic_aero_model<T>::surface_controls;
+
+// The jet force model for one step of a body kept anywhere: thrust and the
+// fuel it burns, then aero loads at whatever states the integrator asks
+// about, with the surfaces set to controls. Returns the world acceleration at
+// the start of the step, gravity included, and the thrust if asked for.
+// Generic over the scalar type like the parts it drives, jet_model and the
+// fleet fly it in float.
+template <typename T>
+glm::vec<3, T> step_jet_body(
+    const aircraft_def::engine_props         &engine,
+    basic_aero_model<T>                      &aero,
+    std::span<const jet_surface_controls<T>> controls,
+    T                                        throttle,
+    bool                                     afterburner,
+    basic_integrator<T>                      &stepper,
+    basic_rigid_body<T>                      &body,
+    basic_mass_properties<T>                 &mass,
+    T                                        dt,
+    jet_force_vec                            *thrust_out = nullptr
+) {
+	using vec3 = glm::vec<3, T>;
+
+	const vec3 forward_vec = vec3(1, 0, 0);
+
+	// all forces are in local space
+
+	// thrust
+	T thrust = throttle * T(
+	    afterburner ? engine.max_thrust_wet : engine.max_thrust_dry
+	); // N
+	// fuel burn follows thrust, flames out once the tanks run dry
+	T tsfc      = afterburner ? engine.tsfc_wet : engine.tsfc_dry;
+	T fuel_burn = thrust * tsfc * dt; // kg
+	if (mass.burn(fuel_burn) < fuel_burn) {
+		thrust = T(0);
+	}
+	glm::qua<T> thrust_rot = glm::angleAxis(
+	    glm::radians(T(-engine.incidence_deg)), vec3(0, 1, 0)
+	);
+	vec3 thrust_force  = thrust_rot * forward_vec;
+	thrust_force      *= thrust;
+	vec3 thrust_origin = vec3(engine.position);
+	if (thrust_out) {
+		*thrust_out = {glm::vec3(thrust_force), engine.position};
+	}
+
+	// wing forces, at whatever state the integrator asks about
+	const vec3 center_of_mass = mass.get_center_of_mass();
+
+	auto loads_at = [&](const basic_rigid_body<T> &state) {
+		// air velocity in local airplane space
+		vec3 local_vel     = state.to_body(state.vel);
+		vec3 local_ang_vel = state.to_body(state.ang_vel);
+
+		typename basic_aero_model<T>::totals wing_totals = aero.evaluate(
+		    controls, local_vel, local_ang_vel, center_of_mass
+		);
+
+		// combine forces
+		typename basic_rigid_body<T>::loads loads;
+		loads.force  = thrust_force + wing_totals.force;
+		loads.torque =
+		    glm::cross(thrust_origin - center_of_mass, thrust_force) +
+		    wing_totals.torque;
+		return loads;
+	};
+
+	// integrate movement
+	return stepper.step(body, mass, loads_at, dt);
+}
+
+// The flight model of a jet: airframe, engine, fuel and the rigid body they
+// move. Needs no window or GL context, the jet entity draws whatever
+// write_snapshot() hands it.
+class jet_model {
+public:
+	void init(const std::filesystem::path &aircraft_path);
+
+	// update_controls() then update_physics(), for running both at one rate
+	void update_physics_from_input(const control_input &input, float dt);
+	// control mixing, and the debug turn
+	void update_controls(const control_input &input, float dt);
+	// thrust, fuel, aero and one integrator step, with the last controls
+	void update_physics(float dt);
+	void write_snapshot(jet_snapshot &out) const;
+
+	// how update_physics() steps the body, see integrator.hpp
+	void               set_integrator(integrator::method method);
+	integrator::method get_integrator() const;
+
+	const aircraft_def    &get_def() const;
+	const aero_model      &get_aero() const;
+	const rigid_body      &get_body() const;
+	const mass_properties &get_mass() const;
+	// world frame, gravity included, at the start of the last step
+	glm::vec3              get_acceleration() const;
+	float                  get_throttle() const;
+
+	void set_body(const rigid_body &state);
+
+protected:
+	aircraft_def def; // airframe, engine and control mixing
+
+	// world frame state, integrated in update_physics()
+	rigid_body      body{.vel = glm::vec3(100.0f, 0, 0)};
+	rigid_body      prev_body = body; // before the last physics step
+	mass_properties mass; // airframe + fuel, full tanks after init()
+	integrator      integrator_; // semi-implicit euler unless set
+
+	control_input last_input; // of update_controls()
+	float         throttle_level = 0.0f; // (0, 1)
+	bool          afterburner_on = false;
+
+	// all surfaces of def, flattened
+	aero_model                                aero;
+	std::vector<aero_model::surface_controls> controls; // per step, mixed
+
+	// forces of the last step, thrust first, body frame
+	std::vector<jet_force_vec> forces;
+
+	glm::vec3 last_accel = glm::vec3(0.0f); // world, gravity included
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "pch.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FLIGHT_SIM_HAS_MMAP 1
+#endif
+
+// read-only view of a whole file, memory-mapped where the platform allows it
+// (falls back to reading the file into a heap buffer)
+class mapped_file {
+public:
+	mapped_file() = default;
+	mapped_file(const mapped_file &)            = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+
+	~mapped_file() {
+		close();
+	}
+
+	void open(const std::filesystem::path &path) {
+		close();
+#ifdef FLIGHT_SIM_HAS_MMAP
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw std::runtime_error("Failed to open file: " + path.string());
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0) {
+			::close(fd);
+			throw std::runtime_error("Failed to stat file: " + path.string());
+		}
+		size_ = static_cast<size_t>(st.st_size);
+		if (size_ > 0) {
+			void *ptr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (ptr == MAP_FAILED) {
+				::close(fd);
+				throw std::runtime_error(
+				    "Failed to map file: " + path.string()
+				);
+			}
+			data_ = static_cast<const uint8_t *>(ptr);
+		}
+		::close(fd); // the mapping stays valid after close
+#else
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to open file: " + path.string());
+		}
+		fallback_buffer.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(
+		    reinterpret_cast<char *>(fallback_buffer.data()),
+		    fallback_buffer.size()
+		);
+		size_ = fallback_buffer.size();
+		data_ = fallback_buffer.data();
+#endif
+	}
+
+	void close() {
+#ifdef FLIGHT_SIM_HAS_MMAP
+		if (data_ != nullptr) {
+			munmap(const_cast<uint8_t *>(data_), size_);
+		}
+#else
+		fallback_buffer.clear();
+#endif
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	const uint8_t *data() const {
+		return data_;
+	}
+
+	size_t size() const {
+		return size_;
+	}
+
+private:
+	const uint8_t *data_ = nullptr;
+	size_t         size_ = 0;
+#ifndef FLIGHT_SIM_HAS_MMAP
+	std::vector<uint8_t> fallback_buffer;
+#endif
+};
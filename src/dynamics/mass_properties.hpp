@@ -0,0 +1,124 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "aircraft_def.hpp"
+
+// Mass, center of mass and inertia of the airframe together with its fuel.
+// The fuel sits at fuel_center and its own inertia scales with how much of it
+// is left. Inertia is about the combined center of mass, in the body frame.
+//
+// The mass always follows the fuel exactly. Center of mass, inertia and its
+// inverse are cached and only rebuilt by set_fuel() or once burn() has moved
+// the fuel by more than refresh_fraction of max_fuel since the last rebuild.
+template <typename T> class basic_mass_properties {
+public:
+	using vec3 = glm::vec<3, T>;
+	using mat3 = glm::mat<3, 3, T>;
+
+	static constexpr T refresh_fraction = T(0.001);
+
+	basic_mass_properties() = default;
+
+	// starts with full tanks
+	explicit basic_mass_properties(const aircraft_def::mass_props &props)
+	    : empty_mass(props.empty_mass),
+	      max_fuel(props.max_fuel),
+	      empty_center(props.center_of_mass),
+	      empty_inertia(props.inertia),
+	      fuel_center(props.fuel_center),
+	      full_fuel_inertia(props.fuel_inertia) {
+		set_fuel(max_fuel);
+	}
+
+	// kg, clamped to [0, max_fuel]
+	void set_fuel(T fuel_mass) {
+		fuel              = std::clamp(fuel_mass, T(0), max_fuel);
+		fuel_compensation = T(0);
+		rebuild();
+	}
+
+	// Burns up to fuel_mass kg, returns how much there was to burn. A step's
+	// worth of fuel is close to the float resolution of full tanks, so the
+	// subtraction is Kahan-compensated.
+	T burn(T fuel_mass) {
+		T burned          = std::clamp(fuel_mass, T(0), fuel);
+		T delta           = -burned - fuel_compensation;
+		T new_fuel        = fuel + delta;
+		fuel_compensation = (new_fuel - fuel) - delta;
+		fuel              = std::max(new_fuel, T(0));
+		if (std::abs(fuel - built_fuel) > refresh_fraction * max_fuel) {
+			rebuild();
+		}
+		return burned;
+	}
+
+	T get_fuel() const {
+		return fuel;
+	}
+
+	T get_fuel_fraction() const {
+		return max_fuel > T(0) ? fuel / max_fuel : T(0);
+	}
+
+	T get_mass() const {
+		return empty_mass + fuel;
+	}
+
+	vec3 get_center_of_mass() const {
+		return center_of_mass;
+	}
+
+	const mat3 &get_inertia() const {
+		return inertia;
+	}
+
+	const mat3 &get_inverse_inertia() const {
+		return inverse_inertia;
+	}
+
+private:
+	T    empty_mass        = T(1);
+	T    max_fuel          = T(0);
+	vec3 empty_center      = vec3(0);
+	vec3 empty_inertia     = vec3(1);
+	vec3 fuel_center       = vec3(0);
+	vec3 full_fuel_inertia = vec3(0);
+
+	T    fuel              = T(0);
+	T    fuel_compensation = T(0); // rounding error of the last burn()
+	T    built_fuel        = T(0); // fuel the cache below was built for
+	vec3 center_of_mass    = vec3(0);
+	mat3 inertia           = mat3(1);
+	mat3 inverse_inertia   = mat3(1);
+
+	static mat3 diagonal(vec3 v) {
+		mat3 m(T(0));
+		m[0][0] = v.x;
+		m[1][1] = v.y;
+		m[2][2] = v.z;
+		return m;
+	}
+
+	// a point mass at offset d, by the parallel axis theorem
+	static mat3 point_inertia(T mass, vec3 d) {
+		return mass * (glm::dot(d, d) * mat3(1) - glm::outerProduct(d, d));
+	}
+
+	void rebuild() {
+		center_of_mass = (empty_mass * empty_center + fuel * fuel_center) /
+		                 get_mass();
+
+		inertia = diagonal(empty_inertia) +
+		          point_inertia(empty_mass, empty_center - center_of_mass) +
+		          diagonal(full_fuel_inertia * get_fuel_fraction()) +
+		          point_inertia(fuel, fuel_center - center_of_mass);
+		inverse_inertia = glm::inverse(inertia);
+		built_fuel      = fuel;
+	}
+};
+
+using mass_properties = basic_mass_properties<float>;
+
+extern template class basic_mass_properties<float>;
+extern template class basic_mass_properties<double>;
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "pch.hpp"
+
+// World-frame state of a rigid body and its time derivative, generic over the
+// scalar type like the rest of the dynamics. The steppers are in
+// integrator.hpp.
+template <typename T> struct basic_rigid_body {
+	using vec3 = glm::vec<3, T>;
+	using quat = glm::qua<T>;
+	using mat3 = glm::mat<3, 3, T>;
+
+	vec3 pos     = vec3(0);          // m
+	quat rot     = quat(1, 0, 0, 0); // w, x, y, z
+	vec3 vel     = vec3(0);          // m/s
+	vec3 ang_vel = vec3(0);          // r-vec, rad/s
+	mat3 rot_mat = mat3(1);          // rot as a matrix, see sync_rotation()
+
+	// normalizes rot and refreshes rot_mat, needed after writing rot
+	void sync_rotation() {
+		rot     = glm::normalize(rot);
+		rot_mat = glm::mat3_cast(rot);
+	}
+
+	// applies a world-frame rotation on top of the current one
+	void rotate(quat world_rot) {
+		rot = world_rot * rot;
+		sync_rotation();
+	}
+
+	vec3 to_world(vec3 body_vec) const {
+		return rot_mat * body_vec;
+	}
+
+	// rot_mat is orthonormal, so the inverse is the transpose
+	vec3 to_body(vec3 world_vec) const {
+		return world_vec * rot_mat;
+	}
+
+	// force and torque in the body frame, torque about the center of mass
+	struct loads {
+		vec3 force  = vec3(0); // N
+		vec3 torque = vec3(0); // N*m
+	};
+
+	// time derivative of the state, everything in the world frame
+	struct derivative {
+		vec3 vel       = vec3(0);          // of pos, m/s
+		quat rot       = quat(0, 0, 0, 0); // of rot, 1/s
+		vec3 accel     = vec3(0);          // of vel, m/s^2
+		vec3 ang_accel = vec3(0);          // of ang_vel, rad/s^2
+
+		friend derivative operator+(const derivative &a, const derivative &b) {
+			return {
+			    a.vel + b.vel,
+			    a.rot + b.rot,
+			    a.accel + b.accel,
+			    a.ang_accel + b.ang_accel
+			};
+		}
+
+		friend derivative operator*(const derivative &d, T s) {
+			return {d.vel * s, d.rot * s, d.accel * s, d.ang_accel * s};
+		}
+	};
+
+	// Rate of change of this state under the given loads. vel is that of the
+	// center of mass and the body turns about it, so pos (the model origin)
+	// picks up -ang_vel x center_of_mass. The angular part is Euler's
+	// equation, gyroscopic term included.
+	derivative derive(
+	    const loads &applied,
+	    T            mass,
+	    const mat3  &inertia,
+	    const mat3  &inverse_inertia,
+	    vec3         center_of_mass
+	) const {
+		vec3 body_ang_vel = to_body(ang_vel);
+		vec3 gyro = glm::cross(body_ang_vel, inertia * body_ang_vel);
+
+		derivative d;
+		d.vel       = vel - glm::cross(ang_vel, to_world(center_of_mass));
+		d.rot       = quat(0, ang_vel.x, ang_vel.y, ang_vel.z) * rot * T(0.5);
+		d.accel     = to_world(applied.force / mass);
+		d.ang_accel = to_world(inverse_inertia * (applied.torque - gyro));
+		// apply gravity
+		d.accel.z -= T(9.81);
+		return d;
+	}
+
+	// this state moved along d for dt, as the Runge-Kutta stages need it
+	basic_rigid_body advanced(const derivative &d, T dt) const {
+		basic_rigid_body b = *this;
+		b.pos     += d.vel * dt;
+		b.rot      = b.rot + d.rot * dt;
+		b.vel     += d.accel * dt;
+		b.ang_vel += d.ang_accel * dt;
+		b.sync_rotation();
+		return b;
+	}
+};
+
+using rigid_body = basic_rigid_body<float>;
+
+extern template struct basic_rigid_body<float>;
+extern template struct basic_rigid_body<double>;
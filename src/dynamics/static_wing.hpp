@@ -0,0 +1,416 @@
+#pragma once
+
+#include "pch.hpp"
+
+#include "aero_model.hpp"
+#include "fastmath.hpp"
+#include "wing.hpp"
+#include "wing_3d_helper.hpp"
+
+// Compile-time counterparts of wing and aero_model for airframes that are
+// fixed at build time. Section counts are template parameters and the
+// geometry is computed by constexpr constructors, so for a constexpr
+// static_aero_model every per-section loop has a known trip count and the
+// geometry folds into the force evaluation. Results match wing/aero_model to
+// float rounding.
+
+// cos() usable in constant expressions, range-reduced Taylor series in double
+constexpr float constexpr_cos_deg(float deg) {
+	double x = double(deg) * (M_PI / 180.0);
+	while (x > M_PI) {
+		x -= 2.0 * M_PI;
+	}
+	while (x < -M_PI) {
+		x += 2.0 * M_PI;
+	}
+	double term = 1.0, sum = 1.0;
+	for (int k = 1; k < 16; ++k) {
+		term *= -x * x / ((2 * k - 1) * (2 * k));
+		sum  += term;
+	}
+	return float(sum);
+}
+
+// wing_geometry with the section count fixed
+template <size_t N>
+struct static_wing_geometry {
+	std::array<float, N> areas            = {};
+	std::array<float, N> center_spanwise  = {};
+	std::array<float, N> center_chordwise = {};
+	std::array<float, N> lift_chordwise   = {};
+	std::array<float, N> drag_chordwise   = {};
+
+	float total_span             = 0.0f;
+	float total_area             = 0.0f;
+	float inv_total_area         = 0.0f;
+	float aspect_ratio           = 0.0f;
+	float effective_aspect_ratio = 0.0f;
+	float induced_drag_factor    = 0.0f;
+	float induced_drag_chordwise = 0.0f;
+};
+
+// Unlike wing, the airfoil is not stored (airfoils aren't literal types), it
+// is passed to calc_forces(). The sweep that goes into the induced drag
+// factor is given up front and has to match the airfoil's.
+template <size_t N>
+class static_wing {
+public:
+	static_assert(N > 0, "wing needs at least one section");
+
+	static constexpr size_t num_sections = N;
+
+	constexpr static_wing(
+	    const std::array<wing_section, N> &sections,
+	    float                              sweep_deg,
+	    float                              span_efficiency = 0.85f
+	)
+	    : sections(sections), sweep_deg(sweep_deg),
+	      span_efficiency(span_efficiency) {
+		for (const wing_section &sec : sections) {
+			if (sec.has_aileron && sec.has_flap) {
+				throw std::invalid_argument(
+				    "section cannot have both aileron and flap"
+				);
+			}
+		}
+		update_geometry();
+	}
+
+	constexpr const std::array<wing_section, N> &get_sections() const {
+		return sections;
+	}
+
+	constexpr float get_sweep_deg() const {
+		return sweep_deg;
+	}
+
+	constexpr float get_span_efficiency() const {
+		return span_efficiency;
+	}
+
+	constexpr const static_wing_geometry<N> &get_geometry() const {
+		return geometry;
+	}
+
+	// as wing::calc_forces()
+	void calc_forces(
+	    const airfoil                       &airfoil,
+	    const std::array<wing_speed_aoa, N> &speed_aoa,
+	    std::array<wing_force_vec, N>       &sectional_lift,
+	    std::array<wing_force_vec, N>       &sectional_drag,
+	    wing_force_vec                      &induced_drag,
+	    float                                aileron_deg = 0.0f,
+	    float                                flap_deg    = 0.0f,
+	    float                                slat_deg    = 0.0f,
+	    float                                air_density = 1.225f
+	) const {
+		float mean_cl    = 0.0f;
+		float mean_speed = 0.0f;
+		for (size_t i = 0; i < N; ++i) {
+			const wing_section &sec = sections[i];
+			auto [cl, cd]           = airfoil.calc_coeffs(
+                speed_aoa[i].aoa,
+                (static_cast<int>(sec.has_aileron) * aileron_deg +
+                 static_cast<int>(sec.has_flap) * flap_deg),
+                static_cast<int>(sec.has_slat) * slat_deg
+            );
+
+			float area  = geometry.areas[i];
+			float speed = speed_aoa[i].speed;
+			float q     = air_density * speed * speed * 0.5f;
+
+			sectional_lift[i] = {
+			    .force            = cl * q * area,
+			    .origin_spanwise  = geometry.center_spanwise[i],
+			    .origin_chordwise = geometry.lift_chordwise[i],
+			};
+			sectional_drag[i] = {
+			    .force            = cd * q * area,
+			    .origin_spanwise  = geometry.center_spanwise[i],
+			    .origin_chordwise = geometry.drag_chordwise[i],
+			};
+
+			if (q != 0.0f) {
+				mean_cl += cl * area;
+			}
+			mean_speed += speed * area;
+		}
+		mean_cl    *= geometry.inv_total_area;
+		mean_speed *= geometry.inv_total_area;
+
+		float cd           = mean_cl * mean_cl * geometry.induced_drag_factor;
+		float q_mean       = air_density * mean_speed * mean_speed * 0.5f;
+		induced_drag.force = cd * q_mean * geometry.total_area / 2.0f;
+		induced_drag.origin_spanwise  = geometry.total_span * 0.5f;
+		induced_drag.origin_chordwise = geometry.induced_drag_chordwise;
+	}
+
+private:
+	std::array<wing_section, N> sections;
+	float                       sweep_deg;
+	float                       span_efficiency;
+	static_wing_geometry<N>     geometry;
+
+	// same steps as wing::update_geometry()
+	constexpr void update_geometry() {
+		float cumulative_span = 0.0f;
+		float chordwise_shift = 0.0f;
+		float total_area      = 0.0f;
+		for (size_t i = 0; i < N; ++i) {
+			const wing_section &sec = sections[i];
+
+			geometry.center_chordwise[i]  = chordwise_shift;
+			cumulative_span              += sec.span;
+			chordwise_shift              += sec.chordwise_shift;
+
+			geometry.areas[i]           = sec.span * sec.chord;
+			geometry.center_spanwise[i] = cumulative_span - sec.span * 0.5f;
+			geometry.lift_chordwise[i]  = chordwise_shift - sec.chord * 0.25f;
+			geometry.drag_chordwise[i]  = chordwise_shift;
+
+			total_area += geometry.areas[i];
+		}
+		geometry.total_span     = cumulative_span;
+		geometry.total_area     = total_area;
+		geometry.inv_total_area = 1.0f / total_area;
+
+		float mean_chord      = total_area / cumulative_span;
+		geometry.aspect_ratio = cumulative_span / mean_chord;
+
+		float cos_sweep = constexpr_cos_deg(sweep_deg);
+		float effective_aspect_ratio =
+		    geometry.aspect_ratio * cos_sweep * cos_sweep;
+		effective_aspect_ratio *= 2.0f; // symmetric pair
+		effective_aspect_ratio *= 1.5f; // fuselage width
+
+		geometry.effective_aspect_ratio = effective_aspect_ratio;
+		geometry.induced_drag_factor =
+		    1.0f / (M_PI * effective_aspect_ratio * span_efficiency);
+		geometry.induced_drag_chordwise =
+		    (geometry.drag_chordwise.front() + geometry.drag_chordwise.back()) *
+		    0.5f;
+	}
+};
+
+// static_wing mounted on the airframe, see aero_model::add_surface()
+template <size_t N>
+struct static_surface {
+	static_wing<N> wing;
+	uint32_t       airfoil; // index into the airfoils of evaluate()
+	glm::vec3      root_pos;
+	bool           is_right_wing;
+	glm::vec3      incidence_axis = glm::vec3(0.0f, -1.0f, 0.0f);
+};
+
+// aero_model with the surfaces fixed at compile time. The constructor
+// flattens the surfaces into constexpr per-section tables, evaluate() runs
+// the same passes as aero_model::evaluate() over them. Declare it constexpr:
+//
+//   constexpr static_aero_model model(
+//       static_surface<2>{main_wing, 0, {-14.4f, 2.25f, 0.0f}, false},
+//       ...
+//   );
+template <size_t... N>
+class static_aero_model {
+public:
+	static constexpr size_t num_surfaces = sizeof...(N);
+	static constexpr size_t num_sections = (N + ...);
+	static constexpr size_t num_forces   = 2 * num_sections + num_surfaces;
+
+	using controls_array =
+	    std::array<aero_model::surface_controls, num_surfaces>;
+	using forces_array = std::array<wing_force_vec_3d, num_forces>;
+
+	constexpr static_aero_model(const static_surface<N> &...surfaces) {
+		size_t s = 0, i = 0, slot = 0;
+		(add_surface(surfaces, s, i, slot), ...);
+	}
+
+	// Writes every force to forces in aero_model::get_force() order.
+	// airfoils[i] is the airfoil of surfaces with airfoil index i.
+	aero_model::totals evaluate(
+	    std::span<const airfoil *const> airfoils,
+	    const controls_array           &controls,
+	    glm::vec3                       linear_velocity,
+	    glm::vec3                       angular_velocity,
+	    glm::vec3                       center_of_mass,
+	    forces_array                   &forces,
+	    float                           air_density = 1.225f
+	) const {
+		for (size_t s = 0; s < num_surfaces; ++s) {
+			if (surface_airfoil[s] >= airfoils.size() ||
+			    airfoils[surface_airfoil[s]]->sweep_deg != surface_sweep[s]) {
+				throw std::invalid_argument(
+				    "airfoils don't match the static surfaces"
+				);
+			}
+		}
+
+		// surface frames
+		std::array<glm::vec3, num_surfaces> forward, left, up, mean_move_dir;
+		std::array<float, num_surfaces>     mean_cl, mean_speed;
+		for (size_t s = 0; s < num_surfaces; ++s) {
+			glm::quat rot = glm::normalize(glm::angleAxis(
+			    glm::radians(controls[s].incidence_deg), incidence_axis[s]
+			));
+			forward[s]       = rot * glm::vec3(1.0f, 0.0f, 0.0f);
+			left[s]          = rot * glm::vec3(0.0f, 1.0f, 0.0f);
+			up[s]            = rot * glm::vec3(0.0f, 0.0f, 1.0f);
+			mean_cl[s]       = 0.0f;
+			mean_speed[s]    = 0.0f;
+			mean_move_dir[s] = glm::vec3(0.0f);
+		}
+
+		// sectional airspeed and aoa
+		std::array<glm::vec3, num_sections> move_dir;
+		std::array<float, num_sections>     speed, aoa;
+		for (size_t i = 0; i < num_sections; ++i) {
+			size_t    s      = section_surface[i];
+			glm::vec3 center = forward[s] * section_center_forward[i] +
+			                   left[s] * section_left[i] + root_pos[s];
+			glm::vec3 vel    = wing_local_velocity(
+                center, linear_velocity, angular_velocity, center_of_mass
+            );
+			move_dir[i] = sim_normalize(vel);
+
+			glm::vec3 vel_in_plane = vel - glm::dot(vel, left[s]) * left[s];
+			glm::vec3 dir          = sim_normalize(vel_in_plane);
+			float     cos_forward  = glm::dot(forward[s], dir);
+			float     cos_up       = glm::dot(up[s], dir);
+			cos_forward            = std::isnan(cos_forward)
+			                           ? 1.0f
+			                           : std::clamp(cos_forward, -1.0f, 1.0f);
+			cos_up =
+			    std::isnan(cos_up) ? 0.0f : std::clamp(cos_up, -1.0f, 1.0f);
+
+			speed[i] = glm::length(vel_in_plane);
+			aoa[i]   = -glm::degrees(sim_atan2(cos_up, cos_forward));
+		}
+
+		// coefficients and force magnitudes
+		std::array<float, num_sections> lift, drag;
+		for (size_t i = 0; i < num_sections; ++i) {
+			size_t                              s = section_surface[i];
+			const aero_model::surface_controls &c = controls[s];
+			float control = section_aileron_mask[i] * c.aileron_deg +
+			                section_flap_mask[i] * c.flap_deg;
+			auto [cl, cd] = airfoils[surface_airfoil[s]]->calc_coeffs(
+			    aoa[i], control, section_slat_mask[i] * c.slat_deg
+			);
+
+			float area = section_area[i];
+			float q    = air_density * speed[i] * speed[i] * 0.5f;
+			lift[i]    = cl * q * area;
+			drag[i]    = cd * q * area;
+
+			if (q != 0.0f) {
+				mean_cl[s] += cl * area;
+			}
+			mean_speed[s]    += speed[i] * area;
+			mean_move_dir[s] += move_dir[i] * area;
+		}
+
+		// sectional 3d forces
+		for (size_t i = 0; i < num_sections; ++i) {
+			size_t    s        = section_surface[i];
+			glm::vec3 spanwise = left[s] * section_left[i];
+			auto [lift_dir, drag_dir] = wing_force_dirs(move_dir[i], left[s]);
+			forces[section_lift_slot[i]] = {
+			    lift[i] * lift_dir,
+			    forward[s] * section_lift_forward[i] + spanwise + root_pos[s],
+			};
+			forces[section_drag_slot[i]] = {
+			    drag[i] * drag_dir,
+			    forward[s] * section_drag_forward[i] + spanwise + root_pos[s],
+			};
+		}
+
+		// induced drag, see wing::calc_forces()
+		for (size_t s = 0; s < num_surfaces; ++s) {
+			float m_cl   = mean_cl[s] * inv_total_area[s];
+			float m_spd  = mean_speed[s] * inv_total_area[s];
+			float cd     = m_cl * m_cl * induced_drag_factor[s];
+			float q_mean = air_density * m_spd * m_spd * 0.5f;
+			float drag   = cd * q_mean * total_area[s] / 2.0f;
+
+			glm::vec3 move = mean_move_dir[s] * inv_total_area[s];
+			glm::vec3 dir  = wing_force_dirs(move, left[s]).second;
+			forces[induced_slot[s]] = {
+			    drag * dir,
+			    forward[s] * induced_origin_forward[s] +
+			        left[s] * induced_origin_left[s] + root_pos[s],
+			};
+		}
+
+		// total force and torque
+		aero_model::totals result;
+		for (const wing_force_vec_3d &f : forces) {
+			result.force  += f.force;
+			result.torque += glm::cross(f.origin - center_of_mass, f.force);
+		}
+		return result;
+	}
+
+private:
+	// per surface, see aero_model::surface
+	std::array<uint32_t, num_surfaces>  surface_airfoil        = {};
+	std::array<float, num_surfaces>     surface_sweep          = {};
+	std::array<glm::vec3, num_surfaces> root_pos               = {};
+	std::array<glm::vec3, num_surfaces> incidence_axis         = {};
+	std::array<size_t, num_surfaces>    induced_slot           = {};
+	std::array<float, num_surfaces>     total_area             = {};
+	std::array<float, num_surfaces>     inv_total_area         = {};
+	std::array<float, num_surfaces>     induced_drag_factor    = {};
+	std::array<float, num_surfaces>     induced_origin_forward = {};
+	std::array<float, num_surfaces>     induced_origin_left    = {};
+
+	// per section
+	std::array<uint32_t, num_sections> section_surface        = {};
+	std::array<size_t, num_sections>   section_lift_slot      = {};
+	std::array<size_t, num_sections>   section_drag_slot      = {};
+	std::array<float, num_sections>    section_left           = {};
+	std::array<float, num_sections>    section_center_forward = {};
+	std::array<float, num_sections>    section_lift_forward   = {};
+	std::array<float, num_sections>    section_drag_forward   = {};
+	std::array<float, num_sections>    section_area           = {};
+	std::array<float, num_sections>    section_aileron_mask   = {};
+	std::array<float, num_sections>    section_flap_mask      = {};
+	std::array<float, num_sections>    section_slat_mask      = {};
+
+	// same layout as aero_model::add_surface()
+	template <size_t M>
+	constexpr void add_surface(
+	    const static_surface<M> &surf, size_t &s, size_t &i, size_t &slot
+	) {
+		const static_wing_geometry<M>     &geo  = surf.wing.get_geometry();
+		const std::array<wing_section, M> &secs = surf.wing.get_sections();
+		float side = surf.is_right_wing ? -1.0f : 1.0f;
+
+		surface_airfoil[s]        = surf.airfoil;
+		surface_sweep[s]          = surf.wing.get_sweep_deg();
+		root_pos[s]               = surf.root_pos;
+		incidence_axis[s]         = surf.incidence_axis;
+		induced_slot[s]           = slot + 2 * M;
+		total_area[s]             = geo.total_area;
+		inv_total_area[s]         = geo.inv_total_area;
+		induced_drag_factor[s]    = geo.induced_drag_factor;
+		induced_origin_forward[s] = -geo.induced_drag_chordwise;
+		induced_origin_left[s]    = side * geo.total_span * 0.5f;
+
+		for (size_t j = 0; j < M; ++j, ++i) {
+			section_surface[i]        = static_cast<uint32_t>(s);
+			section_lift_slot[i]      = slot + j;
+			section_drag_slot[i]      = slot + M + j;
+			section_left[i]           = side * geo.center_spanwise[j];
+			section_center_forward[i] = -geo.center_chordwise[j];
+			section_lift_forward[i]   = -geo.lift_chordwise[j];
+			section_drag_forward[i]   = -geo.drag_chordwise[j];
+			section_area[i]           = geo.areas[j];
+			section_aileron_mask[i]   = secs[j].has_aileron;
+			section_flap_mask[i]      = secs[j].has_flap;
+			section_slat_mask[i]      = secs[j].has_slat;
+		}
+		slot += 2 * M + 1;
+		++s;
+	}
+};
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "../pch.hpp"
+#include "pch.hpp"
 
 #include "airfoil.hpp"
 
@@ -15,40 +15,94 @@ struct wing_section {
 	bool has_slat = false;
 };
 
-struct wing_force_vec {
-	float force            = 0.0f;
-	float origin_spanwise  = 0.0f; // towards the outside of the wing
-	float origin_chordwise = 0.0f; // towards the back of the wing
+// The scalar type T (float or double) is what forces and geometry are
+// computed in. Sections, airfoils and curves are stored as float either way
+// and shared between both.
+
+template <typename T> struct basic_wing_force_vec {
+	T force            = T(0);
+	T origin_spanwise  = T(0); // towards the outside of the wing
+	T origin_chordwise = T(0); // towards the back of the wing
+};
+
+template <typename T> struct basic_wing_forces {
+	std::vector<basic_wing_force_vec<T>> sectional_lift;
+	std::vector<basic_wing_force_vec<T>> sectional_drag;
+	basic_wing_force_vec<T>              induced_drag;
 };
 
-struct wing_forces {
-	std::vector<wing_force_vec> sectional_lift;
-	std::vector<wing_force_vec> sectional_drag;
-	wing_force_vec              induced_drag;
+template <typename T> struct basic_wing_speed_aoa {
+	T speed = T(0); // m/s
+	T aoa   = T(0); // degrees
 };
 
-struct wing_speed_aoa {
-	float speed = 0.0f; // m/s
-	float aoa   = 0.0f; // degrees
+// derived from the sections and airfoil, only changes with them
+template <typename T> struct basic_wing_geometry {
+	// per section, chordwise is towards the back of the wing
+	std::vector<T> areas;
+	std::vector<T> center_spanwise;  // middle of the section
+	std::vector<T> center_chordwise; // where airspeed is sampled
+	std::vector<T> lift_chordwise;   // quarter chord
+	std::vector<T> drag_chordwise;   // half chord
+
+	T total_span             = T(0);
+	T total_area             = T(0);
+	T inv_total_area         = T(0);
+	T aspect_ratio           = T(0); // single wing, span^2 / area
+	T effective_aspect_ratio = T(0);
+	// ^ for the whole wing pair incl. fuselage, scaled by cos^2(sweep)
+	T induced_drag_factor = T(0);
+	// ^ cd_induced = cl^2 * induced_drag_factor
+	T induced_drag_chordwise = T(0);
 };
 
-class wing {
+using wing_force_vec = basic_wing_force_vec<float>;
+using wing_forces    = basic_wing_forces<float>;
+using wing_speed_aoa = basic_wing_speed_aoa<float>;
+using wing_geometry  = basic_wing_geometry<float>;
+
+template <typename T> class basic_wing {
 public:
-	airfoil                   airfoil_;
-	std::vector<wing_section> sections;
-	float                     span_efficiency; // for induced drag
+	using wing_force_vec = basic_wing_force_vec<T>;
+	using wing_forces    = basic_wing_forces<T>;
+	using wing_speed_aoa = basic_wing_speed_aoa<T>;
+	using wing_geometry  = basic_wing_geometry<T>;
 
-	wing() = default;
+	basic_wing() = default;
 
-	wing(
-	    const airfoil                   &airfoil,
+	basic_wing(
+	    const airfoil_handle            &airfoil,
 	    const std::vector<wing_section> &sections,
-	    float                            span_efficiency = 0.85f
+	    T                                span_efficiency = T(0.85)
 	) {
+		if (!airfoil) {
+			throw std::invalid_argument("wing needs an airfoil");
+		}
 		this->airfoil_        = airfoil;
-		this->sections        = sections;
 		this->span_efficiency = span_efficiency;
+		set_sections(sections);
+	}
 
+	const airfoil_handle &get_airfoil() const {
+		return airfoil_;
+	}
+
+	const std::vector<wing_section> &get_sections() const {
+		return sections;
+	}
+
+	T get_span_efficiency() const {
+		return span_efficiency;
+	}
+
+	const wing_geometry &get_geometry() const {
+		return geometry;
+	}
+
+	void set_sections(const std::vector<wing_section> &sections) {
+		if (sections.empty()) {
+			throw std::invalid_argument("wing needs at least one section");
+		}
 		// sanity check has_aileron and has_flap
 		for (size_t i = 0; i < sections.size(); ++i) {
 			if (sections[i].has_aileron && sections[i].has_flap) {
@@ -58,16 +112,18 @@ public:
 				);
 			}
 		}
+		this->sections = sections;
+		update_geometry();
 	}
 
 	wing_forces calc_forces(
-	    float speed,
-	    float aoa_deg,
-	    float aileron_deg = 0.0f,
-	    float flap_deg    = 0.0f,
-	    float slat_deg    = 0.0f,
-	    float air_density = 1.225f
-	) {
+	    T speed,
+	    T aoa_deg,
+	    T aileron_deg = T(0),
+	    T flap_deg    = T(0),
+	    T slat_deg    = T(0),
+	    T air_density = T(1.225)
+	) const {
 		std::vector<wing_speed_aoa> speed_aoa(
 		    sections.size(), {speed, aoa_deg}
 		);
@@ -78,114 +134,167 @@ public:
 
 	wing_forces calc_forces(
 	    const std::vector<wing_speed_aoa> &speed_aoa,
-	    float                              aileron_deg = 0.0f,
-	    float                              flap_deg    = 0.0f,
-	    float                              slat_deg    = 0.0f,
-	    float                              air_density = 1.225f
-	) {
+	    T                                  aileron_deg = T(0),
+	    T                                  flap_deg    = T(0),
+	    T                                  slat_deg    = T(0),
+	    T                                  air_density = T(1.225)
+	) const {
 		wing_forces forces;
-		forces.sectional_lift.reserve(sections.size());
-		forces.sectional_drag.reserve(sections.size());
+		forces.sectional_lift.resize(sections.size());
+		forces.sectional_drag.resize(sections.size());
+		calc_forces(
+		    speed_aoa,
+		    forces.sectional_lift,
+		    forces.sectional_drag,
+		    forces.induced_drag,
+		    aileron_deg,
+		    flap_deg,
+		    slat_deg,
+		    air_density
+		);
+		return forces;
+	}
+
+	// allocation-free variant, every span holds one element per section
+	void calc_forces(
+	    std::span<const wing_speed_aoa> speed_aoa,
+	    std::span<wing_force_vec>       sectional_lift,
+	    std::span<wing_force_vec>       sectional_drag,
+	    wing_force_vec                 &induced_drag,
+	    T                               aileron_deg = T(0),
+	    T                               flap_deg    = T(0),
+	    T                               slat_deg    = T(0),
+	    T                               air_density = T(1.225)
+	) const {
+		if (speed_aoa.size() < sections.size() ||
+		    sectional_lift.size() < sections.size() ||
+		    sectional_drag.size() < sections.size()) {
+			throw std::invalid_argument("wing force spans are too small");
+		}
 
 		// sectional forces
 
-		float cumulative_span = 0.0f;
-		float chordwise_shift = 0.0f;
+		T mean_cl    = T(0);
+		T mean_speed = T(0);
 		for (size_t i = 0; i < sections.size(); ++i) {
 			const wing_section &sec = sections[i];
-			auto [cl, cd]           = airfoil_.calc_coeffs(
+			auto [cl, cd]           = airfoil_->calc_coeffs(
                 speed_aoa[i].aoa,
                 (static_cast<int>(sec.has_aileron) * aileron_deg +
                  static_cast<int>(sec.has_flap) * flap_deg),
                 static_cast<int>(sec.has_slat) * slat_deg
             );
 
-			float area  = sec.span * sec.chord;
-			float speed = speed_aoa[i].speed;
-			float lift  = cl * (air_density * speed * speed * 0.5f) * area;
-			float drag  = cd * (air_density * speed * speed * 0.5f) * area;
+			T area  = geometry.areas[i];
+			T speed = speed_aoa[i].speed;
+			T q     = air_density * speed * speed * T(0.5);
 
-			cumulative_span += sec.span;
-			chordwise_shift += sec.chordwise_shift;
-
-			wing_force_vec lift_vec;
-			lift_vec.force            = lift;
-			lift_vec.origin_spanwise  = cumulative_span - sec.span * 0.5f;
-			lift_vec.origin_chordwise = chordwise_shift - sec.chord * 0.25f;
-			// ^ lift vector at 25% from leading edge chordwise, chordwise pos=0
-			// is middle
-
-			wing_force_vec drag_vec;
-			drag_vec.force            = drag;
-			drag_vec.origin_spanwise  = cumulative_span - sec.span * 0.5f;
-			drag_vec.origin_chordwise = chordwise_shift;
-			// ^ drag vector halfway through chord, chordwise pos=0 is middle
+			sectional_lift[i] = {
+			    .force            = cl * q * area,
+			    .origin_spanwise  = geometry.center_spanwise[i],
+			    .origin_chordwise = geometry.lift_chordwise[i],
+			};
+			sectional_drag[i] = {
+			    .force            = cd * q * area,
+			    .origin_spanwise  = geometry.center_spanwise[i],
+			    .origin_chordwise = geometry.drag_chordwise[i],
+			};
 
-			// add to sectional forces
-			forces.sectional_lift.push_back(lift_vec);
-			forces.sectional_drag.push_back(drag_vec);
+			// area weighted means for induced drag, a section with no
+			// airflow has no defined CL
+			if (q != T(0)) {
+				mean_cl += cl * area;
+			}
+			mean_speed += speed * area;
 		}
+		mean_cl    *= geometry.inv_total_area;
+		mean_speed *= geometry.inv_total_area;
 
 		// induced drag
 
-		// aspect ratio
-		float mean_chord = 0.0f;
-		for (const wing_section &sec : sections) {
-			mean_chord += sec.chord * sec.span; // weighted by span
-		}
-		mean_chord         /= cumulative_span;
-		float aspect_ratio  = cumulative_span / mean_chord;
+		T cd               = mean_cl * mean_cl * geometry.induced_drag_factor;
+		T q_mean           = air_density * mean_speed * mean_speed * T(0.5);
+		induced_drag.force = cd * q_mean * geometry.total_area;
 
-		// weighted mean CL and speed
-		float mean_cl    = 0.0f;
-		float mean_speed = 0.0f;
-		float total_area = 0.0f;
-		for (size_t i = 0; i < sections.size(); ++i) {
-			float sec_area = sections[i].span * sections[i].chord;
-			float speed    = speed_aoa[i].speed;
-			float sec_cl   = forces.sectional_lift[i].force /
-			               (air_density * speed * speed * 0.5f) / sec_area;
-			if (std::isnan(sec_cl)) {
-				sec_cl = 0.0f;
-			}
-			mean_cl    += sec_cl * sec_area;
-			mean_speed += speed * sec_area;
-			total_area += sec_area;
+		// this drag force is for a full wing span
+		// for just this left/right wing it would be two times smaller
+		induced_drag.force /= T(2);
+
+		induced_drag.origin_spanwise =
+		    geometry.total_span * T(0.5); // at the middle of the wing span
+		induced_drag.origin_chordwise = geometry.induced_drag_chordwise;
+	}
+
+private:
+	airfoil_handle            airfoil_; // shared, see airfoil_registry
+	std::vector<wing_section> sections;
+	T                         span_efficiency = T(0.85); // for induced drag
+	wing_geometry             geometry;
+
+	void update_geometry() {
+		size_t n = sections.size();
+		geometry.areas.resize(n);
+		geometry.center_spanwise.resize(n);
+		geometry.center_chordwise.resize(n);
+		geometry.lift_chordwise.resize(n);
+		geometry.drag_chordwise.resize(n);
+
+		T cumulative_span = T(0);
+		T chordwise_shift = T(0);
+		T total_area      = T(0);
+		for (size_t i = 0; i < n; ++i) {
+			const wing_section &sec = sections[i];
+
+			// airspeed is sampled before this section's own shift
+			geometry.center_chordwise[i]  = chordwise_shift;
+			cumulative_span              += sec.span;
+			chordwise_shift              += sec.chordwise_shift;
+
+			T span  = sec.span;
+			T chord = sec.chord;
+
+			geometry.areas[i]           = span * chord;
+			geometry.center_spanwise[i] = cumulative_span - span * T(0.5);
+			geometry.lift_chordwise[i]  = chordwise_shift - chord * T(0.25);
+			// ^ lift vector at 25% from leading edge chordwise, chordwise pos=0
+			// is middle
+			geometry.drag_chordwise[i] = chordwise_shift;
+			// ^ drag vector halfway through chord, chordwise pos=0 is middle
+
+			total_area += geometry.areas[i];
 		}
-		mean_cl    /= total_area;
-		mean_speed /= total_area;
+		geometry.total_span     = cumulative_span;
+		geometry.total_area     = total_area;
+		geometry.inv_total_area = T(1) / total_area;
+
+		// aspect ratio, mean chord weighted by span
+		T mean_chord          = total_area / cumulative_span;
+		geometry.aspect_ratio = cumulative_span / mean_chord;
 
 		// sweep effect
-		float cos_sweep = std::cos(glm::radians(airfoil_.sweep_deg));
-		float effective_aspect_ratio = aspect_ratio * cos_sweep * cos_sweep;
+		T cos_sweep = sim_cos(glm::radians(T(airfoil_->sweep_deg)));
+		T effective_aspect_ratio =
+		    geometry.aspect_ratio * cos_sweep * cos_sweep;
 
 		// ^ the aspect ratio is for just a single wing, not the whole pair
 		// the drag coefficient formula is for the full wing span
 		// let's assume that there's a symmetric pair of wings:
-		effective_aspect_ratio *= 2.0f;
+		effective_aspect_ratio *= T(2);
 		// we should also include fuselage width in the span
 		// don't have that info here, but let's approximate with 1.5 for fighter
 		// jets
-		effective_aspect_ratio *= 1.5f;
-
-		// drag coefficient
-		float cd = mean_cl * mean_cl /
-		           (M_PI * effective_aspect_ratio * span_efficiency);
-		float induced_drag =
-		    cd * (air_density * mean_speed * mean_speed * 0.5f) * total_area;
+		effective_aspect_ratio *= T(1.5);
 
-		// this drag force is for a full wing span
-		// for just this left/right wing it would be two times smaller
-		induced_drag /= 2.0f;
-
-		forces.induced_drag.force = induced_drag;
-		forces.induced_drag.origin_spanwise =
-		    cumulative_span * 0.5f; // at the middle of the wing span
-		forces.induced_drag.origin_chordwise =
-		    (forces.sectional_drag.front().origin_chordwise +
-		     forces.sectional_drag.back().origin_chordwise) *
-		    0.5f; // average first and last section origin
-
-		return forces;
+		geometry.effective_aspect_ratio = effective_aspect_ratio;
+		geometry.induced_drag_factor =
+		    T(1.0 / (M_PI * effective_aspect_ratio * span_efficiency));
+		geometry.induced_drag_chordwise =
+		    (geometry.drag_chordwise.front() + geometry.drag_chordwise.back()) *
+		    T(0.5); // average first and last section origin
 	}
 };
+
+using wing = basic_wing<float>;
+
+extern template class basic_wing<float>;
+extern template class basic_wing<double>;
@@ -1,22 +1,33 @@
 #pragma once
 
-#include "../pch.hpp"
+#include "pch.hpp"
 
+#include "fastmath.hpp"
 #include "wing.hpp"
 
-struct wing_force_vec_3d {
-	glm::vec3 force;
-	glm::vec3 origin;
+// Everything here is generic over the scalar type T of basic_wing<T>,
+// vectors are glm::vec<3, T> and rotations glm::qua<T>.
+
+template <typename T> struct basic_wing_force_vec_3d {
+	glm::vec<3, T> force;
+	glm::vec<3, T> origin;
 };
 
-struct wing_forces_3d {
-	std::vector<wing_force_vec_3d> sectional_lift;
-	std::vector<wing_force_vec_3d> sectional_drag;
-	wing_force_vec_3d              induced_drag;
+template <typename T> struct basic_wing_forces_3d {
+	std::vector<basic_wing_force_vec_3d<T>> sectional_lift;
+	std::vector<basic_wing_force_vec_3d<T>> sectional_drag;
+	basic_wing_force_vec_3d<T>              induced_drag;
 };
 
-inline glm::vec3 wing_local_velocity(
-    glm::vec3 point, glm::vec3 vel, glm::vec3 ang_vel, glm::vec3 rot_origin
+using wing_force_vec_3d = basic_wing_force_vec_3d<float>;
+using wing_forces_3d    = basic_wing_forces_3d<float>;
+
+template <typename T>
+inline glm::vec<3, T> wing_local_velocity(
+    glm::vec<3, T> point,
+    glm::vec<3, T> vel,
+    glm::vec<3, T> ang_vel,
+    glm::vec<3, T> rot_origin
 ) {
 	return vel + glm::cross(ang_vel, point - rot_origin);
 }
@@ -29,39 +40,46 @@ inline glm::vec3 wing_local_velocity(
 // wing_mount_pos/rot should transform from the described coordinate
 // convention to the same space as linear/angular_velocity and
 // origin_of_rotation
-struct wing_speed_aoa_and_move_dirs {
-	std::vector<wing_speed_aoa> speed_aoa;
-	std::vector<glm::vec3>      move_dirs;
+template <typename T> struct basic_wing_speed_aoa_and_move_dirs {
+	std::vector<basic_wing_speed_aoa<T>> speed_aoa;
+	std::vector<glm::vec<3, T>>          move_dirs;
 };
-inline wing_speed_aoa_and_move_dirs wing_sectional_speed_aoa(
-    const wing &wing,
-    glm::vec3   linear_velocity,
-    glm::vec3   angular_velocity,
-    glm::vec3   origin_of_rotation,
-    glm::vec3   wing_mount_pos,
-    glm::quat   wing_mount_rot,
-    bool        is_right_wing = false
+using wing_speed_aoa_and_move_dirs =
+    basic_wing_speed_aoa_and_move_dirs<float>;
+
+// allocation-free variant, the spans hold one element per section
+template <typename T>
+inline void wing_sectional_speed_aoa(
+    const basic_wing<T>               &wing,
+    glm::vec<3, T>                     linear_velocity,
+    glm::vec<3, T>                     angular_velocity,
+    glm::vec<3, T>                     origin_of_rotation,
+    glm::vec<3, T>                     wing_mount_pos,
+    glm::qua<T>                        wing_mount_rot,
+    bool                               is_right_wing,
+    std::span<basic_wing_speed_aoa<T>> speed_aoa,
+    std::span<glm::vec<3, T>>          move_dirs
 ) {
+	using vec3     = glm::vec<3, T>;
 	wing_mount_rot = glm::normalize(wing_mount_rot);
 
-	const glm::vec3 forward_vec = glm::vec3(1.0f, 0.0f, 0.0f);
-	const glm::vec3 left_vec    = glm::vec3(0.0f, 1.0f, 0.0f);
-	const glm::vec3 up_vec      = glm::vec3(0.0f, 0.0f, 1.0f);
+	const vec3 forward_vec = vec3(1, 0, 0);
+	const vec3 left_vec    = vec3(0, 1, 0);
+	const vec3 up_vec      = vec3(0, 0, 1);
 
-	glm::vec3 wing_forward_dir = wing_mount_rot * forward_vec;
-	glm::vec3 wing_left_dir    = wing_mount_rot * left_vec;
-	glm::vec3 wing_up_dir      = wing_mount_rot * up_vec;
-
-	std::vector<wing_speed_aoa> result(wing.sections.size());
-	std::vector<glm::vec3>      move_dirs(wing.sections.size());
-	float                       cumulative_span = 0.0f;
-	float                       chordwise_shift = 0.0f;
-	for (size_t i = 0; i < wing.sections.size(); i++) {
-		const wing_section &section = wing.sections[i];
+	vec3 wing_forward_dir = wing_mount_rot * forward_vec;
+	vec3 wing_left_dir    = wing_mount_rot * left_vec;
+	vec3 wing_up_dir      = wing_mount_rot * up_vec;
 
+	const basic_wing_geometry<T> &geometry = wing.get_geometry();
+	size_t                        n        = geometry.areas.size();
+	if (speed_aoa.size() < n || move_dirs.size() < n) {
+		throw std::invalid_argument("wing speed/aoa spans are too small");
+	}
+	for (size_t i = 0; i < n; i++) {
 		// section center in same ref frame as rotation origin
-		glm::vec3 section_center(
-		    -chordwise_shift, cumulative_span + section.span * 0.5f, 0.0f
+		vec3 section_center(
+		    -geometry.center_chordwise[i], geometry.center_spanwise[i], T(0)
 		);
 		if (is_right_wing) {
 			section_center.y = -section_center.y;
@@ -69,72 +87,103 @@ inline wing_speed_aoa_and_move_dirs wing_sectional_speed_aoa(
 		section_center = wing_mount_rot * section_center + wing_mount_pos;
 
 		// airspeed
-		glm::vec3 section_vel = wing_local_velocity(
+		vec3 section_vel = wing_local_velocity(
 		    section_center,
 		    linear_velocity,
 		    angular_velocity,
 		    origin_of_rotation
 		);
-		move_dirs[i] = glm::normalize(section_vel);
-		glm::vec3 vel_in_aerodynamic_plane =
+		move_dirs[i] = sim_normalize(section_vel);
+		vec3 vel_in_aerodynamic_plane =
 		    section_vel - glm::dot(section_vel, wing_left_dir) * wing_left_dir;
-		float airspeed = glm::length(vel_in_aerodynamic_plane);
+		T airspeed = glm::length(vel_in_aerodynamic_plane);
 		// aoa
-		float cosine_forward = glm::dot(
-		    wing_forward_dir, glm::normalize(vel_in_aerodynamic_plane)
+		T cosine_forward = glm::dot(
+		    wing_forward_dir, sim_normalize(vel_in_aerodynamic_plane)
 		);
-		float cosine_up =
-		    glm::dot(wing_up_dir, glm::normalize(vel_in_aerodynamic_plane));
+		T cosine_up =
+		    glm::dot(wing_up_dir, sim_normalize(vel_in_aerodynamic_plane));
 		cosine_forward = std::isnan(cosine_forward)
-		                   ? 1.0
-		                   : std::clamp(cosine_forward, -1.0f, 1.0f);
+		                   ? T(1)
+		                   : std::clamp(cosine_forward, T(-1), T(1));
 		cosine_up =
-		    std::isnan(cosine_up) ? 0.0 : std::clamp(cosine_up, -1.0f, 1.0f);
-		float aoa = -glm::degrees(std::atan2(cosine_up, cosine_forward));
+		    std::isnan(cosine_up) ? T(0) : std::clamp(cosine_up, T(-1), T(1));
+		T aoa = -glm::degrees(sim_atan2(cosine_up, cosine_forward));
 		// ^ minus since when wing is moving upwards (positive atan2 angle), the
 		// air hits from above (need negative aoa)
 
-		result[i] = {airspeed, aoa};
-
-		cumulative_span += section.span;
-		chordwise_shift += section.chordwise_shift;
+		speed_aoa[i] = {airspeed, aoa};
 	}
+}
 
-	return {result, move_dirs};
+template <typename T>
+inline basic_wing_speed_aoa_and_move_dirs<T> wing_sectional_speed_aoa(
+    const basic_wing<T> &wing,
+    glm::vec<3, T>       linear_velocity,
+    glm::vec<3, T>       angular_velocity,
+    glm::vec<3, T>       origin_of_rotation,
+    glm::vec<3, T>       wing_mount_pos,
+    glm::qua<T>          wing_mount_rot,
+    bool                 is_right_wing = false
+) {
+	size_t                                n = wing.get_sections().size();
+	basic_wing_speed_aoa_and_move_dirs<T> result;
+	result.speed_aoa.resize(n);
+	result.move_dirs.resize(n);
+	wing_sectional_speed_aoa<T>(
+	    wing,
+	    linear_velocity,
+	    angular_velocity,
+	    origin_of_rotation,
+	    wing_mount_pos,
+	    wing_mount_rot,
+	    is_right_wing,
+	    result.speed_aoa,
+	    result.move_dirs
+	);
+	return result;
 }
 
-inline glm::vec3 safe_normalize(const glm::vec3 &v) {
-	if (glm::length(v) > 1e-4f) {
+template <typename T>
+inline glm::vec<3, T> safe_normalize(const glm::vec<3, T> &v) {
+	if (glm::length(v) > T(1e-4)) {
 		return glm::normalize(v);
 	} else {
-		return glm::vec3(0.0f);
+		return glm::vec<3, T>(0);
 	}
 }
 
-inline wing_force_vec_3d map_wing_force_to_3d(
-    const wing_force_vec &force,
-    glm::vec3             wing_mount_pos,
-    glm::quat             wing_mount_rot,
-    bool                  is_drag,
-    glm::vec3             move_dir,
-    bool                  is_right_wing
-) {
-	const glm::vec3 left_vec      = glm::vec3(0.0f, 1.0f, 0.0f);
-	glm::vec3       wing_left_dir = wing_mount_rot * left_vec;
-
+// lift and drag directions for a move dir, as map_wing_force_to_3d()
+template <typename T>
+inline std::pair<glm::vec<3, T>, glm::vec<3, T>>
+wing_force_dirs(glm::vec<3, T> move_dir, glm::vec<3, T> wing_left_dir) {
 	move_dir = safe_normalize(move_dir);
-	glm::vec3 aerodynamic_plane_move_dir =
+	glm::vec<3, T> aerodynamic_plane_move_dir =
 	    move_dir - glm::dot(move_dir, wing_left_dir) * wing_left_dir;
-	glm::vec3 lift_dir =
+	glm::vec<3, T> lift_dir =
 	    safe_normalize(glm::cross(aerodynamic_plane_move_dir, wing_left_dir));
-	glm::vec3 drag_dir = -move_dir;
+	return {lift_dir, -move_dir};
+}
 
-	wing_force_vec_3d result;
-	result.origin = wing_mount_rot * glm::vec3(
+template <typename T>
+inline basic_wing_force_vec_3d<T> map_wing_force_to_3d(
+    const basic_wing_force_vec<T> &force,
+    glm::vec<3, T>                 wing_mount_pos,
+    glm::qua<T>                    wing_mount_rot,
+    bool                           is_drag,
+    glm::vec<3, T>                 move_dir,
+    bool                           is_right_wing
+) {
+	const glm::vec<3, T> left_vec      = glm::vec<3, T>(0, 1, 0);
+	glm::vec<3, T>       wing_left_dir = wing_mount_rot * left_vec;
+	auto [lift_dir, drag_dir] = wing_force_dirs(move_dir, wing_left_dir);
+
+	basic_wing_force_vec_3d<T> result;
+	result.origin = wing_mount_rot * glm::vec<3, T>(
 	                                     -force.origin_chordwise,
 	                                     is_right_wing ? -force.origin_spanwise
 	                                                   : force.origin_spanwise,
-	                                     0.0f
+	                                     T(0)
 	                                 ) +
 	                wing_mount_pos;
 	result.force = force.force * (is_drag ? drag_dir : lift_dir);
@@ -142,15 +191,16 @@ inline wing_force_vec_3d map_wing_force_to_3d(
 	return result;
 }
 
-inline wing_forces_3d map_wing_forces_to_3d(
-    const wing_forces            &forces,
-    glm::vec3                     wing_mount_pos,
-    glm::quat                     wing_mount_rot,
-    const std::vector<glm::vec3> &section_move_dirs,
-    const glm::vec3               main_move_dir,
-    bool                          is_right_wing
+template <typename T>
+inline basic_wing_forces_3d<T> map_wing_forces_to_3d(
+    const basic_wing_forces<T>        &forces,
+    glm::vec<3, T>                     wing_mount_pos,
+    glm::qua<T>                        wing_mount_rot,
+    const std::vector<glm::vec<3, T>> &section_move_dirs,
+    const glm::vec<3, T>               main_move_dir,
+    bool                               is_right_wing
 ) {
-	wing_forces_3d result;
+	basic_wing_forces_3d<T> result;
 	result.sectional_lift.reserve(forces.sectional_lift.size());
 	result.sectional_drag.reserve(forces.sectional_lift.size());
 
@@ -184,18 +234,32 @@ inline wing_forces_3d map_wing_forces_to_3d(
 	return result;
 }
 
-inline wing_forces_3d calc_wing_forces_3d(
-    wing     &wing,
-    glm::vec3 linear_velocity,
-    glm::vec3 angular_velocity,
-    glm::vec3 origin_of_rotation,
-    glm::vec3 wing_mount_pos,
-    glm::quat wing_mount_rot,
-    bool      is_right_wing = false,
-    float     aileron_deg   = 0.0f,
-    float     flap_deg      = 0.0f,
-    float     slat_deg      = 0.0f,
-    float     air_density   = 1.225f
+// area weighted mean of the section move dirs
+template <typename T>
+inline glm::vec<3, T> wing_mean_move_dir(
+    const basic_wing<T> &wing, std::span<const glm::vec<3, T>> move_dirs
+) {
+	const basic_wing_geometry<T> &geometry = wing.get_geometry();
+	glm::vec<3, T>                mean_move_dir(0);
+	for (size_t i = 0; i < move_dirs.size(); ++i) {
+		mean_move_dir += move_dirs[i] * geometry.areas[i];
+	}
+	return mean_move_dir * geometry.inv_total_area;
+}
+
+template <typename T>
+inline basic_wing_forces_3d<T> calc_wing_forces_3d(
+    const basic_wing<T>    &wing,
+    glm::vec<3, T>          linear_velocity,
+    glm::vec<3, T>          angular_velocity,
+    glm::vec<3, T>          origin_of_rotation,
+    glm::vec<3, T>          wing_mount_pos,
+    glm::qua<T>             wing_mount_rot,
+    bool                    is_right_wing = false,
+    std::type_identity_t<T> aileron_deg   = T(0),
+    std::type_identity_t<T> flap_deg      = T(0),
+    std::type_identity_t<T> slat_deg      = T(0),
+    std::type_identity_t<T> air_density   = T(1.225)
 ) {
 	wing_mount_rot = glm::normalize(wing_mount_rot);
 
@@ -208,33 +272,24 @@ inline wing_forces_3d calc_wing_forces_3d(
 	    wing_mount_rot,
 	    is_right_wing
 	);
-	wing_forces forces = wing.calc_forces(
+	basic_wing_forces<T> forces = wing.calc_forces(
 	    speed_aoa, aileron_deg, flap_deg, slat_deg, air_density
 	);
 
-	// weighted mean move dir
-	glm::vec3 mean_move_dir(0.0f);
-	float     total_area = 0.0f;
-	for (size_t i = 0; i < move_dirs.size(); ++i) {
-		float area     = wing.sections[i].span * wing.sections[i].chord;
-		mean_move_dir += move_dirs[i] * area;
-		total_area    += area;
-	}
-	mean_move_dir /= total_area;
-
 	return map_wing_forces_to_3d(
 	    forces,
 	    wing_mount_pos,
 	    wing_mount_rot,
 	    move_dirs,
-	    mean_move_dir,
+	    wing_mean_move_dir<T>(wing, move_dirs),
 	    is_right_wing
 	);
 }
 
-inline std::vector<wing_force_vec_3d>
-gather_wing_forces_3d(const wing_forces_3d &forces) {
-	std::vector<wing_force_vec_3d> result;
+template <typename T>
+inline std::vector<basic_wing_force_vec_3d<T>>
+gather_wing_forces_3d(const basic_wing_forces_3d<T> &forces) {
+	std::vector<basic_wing_force_vec_3d<T>> result;
 	result.reserve(
 	    forces.sectional_lift.size() + forces.sectional_drag.size() + 1
 	);
@@ -249,3 +304,108 @@ gather_wing_forces_3d(const wing_forces_3d &forces) {
 
 	return result;
 }
+
+// buffers reused by the allocation-free calc_wing_forces_3d(); they only
+// grow (allocate) when a wing with more sections than before comes along
+template <typename T> struct basic_wing_scratch {
+	std::vector<basic_wing_speed_aoa<T>> speed_aoa;
+	std::vector<glm::vec<3, T>>          move_dirs;
+	std::vector<basic_wing_force_vec<T>> sectional_lift;
+	std::vector<basic_wing_force_vec<T>> sectional_drag;
+
+	void fit(size_t num_sections) {
+		if (speed_aoa.size() < num_sections) {
+			speed_aoa.resize(num_sections);
+			move_dirs.resize(num_sections);
+			sectional_lift.resize(num_sections);
+			sectional_drag.resize(num_sections);
+		}
+	}
+};
+
+using wing_scratch = basic_wing_scratch<float>;
+
+// number of forces the allocation-free calc_wing_forces_3d() writes
+template <typename T>
+inline size_t wing_num_forces_3d(const basic_wing<T> &wing) {
+	return 2 * wing.get_sections().size() + 1;
+}
+
+// Allocation-free variant of calc_wing_forces_3d() + gather_wing_forces_3d().
+// Writes wing_num_forces_3d(wing) forces to out in the same order: sectional
+// lift, sectional drag, induced drag.
+template <typename T>
+inline void calc_wing_forces_3d(
+    const basic_wing<T>                   &wing,
+    glm::vec<3, T>                         linear_velocity,
+    glm::vec<3, T>                         angular_velocity,
+    glm::vec<3, T>                         origin_of_rotation,
+    glm::vec<3, T>                         wing_mount_pos,
+    glm::qua<T>                            wing_mount_rot,
+    bool                                   is_right_wing,
+    std::type_identity_t<T>                aileron_deg,
+    std::type_identity_t<T>                flap_deg,
+    std::type_identity_t<T>                slat_deg,
+    std::type_identity_t<T>                air_density,
+    basic_wing_scratch<T>                 &scratch,
+    std::span<basic_wing_force_vec_3d<T>> out
+) {
+	size_t n = wing.get_sections().size();
+	if (out.size() < 2 * n + 1) {
+		throw std::invalid_argument("wing force output span is too small");
+	}
+	wing_mount_rot = glm::normalize(wing_mount_rot);
+	scratch.fit(n);
+
+	std::span<basic_wing_speed_aoa<T>> speed_aoa(scratch.speed_aoa.data(), n);
+	std::span<glm::vec<3, T>>          move_dirs(scratch.move_dirs.data(), n);
+	wing_sectional_speed_aoa<T>(
+	    wing,
+	    linear_velocity,
+	    angular_velocity,
+	    origin_of_rotation,
+	    wing_mount_pos,
+	    wing_mount_rot,
+	    is_right_wing,
+	    speed_aoa,
+	    move_dirs
+	);
+	basic_wing_force_vec<T> induced_drag;
+	wing.calc_forces(
+	    speed_aoa,
+	    scratch.sectional_lift,
+	    scratch.sectional_drag,
+	    induced_drag,
+	    aileron_deg,
+	    flap_deg,
+	    slat_deg,
+	    air_density
+	);
+
+	for (size_t i = 0; i < n; i++) {
+		out[i] = map_wing_force_to_3d(
+		    scratch.sectional_lift[i],
+		    wing_mount_pos,
+		    wing_mount_rot,
+		    false,
+		    move_dirs[i],
+		    is_right_wing
+		);
+		out[n + i] = map_wing_force_to_3d(
+		    scratch.sectional_drag[i],
+		    wing_mount_pos,
+		    wing_mount_rot,
+		    true,
+		    move_dirs[i],
+		    is_right_wing
+		);
+	}
+	out[2 * n] = map_wing_force_to_3d(
+	    induced_drag,
+	    wing_mount_pos,
+	    wing_mount_rot,
+	    true,
+	    wing_mean_move_dir<T>(wing, move_dirs),
+	    is_right_wing
+	);
+}
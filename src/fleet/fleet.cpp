@@ -0,0 +1,204 @@
+#include "fleet.hpp"
+
+void fleet_inputs::resize(size_t count) {
+	throttle.resize(count);
+	afterburner.resize(count);
+	pitch_down.resize(count);
+	roll_right.resize(count);
+	rudder_left.resize(count);
+	flaps_down.resize(count);
+}
+
+void fleet_inputs::set(size_t i, const control_input &input) {
+	throttle[i]    = input.throttle;
+	afterburner[i] = input.afterburner;
+	pitch_down[i]  = input.pitch_down;
+	roll_right[i]  = input.roll_right;
+	rudder_left[i] = input.rudder_left;
+	flaps_down[i]  = input.flaps_down;
+}
+
+void fleet_state::resize(size_t count) {
+	for (std::vector<float> *v :
+	     {&pos_x,
+	      &pos_y,
+	      &pos_z,
+	      &rot_w,
+	      &rot_x,
+	      &rot_y,
+	      &rot_z,
+	      &vel_x,
+	      &vel_y,
+	      &vel_z,
+	      &ang_vel_x,
+	      &ang_vel_y,
+	      &ang_vel_z,
+	      &throttle,
+	      &fuel}) {
+		v->resize(count);
+	}
+}
+
+void fleet::init(const std::filesystem::path &aircraft_path, size_t count) {
+	// built the way a single jet builds it, so the physics is the same
+	jet_model prototype;
+	prototype.init(aircraft_path);
+	def       = prototype.get_def();
+	aero      = prototype.get_aero();
+	full_mass = prototype.get_mass();
+
+	state.resize(count);
+	mass.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		reset(i, prototype.get_body());
+	}
+	scratches.clear();
+}
+
+size_t fleet::size() const {
+	return mass.size();
+}
+
+void fleet::set_integrator(integrator::method method) {
+	if (method == integrator::method::rk45) {
+		throw std::invalid_argument("Fleets don't support RK45.");
+	}
+	this->method = method;
+}
+
+integrator::method fleet::get_integrator() const {
+	return method;
+}
+
+void fleet::step(
+    const fleet_inputs &inputs,
+    float               dt,
+    work_stealing_pool &pool,
+    int                 substeps
+) {
+	if (inputs.throttle.size() != size()) {
+		throw std::invalid_argument("Need inputs for every aircraft.");
+	}
+
+	// scratch for threads the pool has more of than last time
+	while (scratches.size() < pool.get_num_threads()) {
+		scratch &s = scratches.emplace_back();
+		s.aero     = aero;
+		s.controls.resize(aero.num_surfaces());
+	}
+	for (scratch &s : scratches) {
+		s.stepper.set_method(method);
+	}
+
+	// enough aircraft per chunk to be worth taking, enough chunks to steal
+	const size_t grain = 64;
+	pool.parallel_for(
+	    size(),
+	    grain,
+	    [&](size_t begin, size_t end, size_t thread) {
+		    step_range(inputs, dt, substeps, begin, end, scratches[thread]);
+	    }
+	);
+
+	evaluations = 0;
+	for (const scratch &s : scratches) {
+		evaluations += s.stepper.get_evaluations();
+	}
+}
+
+void fleet::step_range(
+    const fleet_inputs &inputs,
+    float               dt,
+    int                 substeps,
+    size_t              begin,
+    size_t              end,
+    scratch            &s
+) {
+	for (size_t i = begin; i < end; ++i) {
+		float throttle = std::clamp(inputs.throttle[i], 0.0f, 1.0f);
+
+		// per surface controls, mixed as the aircraft definition says
+		const std::array<float, aircraft_def::num_inputs> mix_inputs = {
+		    inputs.pitch_down[i],
+		    inputs.roll_right[i],
+		    inputs.rudder_left[i],
+		    inputs.flaps_down[i] ? 1.0f : 0.0f,
+		};
+		def.mix_controls(mix_inputs, s.controls);
+
+		// inputs are held, so the mix holds for all substeps
+		rigid_body body = get_body(i);
+		for (int k = 0; k < substeps; ++k) {
+			step_jet_body(
+			    def.engine,
+			    s.aero,
+			    s.controls,
+			    throttle,
+			    inputs.afterburner[i] != 0,
+			    s.stepper,
+			    body,
+			    mass[i],
+			    dt
+			);
+		}
+		store_body(i, body);
+		state.throttle[i] = throttle;
+		state.fuel[i]     = mass[i].get_fuel();
+	}
+}
+
+const fleet_state &fleet::get_state() const {
+	return state;
+}
+
+rigid_body fleet::get_body(size_t i) const {
+	rigid_body body;
+	body.pos     = glm::vec3(state.pos_x[i], state.pos_y[i], state.pos_z[i]);
+	body.rot     = glm::quat(
+        state.rot_w[i], state.rot_x[i], state.rot_y[i], state.rot_z[i]
+    );
+	body.vel     = glm::vec3(state.vel_x[i], state.vel_y[i], state.vel_z[i]);
+	body.ang_vel = glm::vec3(
+	    state.ang_vel_x[i], state.ang_vel_y[i], state.ang_vel_z[i]
+	);
+	// rot was stored normalized, normalizing again could move it by an ulp
+	body.rot_mat = glm::mat3_cast(body.rot);
+	return body;
+}
+
+void fleet::set_body(size_t i, const rigid_body &body) {
+	rigid_body normalized = body;
+	normalized.sync_rotation();
+	store_body(i, normalized);
+}
+
+void fleet::reset(size_t i, const rigid_body &body) {
+	set_body(i, body);
+	mass[i]           = full_mass;
+	state.throttle[i] = 0.0f;
+	state.fuel[i]     = mass[i].get_fuel();
+}
+
+void fleet::store_body(size_t i, const rigid_body &body) {
+	state.pos_x[i]     = body.pos.x;
+	state.pos_y[i]     = body.pos.y;
+	state.pos_z[i]     = body.pos.z;
+	state.rot_w[i]     = body.rot.w;
+	state.rot_x[i]     = body.rot.x;
+	state.rot_y[i]     = body.rot.y;
+	state.rot_z[i]     = body.rot.z;
+	state.vel_x[i]     = body.vel.x;
+	state.vel_y[i]     = body.vel.y;
+	state.vel_z[i]     = body.vel.z;
+	state.ang_vel_x[i] = body.ang_vel.x;
+	state.ang_vel_y[i] = body.ang_vel.y;
+	state.ang_vel_z[i] = body.ang_vel.z;
+}
+
+const aircraft_def &fleet::get_def() const {
+	return def;
+}
+
+uint64_t fleet::get_evaluations() const {
+	return evaluations;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "../dynamics/pch.hpp"
+
+#include "../dynamics/jet_model.hpp"
+#include "work_stealing_pool.hpp"
+
+// Per aircraft control inputs, one array per field, indexed like the fleet.
+// Held for a whole step() like jet_model::update_physics_from_input() holds
+// its input.
+struct fleet_inputs {
+	std::vector<float>   throttle;    // (0, 1)
+	std::vector<uint8_t> afterburner; // 0 or 1
+	std::vector<float>   pitch_down;  // (-1, 1)
+	std::vector<float>   roll_right;  // (-1, 1)
+	std::vector<float>   rudder_left; // (-1, 1)
+	std::vector<uint8_t> flaps_down;  // 0 or 1
+
+	void resize(size_t count);
+	void set(size_t i, const control_input &input);
+};
+
+// World frame state of every aircraft, one array per component, so a chunk
+// of aircraft streams through contiguous memory and a reader after one
+// component doesn't pull in the rest.
+struct fleet_state {
+	std::vector<float> pos_x, pos_y, pos_z;             // m
+	std::vector<float> rot_w, rot_x, rot_y, rot_z;      // unit quaternion
+	std::vector<float> vel_x, vel_y, vel_z;             // m/s
+	std::vector<float> ang_vel_x, ang_vel_y, ang_vel_z; // rad/s
+	std::vector<float> throttle;                        // last step's
+	std::vector<float> fuel;                            // kg
+
+	void resize(size_t count);
+};
+
+// Many aircraft of one type, stepped together over a work_stealing_pool with
+// the same force model as jet_model (step_jet_body()). Aircraft i given the
+// same inputs ends up bit for bit where a jet_model would.
+//
+// Besides the arrays, each aircraft keeps its mass_properties, the fuel with
+// its rounding compensation and the inertia built from it. Each thread has
+// its own aero_model and integrator, as evaluating one writes to it.
+class fleet {
+public:
+	void init(const std::filesystem::path &aircraft_path, size_t count);
+
+	size_t size() const;
+
+	// Semi-implicit Euler or RK4, RK45 keeps a step size per body and isn't
+	// supported. Throws std::invalid_argument for it.
+	void               set_integrator(integrator::method method);
+	integrator::method get_integrator() const;
+
+	// Substeps steps of every aircraft, controls mixed from inputs then
+	// physics. Each chunk of aircraft runs all its substeps at once, while
+	// its state is in cache, with no wait for the other threads in between.
+	void step(
+	    const fleet_inputs &inputs,
+	    float               dt,
+	    work_stealing_pool &pool,
+	    int                 substeps = 1
+	);
+
+	const fleet_state &get_state() const;
+
+	// one aircraft as a rigid_body, e.g. to start it somewhere or check it
+	rigid_body get_body(size_t i) const;
+	void       set_body(size_t i, const rigid_body &body);
+	// set_body() with full tanks again
+	void       reset(size_t i, const rigid_body &body);
+
+	const aircraft_def &get_def() const;
+
+	// loads evaluations over all steps, the work the steps stood for
+	uint64_t get_evaluations() const;
+
+private:
+	// one per pool thread
+	struct alignas(64) scratch {
+		aero_model                                aero;
+		std::vector<aero_model::surface_controls> controls;
+		integrator                                stepper;
+	};
+
+	aircraft_def       def;
+	aero_model         aero; // copied to each thread's scratch
+	mass_properties    full_mass;
+	integrator::method method = integrator::method::semi_implicit_euler;
+	uint64_t           evaluations = 0;
+
+	fleet_state                  state;
+	std::vector<mass_properties> mass;
+	std::vector<scratch>         scratches;
+
+	void store_body(size_t i, const rigid_body &body);
+	void step_range(
+	    const fleet_inputs &inputs,
+	    float               dt,
+	    int                 substeps,
+	    size_t              begin,
+	    size_t              end,
+	    scratch            &s
+	);
+};
@@ -0,0 +1,162 @@
+#include "work_stealing_pool.hpp"
+
+static uint64_t pack(uint32_t begin, uint32_t end) {
+	return static_cast<uint64_t>(begin) << 32 | end;
+}
+
+static uint32_t begin_of(uint64_t chunks) {
+	return static_cast<uint32_t>(chunks >> 32);
+}
+
+static uint32_t end_of(uint64_t chunks) {
+	return static_cast<uint32_t>(chunks);
+}
+
+work_stealing_pool::work_stealing_pool(size_t num_threads)
+    : runs(num_threads
+               ? num_threads
+               : std::max<size_t>(std::thread::hardware_concurrency(), 1)) {
+	// thread 0 is whoever calls parallel_for()
+	for (size_t i = 1; i < runs.size(); ++i) {
+		threads.emplace_back([this, i] { worker(i); });
+	}
+}
+
+work_stealing_pool::~work_stealing_pool() {
+	stopping.store(true);
+	generation.fetch_add(1);
+	generation.notify_all();
+	threads.clear(); // joined here, while the atomics are still around
+}
+
+size_t work_stealing_pool::get_num_threads() const {
+	return runs.size();
+}
+
+uint64_t work_stealing_pool::get_steals() const {
+	return steals.load(std::memory_order_relaxed);
+}
+
+void work_stealing_pool::parallel_for(size_t count, size_t grain, range_fn fn) {
+	grain             = std::max<size_t>(grain, 1);
+	size_t num_chunks = (count + grain - 1) / grain;
+	if (num_chunks > UINT32_MAX) {
+		throw std::invalid_argument("Too many chunks for parallel_for().");
+	}
+	if (num_chunks == 0) {
+		return;
+	}
+
+	this->job   = &fn;
+	this->count = count;
+	this->grain = grain;
+	this->error = nullptr;
+
+	// contiguous runs, so each thread starts on its own stretch of memory
+	size_t n = runs.size();
+	for (size_t i = 0; i < n; ++i) {
+		runs[i].chunks.store(
+		    pack(
+		        static_cast<uint32_t>(num_chunks * i / n),
+		        static_cast<uint32_t>(num_chunks * (i + 1) / n)
+		    ),
+		    std::memory_order_relaxed
+		);
+	}
+
+	// the release here publishes the job to the threads
+	busy.store(n - 1);
+	generation.fetch_add(1);
+	generation.notify_all();
+
+	work(0);
+	for (size_t b = busy.load(); b != 0; b = busy.load()) {
+		busy.wait(b);
+	}
+
+	this->job = nullptr;
+	if (this->error) {
+		std::rethrow_exception(this->error);
+	}
+}
+
+void work_stealing_pool::worker(size_t thread) {
+	uint64_t seen = 0;
+	while (true) {
+		generation.wait(seen);
+		seen = generation.load();
+		if (stopping.load()) {
+			return;
+		}
+		work(thread);
+		if (busy.fetch_sub(1) == 1) {
+			busy.notify_all();
+		}
+	}
+}
+
+void work_stealing_pool::work(size_t thread) {
+	uint32_t chunk;
+	while (take(thread, chunk) || steal(thread, chunk)) {
+		run_chunk(thread, chunk);
+	}
+}
+
+// front of the own run
+bool work_stealing_pool::take(size_t thread, uint32_t &chunk) {
+	std::atomic<uint64_t> &own    = runs[thread].chunks;
+	uint64_t               chunks = own.load(std::memory_order_acquire);
+	while (begin_of(chunks) < end_of(chunks)) {
+		if (own.compare_exchange_weak(
+		        chunks,
+		        pack(begin_of(chunks) + 1, end_of(chunks)),
+		        std::memory_order_acq_rel
+		    )) {
+			chunk = begin_of(chunks);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Back half of the first non-empty run after this thread's. The first chunk
+// of it is returned, the rest becomes this thread's run, which is empty at
+// that point. Runs only ever split, never merge, so a run a thief has read
+// can't come back once it's been taken from, and a compare-exchange against
+// a stale one fails.
+bool work_stealing_pool::steal(size_t thread, uint32_t &chunk) {
+	size_t n = runs.size();
+	for (size_t k = 1; k < n; ++k) {
+		std::atomic<uint64_t> &victim = runs[(thread + k) % n].chunks;
+		uint64_t               chunks = victim.load(std::memory_order_acquire);
+		while (begin_of(chunks) < end_of(chunks)) {
+			uint32_t begin = begin_of(chunks);
+			uint32_t end   = end_of(chunks);
+			uint32_t mid   = begin + (end - begin) / 2;
+			if (victim.compare_exchange_weak(
+			        chunks, pack(begin, mid), std::memory_order_acq_rel
+			    )) {
+				runs[thread].chunks.store(
+				    pack(mid + 1, end), std::memory_order_release
+				);
+				steals.fetch_add(1, std::memory_order_relaxed);
+				chunk = mid;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void work_stealing_pool::run_chunk(size_t thread, uint32_t chunk) {
+	size_t begin = chunk * grain;
+	size_t end   = std::min(begin + grain, count);
+	try {
+		(*job)(begin, end, thread);
+	} catch (...) {
+		std::lock_guard lock(error_mutex);
+		if (!error) {
+			error = std::current_exception();
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../dynamics/pch.hpp"
+
+// Fixed set of threads for data-parallel loops. parallel_for() cuts the range
+// into chunks and deals each thread a contiguous run of them. A thread works
+// through its own run front to back, and once it's out, it steals the back
+// half of whichever run it finds first. Uneven chunks (an aircraft in a
+// stall costs more than one in cruise) even out without a shared queue.
+//
+// Runs are a packed [begin, end) of chunk indices in one atomic per thread,
+// so taking and stealing are a single compare-exchange each. The calling
+// thread works as thread 0, and nothing allocates per chunk.
+class work_stealing_pool {
+public:
+	// A (begin, end, thread) callable, thread in [0, get_num_threads()),
+	// by reference: no copy, so a lambda capturing any number of locals
+	// doesn't allocate the way std::function would. Good for one call.
+	class range_fn {
+	public:
+		template <typename F>
+		    requires(!std::is_same_v<std::remove_cvref_t<F>, range_fn>)
+		range_fn(F &&fn)
+		    : object(const_cast<void *>(static_cast<const void *>(&fn))),
+		      call([](void *object, size_t begin, size_t end, size_t thread) {
+			      (*static_cast<std::remove_reference_t<F> *>(object))(
+			          begin, end, thread
+			      );
+		      }) {}
+
+		void operator()(size_t begin, size_t end, size_t thread) const {
+			call(object, begin, end, thread);
+		}
+
+	private:
+		void *object;
+		void (*call)(void *object, size_t begin, size_t end, size_t thread);
+	};
+
+	// 0 for one per hardware thread, the caller included
+	explicit work_stealing_pool(size_t num_threads = 0);
+	~work_stealing_pool();
+
+	work_stealing_pool(const work_stealing_pool &)            = delete;
+	work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+	size_t get_num_threads() const;
+
+	// Calls fn over [0, count) in chunks of grain items and returns once all
+	// of them are done. An exception from fn is rethrown here, the rest of
+	// the chunks run regardless. Not reentrant.
+	void parallel_for(size_t count, size_t grain, range_fn fn);
+
+	// chunks taken from another thread's run, since construction
+	uint64_t get_steals() const;
+
+private:
+	// one cache line each, so threads taking from their own runs don't
+	// contend
+	struct alignas(64) run {
+		std::atomic<uint64_t> chunks{0}; // begin << 32 | end
+	};
+
+	std::vector<run>          runs;
+	std::vector<std::jthread> threads;
+
+	// the current parallel_for()
+	const range_fn    *job   = nullptr;
+	size_t             count = 0;
+	size_t             grain = 1;
+	std::exception_ptr error;
+	std::mutex         error_mutex;
+
+	std::atomic<uint64_t> generation{0}; // bumped to wake the threads
+	std::atomic<size_t>   busy{0};       // threads not done with the job
+	std::atomic<bool>     stopping{false};
+	std::atomic<uint64_t> steals{0};
+
+	void worker(size_t thread);
+	void work(size_t thread);
+	bool take(size_t thread, uint32_t &chunk);
+	bool steal(size_t thread, uint32_t &chunk);
+	void run_chunk(size_t thread, uint32_t chunk);
+};
@@ -8,7 +8,7 @@ uniform_buffer::~uniform_buffer() {
 	glDeleteBuffers(1, &gl_id);
 }
 
-void uniform_buffer::update(const std::vector<uint8_t> &data) {
+void uniform_buffer::update(std::span<const uint8_t> data) {
 	glBindBuffer(GL_UNIFORM_BUFFER, gl_id);
 	if (data.size() != size) {
 		size = data.size();
@@ -7,7 +7,7 @@ public:
 	uniform_buffer();
 	~uniform_buffer();
 
-	void update(const std::vector<uint8_t> &data);
+	void update(std::span<const uint8_t> data);
 	void bind(uint32_t binding);
 
 	template <typename... Fields> void update(Fields... fields) {
@@ -21,15 +21,14 @@ public:
 		    "Fields must be float or glm types."
 		);
 
-		std::vector<uint8_t> data;
-		(data.insert(
-		     data.end(),
-		     reinterpret_cast<const uint8_t *>(&fields),
-		     reinterpret_cast<const uint8_t *>(&fields) + sizeof(fields)
-		 ),
+		// packed on the stack, updating every frame must not allocate
+		std::array<uint8_t, (sizeof(Fields) + ...)> data;
+		size_t                                      offset = 0;
+		((std::memcpy(data.data() + offset, &fields, sizeof(fields)),
+		  offset += sizeof(fields)),
 		 ...);
 
-		update(data);
+		update(std::span<const uint8_t>(data));
 	}
 
 private:
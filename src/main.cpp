@@ -10,8 +10,56 @@
 #include "gfx/shader.hpp"
 #include "gfx/uniform_buffer.hpp"
 #include "gfx/window.hpp"
+#include "sim/rate_scheduler.hpp"
+#include "sim/sim_thread.hpp"
+
+static void print_usage() {
+	std::cerr << "usage: flight-sim [--realtime [--cpu=<n>] [--priority=<n>] | "
+	             "--record=<file>]\n"
+	          << "           [--replay=<file> | --timeline=<file>]"
+	          << std::endl;
+}
+
+int main(int argc, char **argv) {
+	// --realtime runs the physics as a hard real-time loop, see sim_thread,
+	// --record writes the inputs flown to a file (not in realtime runs),
+	// --replay and --timeline fly from one instead, see input_source.hpp
+	bool                     realtime = false;
+	realtime_options         rt_options;
+	std::filesystem::path    record_path, replay_path, timeline_path;
+	std::vector<std::string> args(argv + 1, argv + argc);
+	try {
+		for (const std::string &arg : args) {
+			if (arg == "--realtime") {
+				realtime = true;
+			} else if (arg.starts_with("--cpu=")) {
+				rt_options.cpu = std::stoi(arg.substr(6));
+			} else if (arg.starts_with("--priority=")) {
+				rt_options.priority = std::stoi(arg.substr(11));
+			} else if (arg.starts_with("--record=")) {
+				record_path = arg.substr(9);
+			} else if (arg.starts_with("--replay=")) {
+				replay_path = arg.substr(9);
+			} else if (arg.starts_with("--timeline=")) {
+				timeline_path = arg.substr(11);
+			} else {
+				print_usage();
+				return 2;
+			}
+		}
+	} catch (const std::exception &) {
+		print_usage();
+		return 2;
+	}
+	// the recorder writes its file from the control task, inside the
+	// realtime cycle, where the I/O adds jitter and an allocation fails
+	// the run
+	if (realtime && !record_path.empty()) {
+		std::cerr << "--record doesn't go with --realtime." << std::endl;
+		print_usage();
+		return 2;
+	}
 
-int main() {
 	window window;
 	window.open(800, 600, "Flight Sim");
 
@@ -22,12 +70,14 @@ int main() {
 	// fps_camera cam;
 	cam.set_pose(glm::vec3(-40.0f, 0.0f, 10.0f), glm::vec3(0.0f, 0.0f, 0.0f));
 
+	jet_model model;
+	model.init("aircraft/su34.acb");
+
 	jet jet;
 	jet.init(
 	    "../meshes/su34.obj",
 	    "../shaders/lambert.vert",
 	    "../shaders/lambert.frag",
-	    "../curves/su34_lift_aoa.txt",
 	    "../shaders/wing_force_debug.vert",
 	    "../shaders/wing_force_debug.frag"
 	);
@@ -43,8 +93,79 @@ int main() {
 	cam.bind();
 
 	// init on_update
-	std::chrono::time_point last_update_time = std::chrono::steady_clock::now();
-	float                   elapsed_ms       = 0.0f;
+	std::chrono::time_point start_time = std::chrono::steady_clock::now();
+	float                   elapsed_ms = 0.0f;
+
+	// input sources other than the keyboard, outliving the sim thread
+	recorded_input                replay;
+	timeline_input                timeline;
+	std::optional<input_recorder> recorder;
+
+	// physics runs on its own thread at a fixed rate, independent of the
+	// frame rate
+	sim_thread           sim(model, 1.0 / 1000.0);
+	sim_thread::controls controls;
+	control_input        shown_input; // of the last frame, for the printouts
+	bool                 warp_key_just_pressed       = false;
+	bool                 integrator_key_just_pressed = false;
+	try {
+		input_source *source = &sim.get_keyboard();
+		if (!replay_path.empty()) {
+			replay.load(replay_path);
+			source = &replay;
+		} else if (!timeline_path.empty()) {
+			timeline.load(timeline_path);
+			source = &timeline;
+		}
+		// records whatever flies, keyboard or file
+		if (!record_path.empty()) {
+			recorder.emplace(*source, record_path);
+			source = &*recorder;
+		}
+		sim.set_input_source(source);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	if (realtime) {
+		if (!lock_process_memory()) {
+			std::cerr << "Could not lock memory, page faults may add latency."
+			          << std::endl;
+		}
+		sim.start_realtime(rt_options);
+	} else {
+		sim.start();
+	}
+
+	// render thread tasks, on wall clock time
+	rate_scheduler render_tasks;
+	render_tasks.add_task(
+	    "camera",
+	    60.0,
+	    [&](double dt) {
+		    // cam.update_fps_pose_from_input(window, dt);
+		    cam.update_pose_from_follow_target(
+		        window, static_cast<float>(dt), jet.get_center_of_mass()
+		    );
+		    // glm::vec3 com = jet.get_center_of_mass();
+		    // glm::vec3 rpy = jet.get_rpy();
+		    // glm::quat rot = jet.get_quat();
+		    // glm::quat deg45_rot = glm::angleAxis(glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		    // cam.set_pose(
+		    //     com + rot * glm::vec3(-30.0f, 0.0f, 10.0f),
+		    //     glm::vec3(rpy.x, rpy.y, rpy.z)
+		    // );
+		    grid.update_tiling_from_view_pos(cam.get_pos_flu());
+	    },
+	    rate_scheduler::catch_up_policy::skip
+	);
+	// from the published frames, the sim thread prints nothing
+	render_tasks.add_task(
+	    "telemetry",
+	    10.0,
+	    [&](double) { log_telemetry(sim.get_latest_frame().jet); },
+	    rate_scheduler::catch_up_policy::skip
+	);
 
 	// clang-format off
 	window.run_loop({
@@ -57,23 +178,55 @@ int main() {
 		},
 		.on_update = [&]() {
 			std::chrono::time_point now = std::chrono::steady_clock::now();
-			float dt = std::chrono::duration<float>(
-				now - last_update_time
-			).count();
-			last_update_time = now;
-
-			// cam.update_fps_pose_from_input(window, dt);
-			cam.update_pose_from_follow_target(window, dt, jet.get_center_of_mass());
-			// glm::vec3 com = jet.get_center_of_mass();
-			// glm::vec3 rpy = jet.get_rpy();
-			// glm::quat rot = jet.get_quat();
-			// glm::quat deg45_rot = glm::angleAxis(glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-			// cam.set_pose(
-			//     com + rot * glm::vec3(-30.0f, 0.0f, 10.0f),
-			//     glm::vec3(rpy.x, rpy.y, rpy.z)
-			// );
-			grid.update_tiling_from_view_pos(cam.get_pos_flu());
-			jet.update_physics_from_input(window, dt);
+
+			// nothing left to show once physics stopped, stop() says why
+			if (sim.has_failed()) {
+				glfwSetWindowShouldClose(window.glfw_window, GLFW_TRUE);
+			}
+
+			// time warp, doubled with '.' and halved with ','
+			bool warp_up   = window.is_glfw_key_down(GLFW_KEY_PERIOD);
+			bool warp_down = window.is_glfw_key_down(GLFW_KEY_COMMA);
+			if ((warp_up || warp_down) && !warp_key_just_pressed) {
+				warp_key_just_pressed = true;
+				controls.time_warp    = std::clamp(
+					warp_up ? controls.time_warp * 2 : controls.time_warp / 2,
+					fixed_step_clock::min_time_warp,
+					fixed_step_clock::max_time_warp
+				);
+				std::cout << "Time warp " << controls.time_warp << "x"
+				          << std::endl;
+			} else if (!warp_up && !warp_down) {
+				warp_key_just_pressed = false;
+			}
+
+			// cycle through the integrators with 'N'
+			if (window.is_glfw_key_down(GLFW_KEY_N)) {
+				if (!integrator_key_just_pressed) {
+					integrator_key_just_pressed = true;
+					controls.method = static_cast<integrator::method>(
+						(static_cast<int>(controls.method) + 1) %
+						integrator::num_methods
+					);
+					std::cout << "Integrator "
+					          << integrator::get_method_name(controls.method)
+					          << std::endl;
+				}
+			} else {
+				integrator_key_just_pressed = false;
+			}
+
+			// hand the input over and show the newest state, neither waits
+			controls.keys = key_state::capture(window);
+			sim.send(controls);
+			const sim_thread::frame &frame = sim.get_latest_frame();
+			jet.apply_snapshot(frame.jet, sim_thread::get_alpha(frame, now));
+			log_input_changes(shown_input, frame.jet.input);
+			shown_input = frame.jet.input;
+
+			render_tasks.run_until(
+				std::chrono::duration<double>(now - start_time).count()
+			);
 		},
 	    .on_resize = [&](uint32_t w, uint32_t h) {
 			glViewport(0, 0, w, h);
@@ -82,5 +235,11 @@ int main() {
 	});
 	// clang-format on
 
-	return 0;
+	sim.stop();
+	render_tasks.print_stats(std::cout);
+	if (sim.get_realtime_allocations() > 0) {
+		std::cerr << "Physics allocated in realtime cycles." << std::endl;
+		return 1;
+	}
+	return sim.has_failed() ? 1 : 0;
 }
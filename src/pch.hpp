@@ -1,13 +1,6 @@
 #pragma once
 
-#include <algorithm>
-#include <chrono>
-#include <filesystem>
-#include <fstream>
-#include <functional>
-#include <iostream>
-#include <sstream>
-#include <stdexcept>
+#include "dynamics/pch.hpp"
 
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
@@ -15,8 +8,4 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <glad/gl.h>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/string_cast.hpp>
 #include <stb/stb_image.h>
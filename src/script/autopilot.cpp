@@ -0,0 +1,89 @@
+#include "autopilot.hpp"
+
+agent_state agent_state::read(const fleet_state &state, size_t i) {
+	glm::quat rot(
+	    state.rot_w[i], state.rot_x[i], state.rot_y[i], state.rot_z[i]
+	);
+	glm::vec3 ang_vel(
+	    state.ang_vel_x[i], state.ang_vel_y[i], state.ang_vel_z[i]
+	);
+	glm::vec3 left = rot * glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::vec3 up   = rot * glm::vec3(0.0f, 0.0f, 1.0f);
+
+	agent_state s;
+	s.pos     = glm::vec3(state.pos_x[i], state.pos_y[i], state.pos_z[i]);
+	s.vel     = glm::vec3(state.vel_x[i], state.vel_y[i], state.vel_z[i]);
+	s.ang_vel = glm::conjugate(rot) * ang_vel;
+	s.speed   = glm::length(s.vel);
+	s.heading = std::atan2(s.vel.y, s.vel.x);
+	s.climb   = s.speed > 0.0f ? std::asin(s.vel.z / s.speed) : 0.0f;
+	s.bank    = std::atan2(left.z, up.z);
+	return s;
+}
+
+float wrap_angle(float a) {
+	const float pi = glm::pi<float>();
+	a              = std::fmod(a + pi, 2.0f * pi);
+	return a < 0.0f ? a + pi : a - pi;
+}
+
+control_input autopilot::fly(
+    const agent_state &s, const agent_state *leader_state, float dt
+) {
+	// The slot becomes this tick's targets. Heading for a point a few
+	// seconds ahead of it cuts inside the leader's turns rather than
+	// trailing them, speed closes in along its track.
+	if (leader != no_leader) {
+		const agent_state &l = *leader_state;
+		glm::vec3 forward(std::cos(l.heading), std::sin(l.heading), 0.0f);
+		glm::vec3 left(-forward.y, forward.x, 0.0f);
+		glm::vec3 slot = l.pos + forward * offset.x + left * offset.y;
+		slot.z += offset.z;
+
+		glm::vec3 d     = slot - s.pos;
+		glm::vec3 aim   = d + l.vel * 3.0f;
+		float     along = glm::dot(d, forward);
+		altitude        = slot.z;
+		climb_rate_bias = l.vel.z;
+		heading         = std::atan2(aim.y, aim.x);
+		speed           = l.speed + std::clamp(along * 0.03f, -30.0f, 30.0f);
+		formation_error = glm::length(d);
+	}
+
+	control_input input;
+
+	// altitude: climb rate from the error, climb angle from that
+	float climb_target = 0.0f;
+	if (!std::isnan(altitude) && s.speed > 1.0f) {
+		float climb_rate = std::clamp(
+		    climb_rate_bias + (altitude - s.pos.z) * 0.1f, -80.0f, 80.0f
+		);
+		climb_target =
+		    std::asin(std::clamp(climb_rate / s.speed, -0.5f, 0.5f));
+	}
+	float climb_error = climb_target - s.climb;
+	pitch_trim = std::clamp(pitch_trim + climb_error * 0.5f * dt, -1.0f, 1.0f);
+	input.pitch_down =
+	    -std::clamp(climb_error * 4.0f + pitch_trim + s.ang_vel.y, -1.0f, 1.0f);
+
+	// heading: bank toward it, up to 60 degrees
+	float bank_target = 0.0f;
+	if (!std::isnan(heading)) {
+		float heading_error = wrap_angle(heading - s.heading);
+		bank_target         = std::clamp(-heading_error * 2.0f, -1.05f, 1.05f);
+	}
+	input.roll_right = std::clamp(
+	    (bank_target - s.bank) * 2.0f - s.ang_vel.x * 0.5f, -1.0f, 1.0f
+	);
+
+	// airspeed: throttle integrates the error, with a kick on top
+	float command = throttle;
+	if (!std::isnan(speed)) {
+		float speed_error = speed - s.speed;
+		throttle = std::clamp(throttle + speed_error * 0.01f * dt, 0.0f, 1.0f);
+		command  = std::clamp(throttle + speed_error * 0.05f, 0.0f, 1.0f);
+		input.afterburner = command >= 1.0f && speed_error > 20.0f;
+	}
+	input.throttle = command;
+	return input;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../dynamics/pch.hpp"
+
+#include "../dynamics/control_input.hpp"
+#include "../fleet/fleet.hpp"
+
+// One aircraft of a fleet as the autopilot and the wake conditions see it.
+struct agent_state {
+	glm::vec3 pos     = glm::vec3(0.0f); // m, z up
+	glm::vec3 vel     = glm::vec3(0.0f); // m/s
+	glm::vec3 ang_vel = glm::vec3(0.0f); // body frame: roll right, pitch
+	                                     // down, yaw left, rad/s
+	float     speed   = 0.0f;            // m/s
+	float     heading = 0.0f; // of the velocity, ccw from world x, rad
+	float     climb   = 0.0f; // flight path angle, rad
+	float     bank    = 0.0f; // right wing down, rad
+
+	static agent_state read(const fleet_state &state, size_t i);
+};
+
+// an angle in rad into (-pi, pi]
+float wrap_angle(float a);
+
+// Flies the targets a script sets through plain PD loops: altitude through
+// the climb angle and the elevator, heading through the bank and the
+// ailerons, airspeed through the throttle. A few dozen flops per aircraft,
+// so it runs for every agent every tick.
+struct autopilot {
+	static constexpr size_t no_leader = SIZE_MAX;
+
+	bool engaged = false;
+
+	// targets, NaN when not held: then level flight, wings level and a fixed
+	// throttle
+	float altitude = NAN; // m
+	float heading  = NAN; // rad, ccw from world x
+	float speed    = NAN; // m/s
+
+	// with a leader, the targets above follow a slot offset from it, in the
+	// leader's heading frame: forward, left, up
+	size_t    leader          = no_leader;
+	glm::vec3 offset          = glm::vec3(0.0f); // m
+	float     climb_rate_bias = 0.0f; // the leader's, m/s
+
+	// integrators, throttle doubles as the fixed throttle
+	float throttle   = 0.7f;
+	float pitch_trim = 0.0f;
+
+	// distance from the slot at the last fly(), 0 without a leader and
+	// infinite until the first fly() with one
+	float formation_error = 0.0f; // m
+
+	// leader_state must be given when leader is set
+	control_input
+	fly(const agent_state &s, const agent_state *leader_state, float dt);
+};
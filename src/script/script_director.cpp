@@ -0,0 +1,217 @@
+#include "script_director.hpp"
+
+agent::agent(script_director &director, size_t index)
+    : director(&director), index(index) {}
+
+size_t agent::get_index() const {
+	return index;
+}
+
+const agent_state &agent::get_state() const {
+	return director->states[index];
+}
+
+// a target of its own takes the agent out of formation
+
+void agent::climb_to(float altitude) {
+	stop_following();
+	get_pilot().altitude = altitude;
+}
+
+void agent::turn_to(float heading) {
+	stop_following();
+	get_pilot().heading = wrap_angle(glm::radians(heading));
+}
+
+void agent::hold_speed(float speed) {
+	stop_following();
+	get_pilot().speed = speed;
+}
+
+void agent::set_throttle(float throttle) {
+	stop_following();
+	autopilot &p = get_pilot();
+	p.speed      = NAN;
+	p.throttle   = std::clamp(throttle, 0.0f, 1.0f);
+}
+
+void agent::follow(const agent &leader, glm::vec3 offset) {
+	if (leader.director != director || leader.index == index) {
+		throw std::invalid_argument(
+		    "An agent can only follow another agent of its director."
+		);
+	}
+	autopilot &p      = get_pilot();
+	p.leader          = leader.index;
+	p.offset          = offset;
+	p.formation_error = INFINITY;
+}
+
+void agent::stop_following() {
+	// the targets stay at the slot's last ones
+	autopilot &p      = get_pilot();
+	p.leader          = autopilot::no_leader;
+	p.climb_rate_bias = 0.0f;
+	p.formation_error = 0.0f;
+}
+
+void agent::release() {
+	director->pilots[index] = autopilot();
+}
+
+autopilot &agent::get_pilot() const {
+	autopilot &p = director->pilots[index];
+	p.engaged    = true;
+	return p;
+}
+
+void script_director::init(size_t count) {
+	// tasks first, their frames point into wakes
+	tasks.clear();
+	tasks.resize(count);
+	wakes.assign(count, wake_condition());
+	due.assign(count, 0);
+	states.assign(count, agent_state());
+	pilots.assign(count, autopilot());
+	time = 0.0;
+}
+
+size_t script_director::size() const {
+	return tasks.size();
+}
+
+agent script_director::get_agent(size_t i) {
+	return agent(*this, i);
+}
+
+void script_director::run(size_t i, script_task task) {
+	tasks[i] = std::move(task);
+	wakes[i] = wake_condition();
+	if (tasks[i].is_running()) {
+		tasks[i].get_handle().promise().wake = &wakes[i];
+		wakes[i].kind = wake_condition::next_tick;
+	}
+}
+
+size_t script_director::get_running() const {
+	return std::count_if(wakes.begin(), wakes.end(), [](const auto &w) {
+		return w.kind != wake_condition::idle;
+	});
+}
+
+double script_director::get_time() const {
+	return time;
+}
+
+void script_director::tick(
+    const fleet &f, fleet_inputs &inputs, float dt, work_stealing_pool &pool
+) {
+	if (f.size() != size() || inputs.throttle.size() != size()) {
+		throw std::invalid_argument("Need a script slot for every aircraft.");
+	}
+	current_fleet  = &f;
+	current_inputs = &inputs;
+	current_dt     = dt;
+
+	// states are read and conditions checked in chunks of this many
+	const size_t grain = 256;
+	pool.parallel_for(size(), grain, [this](size_t begin, size_t end, size_t) {
+		check_range(begin, end);
+	});
+
+	// Scripts run one after another here, only the few woken this tick. The
+	// first exception waits for the autopilots to have flown.
+	std::exception_ptr error;
+	for (size_t i = 0; i < size(); ++i) {
+		if (!due[i]) {
+			continue;
+		}
+		script_task::handle h = tasks[i].get_handle();
+		h.resume();
+		if (!h.done()) {
+			arm(i);
+			continue;
+		}
+		wakes[i].kind = wake_condition::idle;
+		if (h.promise().error && !error) {
+			error = h.promise().error;
+		}
+		tasks[i] = script_task();
+	}
+
+	pool.parallel_for(size(), grain, [this](size_t begin, size_t end, size_t) {
+		fly_range(begin, end);
+	});
+	time += dt;
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+static bool has_crossed(float difference, float side) {
+	return difference == 0.0f || std::copysign(1.0f, difference) != side;
+}
+
+bool script_director::is_due(size_t i) const {
+	const wake_condition &w = wakes[i];
+	const agent_state    &s = states[i];
+	switch (w.kind) {
+	case wake_condition::idle:
+		return false;
+	case wake_condition::next_tick:
+		return true;
+	case wake_condition::time:
+		// half a tick early, so a sum of float ticks doesn't miss by one
+		return time + 0.5 * current_dt >= w.deadline;
+	case wake_condition::altitude:
+		return has_crossed(s.pos.z - w.value, w.side);
+	case wake_condition::heading:
+		return std::abs(wrap_angle(s.heading - glm::radians(w.value))) <=
+		       glm::radians(w.tolerance);
+	case wake_condition::speed:
+		return has_crossed(s.speed - w.value, w.side);
+	case wake_condition::in_position:
+		return pilots[i].formation_error <= w.value;
+	}
+	return false;
+}
+
+// makes the condition a script just suspended on relative to now
+void script_director::arm(size_t i) {
+	wake_condition    &w = wakes[i];
+	const agent_state &s = states[i];
+	switch (w.kind) {
+	case wake_condition::time:
+		w.deadline += time;
+		break;
+	case wake_condition::altitude:
+		w.side = std::copysign(1.0f, s.pos.z - w.value);
+		break;
+	case wake_condition::speed:
+		w.side = std::copysign(1.0f, s.speed - w.value);
+		break;
+	default:
+		break;
+	}
+}
+
+void script_director::check_range(size_t begin, size_t end) {
+	const fleet_state &state = current_fleet->get_state();
+	for (size_t i = begin; i < end; ++i) {
+		states[i] = agent_state::read(state, i);
+		due[i]    = is_due(i);
+	}
+}
+
+void script_director::fly_range(size_t begin, size_t end) {
+	for (size_t i = begin; i < end; ++i) {
+		autopilot &p = pilots[i];
+		if (!p.engaged) {
+			continue;
+		}
+		const agent_state *leader =
+		    p.leader != autopilot::no_leader ? &states[p.leader] : nullptr;
+		current_inputs->set(i, p.fly(states[i], leader, current_dt));
+	}
+}
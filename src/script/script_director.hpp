@@ -0,0 +1,93 @@
+#pragma once
+
+#include "../dynamics/pch.hpp"
+
+#include "autopilot.hpp"
+#include "script_task.hpp"
+
+class script_director;
+
+// A script's handle on its aircraft, passed to it by value. The targets stay
+// held across co_awaits until set again, the director's autopilot flies them
+// every tick.
+class agent {
+public:
+	agent(script_director &director, size_t index);
+
+	size_t get_index() const;
+
+	const agent_state &get_state() const; // as of the current tick
+
+	void climb_to(float altitude);         // m, then holds it
+	void turn_to(float heading);           // deg, ccw from world x
+	void hold_speed(float speed);          // m/s
+	void set_throttle(float throttle);     // (0, 1), drops hold_speed()
+	void follow(const agent &leader, glm::vec3 offset); // m, forward, left,
+	                                                    // up of its heading
+	void stop_following();
+	// autopilot off, the inputs are left to whoever else writes them
+	void release();
+
+private:
+	script_director *director;
+	size_t           index;
+
+	autopilot &get_pilot() const;
+};
+
+// Runs one scenario script per aircraft of a fleet, for any number of them.
+// Each tick, before the fleet steps:
+//  1. checks what every suspended script waits for, over the pool,
+//  2. resumes the scripts whose condition holds, on the calling thread, so
+//     scripts may touch each other's agents and need no locks,
+//  3. flies every engaged autopilot into the fleet's inputs, over the pool.
+// A waiting script is a few bytes of wake_condition to check, no thread and
+// no stack of its own, and a tick allocates nothing.
+class script_director {
+public:
+	void init(size_t count);
+
+	size_t size() const;
+
+	agent get_agent(size_t i);
+
+	// replaces the aircraft's script, it runs to its first co_await on the
+	// next tick. A script may start other agents' scripts, not replace its
+	// own.
+	void run(size_t i, script_task task);
+
+	// scripts that haven't returned
+	size_t get_running() const;
+
+	// sim time as the scripts see it, dt per tick
+	double get_time() const;
+
+	// Rethrows an exception a script let out, its agent stays on autopilot
+	// with the last targets.
+	void tick(
+	    const fleet        &f,
+	    fleet_inputs       &inputs,
+	    float               dt,
+	    work_stealing_pool &pool
+	);
+
+private:
+	friend class agent;
+
+	std::vector<script_task>    tasks;
+	std::vector<wake_condition> wakes;
+	std::vector<uint8_t>        due; // wake condition held this tick
+	std::vector<agent_state>    states;
+	std::vector<autopilot>      pilots;
+	double                      time = 0.0;
+
+	// the current tick, for the pool jobs
+	const fleet  *current_fleet  = nullptr;
+	fleet_inputs *current_inputs = nullptr;
+	float         current_dt     = 0.0f;
+
+	bool is_due(size_t i) const;
+	void arm(size_t i);
+	void check_range(size_t begin, size_t end);
+	void fly_range(size_t begin, size_t end);
+};
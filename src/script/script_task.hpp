@@ -0,0 +1,149 @@
+#pragma once
+
+#include "../dynamics/pch.hpp"
+
+// What a suspended script waits for. A script's co_await writes one of these
+// into its agent's slot in the script_director, which checks the slots of all
+// agents every tick and resumes a script once its condition holds. Checking
+// never touches the coroutine frame, so a waiting agent costs a few compares.
+struct wake_condition {
+	enum kind_t : uint8_t {
+		idle,        // no script, or it returned
+		next_tick,   // resumed on the next tick
+		time,        // until value seconds have passed
+		altitude,    // until the altitude crosses value, m
+		heading,     // until the heading is within tolerance of value, deg
+		speed,       // until the airspeed crosses value, m/s
+		in_position, // until within value of the formation slot, m
+	};
+
+	kind_t kind      = idle;
+	float  value     = 0.0f;
+	float  tolerance = 0.0f;
+
+	// filled in by the director once the script is suspended
+	float  side     = 0.0f; // sign of (current - value), for crossings
+	double deadline = 0.0;  // director time, for kind time
+};
+
+// A scenario script, one coroutine per agent. The director owns it and
+// resumes it from its tick, on the thread calling tick(). The frame is
+// allocated once when the script is called, suspending and resuming
+// allocate nothing.
+//
+//   script_task climb_out(agent a) {
+//       a.hold_speed(200.0f);
+//       a.climb_to(3000.0f);
+//       co_await until_altitude(2950.0f);
+//       a.turn_to(90.0f);
+//       co_await until_heading(90.0f);
+//       co_await wait(60.0);
+//   }
+//
+// Scripts start suspended and run up to their first co_await on the tick
+// after script_director::run() is given them.
+class script_task {
+public:
+	struct promise_type {
+		wake_condition    *wake = nullptr; // the agent's slot in the director
+		std::exception_ptr error;
+
+		script_task get_return_object() {
+			return script_task(handle::from_promise(*this));
+		}
+		std::suspend_always initial_suspend() noexcept {
+			return {};
+		}
+		std::suspend_always final_suspend() noexcept {
+			return {};
+		}
+		void return_void() {}
+		void unhandled_exception() {
+			error = std::current_exception();
+		}
+	};
+	using handle = std::coroutine_handle<promise_type>;
+
+	script_task() = default;
+	explicit script_task(handle coroutine) : coroutine(coroutine) {}
+	~script_task() {
+		if (coroutine) {
+			coroutine.destroy();
+		}
+	}
+
+	script_task(script_task &&other) noexcept
+	    : coroutine(std::exchange(other.coroutine, nullptr)) {}
+	script_task &operator=(script_task &&other) noexcept {
+		if (this != &other) {
+			if (coroutine) {
+				coroutine.destroy();
+			}
+			coroutine = std::exchange(other.coroutine, nullptr);
+		}
+		return *this;
+	}
+
+	script_task(const script_task &)            = delete;
+	script_task &operator=(const script_task &) = delete;
+
+	// true while there's a script that hasn't returned
+	bool is_running() const {
+		return coroutine && !coroutine.done();
+	}
+
+	handle get_handle() const {
+		return coroutine;
+	}
+
+private:
+	handle coroutine = nullptr;
+};
+
+// the awaitable behind wait() and the until_*() functions
+struct wake_awaiter {
+	wake_condition condition;
+
+	bool await_ready() const noexcept {
+		return false;
+	}
+	void await_suspend(script_task::handle h) const noexcept {
+		*h.promise().wake = condition;
+	}
+	void await_resume() const noexcept {}
+};
+
+// resumes on the next tick, for scripts that steer every tick themselves
+inline wake_awaiter next_tick() {
+	return {{wake_condition::next_tick}};
+}
+
+// resumes after seconds of sim time, at least one tick
+inline wake_awaiter wait(double seconds) {
+	wake_condition c;
+	c.kind     = wake_condition::time;
+	c.deadline = seconds; // made absolute by the director
+	return {c};
+}
+
+// resumes once the altitude reaches meters from either side
+inline wake_awaiter until_altitude(float meters) {
+	return {{wake_condition::altitude, meters}};
+}
+
+// resumes once the heading is within tolerance of degrees, counterclockwise
+// from the world x axis like agent::turn_to()
+inline wake_awaiter until_heading(float degrees, float tolerance = 2.0f) {
+	return {{wake_condition::heading, degrees, tolerance}};
+}
+
+// resumes once the airspeed reaches meters_per_second from either side
+inline wake_awaiter until_speed(float meters_per_second) {
+	return {{wake_condition::speed, meters_per_second}};
+}
+
+// resumes once a following agent is within meters of its slot, see
+// agent::follow()
+inline wake_awaiter until_in_position(float meters) {
+	return {{wake_condition::in_position, meters}};
+}
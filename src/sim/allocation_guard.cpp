@@ -0,0 +1,132 @@
+#include "allocation_guard.hpp"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local bool     guard_active     = false;
+static thread_local uint64_t allocation_count = 0;
+
+allocation_guard::allocation_guard()
+    : start_count(allocation_count), was_active(guard_active) {
+	guard_active = true;
+}
+
+allocation_guard::~allocation_guard() {
+	guard_active = was_active;
+}
+
+uint64_t allocation_guard::get_allocations() const {
+	return allocation_count - start_count;
+}
+
+static void *allocate(size_t size, size_t alignment) {
+	if (guard_active) {
+		allocation_count++;
+	}
+	size = std::max<size_t>(size, 1);
+	if (alignment <= alignof(std::max_align_t)) {
+		return std::malloc(size);
+	}
+	// aligned_alloc wants a multiple of the alignment
+	return std::aligned_alloc(
+	    alignment, (size + alignment - 1) / alignment * alignment
+	);
+}
+
+static void *allocate_or_throw(size_t size, size_t alignment) {
+	if (void *p = allocate(size, alignment)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+// every replaceable form, so none of them bypasses the count and the
+// matching deletes all go to free()
+
+void *operator new(size_t size) {
+	return allocate_or_throw(size, 0);
+}
+
+void *operator new[](size_t size) {
+	return allocate_or_throw(size, 0);
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+	return allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+	return allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+	return allocate(size, 0);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+	return allocate(size, 0);
+}
+
+void *operator new(
+    size_t size, std::align_val_t alignment, const std::nothrow_t &
+) noexcept {
+	return allocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](
+    size_t size, std::align_val_t alignment, const std::nothrow_t &
+) noexcept {
+	return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, size_t, std::align_val_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+	std::free(p);
+}
+
+void operator delete(
+    void *p, std::align_val_t, const std::nothrow_t &
+) noexcept {
+	std::free(p);
+}
+
+void operator delete[](
+    void *p, std::align_val_t, const std::nothrow_t &
+) noexcept {
+	std::free(p);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../dynamics/pch.hpp"
+
+// Counts heap allocations made by the current thread while the guard is
+// alive, to hold code that must not allocate to it. allocation_guard.cpp
+// replaces the global operator new for this, which costs one thread_local
+// check per allocation everywhere else, so it is built on its own,
+// flightsim_allocation_guard, for the executables that count.
+class allocation_guard {
+public:
+	allocation_guard();
+	~allocation_guard();
+
+	allocation_guard(const allocation_guard &)            = delete;
+	allocation_guard &operator=(const allocation_guard &) = delete;
+
+	// allocations on this thread since the guard was made
+	uint64_t get_allocations() const;
+
+private:
+	uint64_t start_count;
+	bool     was_active;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../dynamics/pch.hpp"
+
+// Turns variable wall-clock frame times into a whole number of fixed
+// simulation steps. Leftover time stays in the accumulator for the next
+// frame, and get_alpha() tells how far the display is between the last two
+// simulation states, for render interpolation.
+//
+// Time warp multiplies simulated time per wall-clock second. The per-frame
+// step budget is max_substeps at 1x and scales with the warp. Whatever doesn't
+// fit into the budget, e.g. after a window drag or a shader compile, is
+// dropped instead of being caught up, so one stall can't snowball.
+class fixed_step_clock {
+public:
+	static constexpr int min_time_warp = 1;
+	static constexpr int max_time_warp = 64;
+
+	explicit fixed_step_clock(double step = 1.0 / 1000.0, int max_substeps = 50)
+	    : step(step), max_substeps(max_substeps) {
+		if (step <= 0.0 || max_substeps < 1) {
+			throw std::invalid_argument("need step > 0 and max_substeps >= 1");
+		}
+	}
+
+	// adds a frame's worth of wall-clock time, returns the steps to run now
+	int advance(double frame_seconds) {
+		accumulator += std::max(frame_seconds, 0.0) * time_warp;
+
+		auto steps  = static_cast<int64_t>(accumulator / step);
+		int  budget = max_substeps * time_warp;
+		if (steps > budget) {
+			dropped_time += (steps - budget) * step;
+			steps         = budget;
+			accumulator   = std::fmod(accumulator, step);
+		} else {
+			accumulator -= steps * step;
+		}
+		sim_time += steps * step;
+		return static_cast<int>(steps);
+	}
+
+	// seconds of simulated time per step
+	double get_step() const {
+		return step;
+	}
+
+	// [0, 1), where the display sits between the previous and the current
+	// simulation state
+	float get_alpha() const {
+		return std::clamp(static_cast<float>(accumulator / step), 0.0f, 1.0f);
+	}
+
+	// clamped to [min_time_warp, max_time_warp]
+	void set_time_warp(int warp) {
+		time_warp = std::clamp(warp, min_time_warp, max_time_warp);
+	}
+
+	int get_time_warp() const {
+		return time_warp;
+	}
+
+	double get_sim_time() const {
+		return sim_time;
+	}
+
+	// simulated time given up to the substep budget so far
+	double get_dropped_time() const {
+		return dropped_time;
+	}
+
+private:
+	double step;
+	int    max_substeps;
+	int    time_warp    = 1;
+	double accumulator  = 0.0;
+	double sim_time     = 0.0;
+	double dropped_time = 0.0;
+};
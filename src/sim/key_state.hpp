@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../pch.hpp"
+
+#include "../gfx/window.hpp"
+
+// Which keys were down at one point in time. GLFW may only be polled from the
+// main thread, so that's where this gets captured before it's handed to the
+// simulation.
+class key_state {
+public:
+	static key_state capture(const window &window) {
+		key_state state;
+		for (int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; ++key) {
+			state.down[key] = window.is_glfw_key_down(key);
+		}
+		return state;
+	}
+
+	bool is_glfw_key_down(int key) const {
+		return key >= 0 && key <= GLFW_KEY_LAST && down[key];
+	}
+
+private:
+	std::bitset<GLFW_KEY_LAST + 1> down;
+};
@@ -0,0 +1,90 @@
+#include "keyboard_input.hpp"
+
+void keyboard_input::set_keys(const key_state &keys) {
+	this->keys = keys;
+}
+
+void keyboard_input::set_throttle_rate(float rate) {
+	throttle_rate = rate;
+}
+
+control_input keyboard_input::poll(double, float dt) {
+	// process input
+	if (keys.is_glfw_key_down(GLFW_KEY_LEFT_SHIFT)) {
+		input.throttle += throttle_rate * dt;
+		input.throttle  = glm::min(input.throttle, 1.0f);
+	}
+	if (keys.is_glfw_key_down(GLFW_KEY_LEFT_CONTROL)) {
+		input.throttle -= throttle_rate * dt;
+		input.throttle  = glm::max(input.throttle, 0.0f);
+	}
+	if (keys.is_glfw_key_down(GLFW_KEY_Z)) {
+		input.throttle = 1.0f;
+	} else if (keys.is_glfw_key_down(GLFW_KEY_X)) {
+		input.throttle = 0.0f;
+	}
+	if (!flaps_down_key_just_pressed && keys.is_glfw_key_down(GLFW_KEY_F)) {
+		input.flaps_down            = !input.flaps_down;
+		flaps_down_key_just_pressed = true;
+	} else if (!keys.is_glfw_key_down(GLFW_KEY_F)) {
+		flaps_down_key_just_pressed = false;
+	}
+	if (!afterburner_key_just_pressed && keys.is_glfw_key_down(GLFW_KEY_C)) {
+		input.afterburner            = !input.afterburner;
+		afterburner_key_just_pressed = true;
+	} else if (!keys.is_glfw_key_down(GLFW_KEY_C)) {
+		afterburner_key_just_pressed = false;
+	}
+	float pitch_down_level =
+	    static_cast<int>(keys.is_glfw_key_down(GLFW_KEY_W)) -
+	    keys.is_glfw_key_down(GLFW_KEY_S);
+	float roll_right_level =
+	    static_cast<int>(keys.is_glfw_key_down(GLFW_KEY_D)) -
+	    keys.is_glfw_key_down(GLFW_KEY_A);
+	float rudder_left_level =
+	    static_cast<int>(keys.is_glfw_key_down(GLFW_KEY_Q)) -
+	    keys.is_glfw_key_down(GLFW_KEY_E);
+
+	// exponential, so that it doesn't depend on the step rate
+	float smooth_fac = 1.0f - std::exp(-dt / input_smoothing_time);
+	input.pitch_down = glm::mix(input.pitch_down, pitch_down_level, smooth_fac);
+	input.roll_right = glm::mix(input.roll_right, roll_right_level, smooth_fac);
+	input.rudder_left =
+	    glm::mix(input.rudder_left, rudder_left_level, smooth_fac);
+
+	// debug rotate body
+	input.debug_turn = glm::vec2(0.0f);
+	if (keys.is_glfw_key_down(GLFW_KEY_I)) {
+		input.debug_turn.x = 10.0f;
+	} else if (keys.is_glfw_key_down(GLFW_KEY_K)) {
+		input.debug_turn.x = -10.0f;
+	}
+	if (keys.is_glfw_key_down(GLFW_KEY_J)) {
+		input.debug_turn.y = 10.0f;
+	} else if (keys.is_glfw_key_down(GLFW_KEY_L)) {
+		input.debug_turn.y = -10.0f;
+	}
+
+	return input;
+}
+
+void log_input_changes(const control_input &from, const control_input &to) {
+	if (to.throttle != from.throttle) {
+		if (to.throttle == 1.0f) {
+			std::cout << "Throttle MAX" << std::endl;
+		} else if (to.throttle == 0.0f) {
+			std::cout << "Throttle OFF" << std::endl;
+		} else {
+			std::cout << (to.throttle > from.throttle ? "Throttle up "
+			                                          : "Throttle down ")
+			          << to.throttle << std::endl;
+		}
+	}
+	if (to.flaps_down != from.flaps_down) {
+		std::cout << "Flaps " << (to.flaps_down ? "DOWN" : "UP") << std::endl;
+	}
+	if (to.afterburner != from.afterburner) {
+		std::cout << "Afterburner " << (to.afterburner ? "ON" : "OFF")
+		          << std::endl;
+	}
+}
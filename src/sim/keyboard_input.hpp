@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../pch.hpp"
+
+#include "../dynamics/input_source.hpp"
+#include "key_state.hpp"
+
+// Turns held keys into control_input the way the sim has always flown:
+// throttle ramps at the engine's rate, flaps and afterburner toggle on key
+// down, and the sticks ease towards the keys so they don't snap. poll() runs
+// on the simulation thread and prints nothing, the render thread reports the
+// changes from the published frames with log_input_changes().
+class keyboard_input : public input_source {
+public:
+	// the keys the following polls read, captured on the main thread
+	void set_keys(const key_state &keys);
+	// how fast the throttle keys move the throttle, 1/s
+	void set_throttle_rate(float rate);
+
+	control_input poll(double time, float dt) override;
+
+private:
+	control_input input;
+	key_state     keys;
+	float         throttle_rate = 0.0f;
+
+	bool flaps_down_key_just_pressed  = false;
+	bool afterburner_key_just_pressed = false;
+
+	const float input_smoothing_time = 0.8f; // s, ~0.02 per frame at 60 Hz
+};
+
+// throttle, flaps and afterburner changes from one input to the next, to
+// stdout
+void log_input_changes(const control_input &from, const control_input &to);
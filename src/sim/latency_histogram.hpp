@@ -0,0 +1,102 @@
+#pragma once
+
+#include "../pch.hpp"
+
+// Timing record of a periodic loop against its absolute deadlines. Bucket i
+// counts latencies in [2^(i-1), 2^i) microseconds, bucket 0 everything under
+// 1 us and the last one everything from there up. Also counts the heap
+// allocations of each cycle, which a realtime cycle shouldn't make. record()
+// doesn't allocate.
+class latency_histogram {
+public:
+	static constexpr size_t num_buckets = 18; // up to ~65 ms
+
+	explicit latency_histogram(double period = 1.0 / 1000.0)
+	    : period(period) {}
+
+	// Wake-up and completion times of one cycle, in seconds after its
+	// deadline, and the allocations it made. A cycle that completes after
+	// the next deadline is a miss.
+	void record(
+	    double wake_latency, double step_latency, uint64_t allocations = 0
+	) {
+		wake_buckets[bucket_of(wake_latency)]++;
+		step_buckets[bucket_of(step_latency)]++;
+		cycles++;
+		worst_wake = std::max(worst_wake, wake_latency);
+		worst_step = std::max(worst_step, step_latency);
+		if (step_latency > period) {
+			misses++;
+		}
+		if (allocations > 0) {
+			allocating_cycles++;
+			total_allocations += allocations;
+			max_allocations    = std::max(max_allocations, allocations);
+		}
+	}
+
+	uint64_t get_cycles() const {
+		return cycles;
+	}
+
+	uint64_t get_misses() const {
+		return misses;
+	}
+
+	double get_worst_step_latency() const {
+		return worst_step;
+	}
+
+	uint64_t get_allocations() const {
+		return total_allocations;
+	}
+
+	void print(std::ostream &out) const {
+		out << cycles << " cycles at " << period * 1e6 << " us, " << misses
+		    << " deadline misses" << std::endl;
+		out << "worst wake-up latency " << worst_wake * 1e6
+		    << " us, worst step latency " << worst_step * 1e6 << " us"
+		    << std::endl;
+		out << total_allocations << " allocations in " << allocating_cycles
+		    << " cycles, at most " << max_allocations << " in one"
+		    << std::endl;
+		out << "latency (us)      wake-up        step" << std::endl;
+		for (size_t i = 0; i < num_buckets; ++i) {
+			if (!wake_buckets[i] && !step_buckets[i]) {
+				continue;
+			}
+			std::string range =
+			    i == 0 ? "< 1"
+			    : i == num_buckets - 1
+			        ? ">= " + std::to_string(1u << (i - 1))
+			        : std::to_string(1u << (i - 1)) + " - " +
+			              std::to_string(1u << i);
+			out << std::left << std::setw(14) << range << std::right
+			    << std::setw(12) << wake_buckets[i] << std::setw(12)
+			    << step_buckets[i] << std::endl;
+		}
+	}
+
+private:
+	double period;
+
+	std::array<uint64_t, num_buckets> wake_buckets{};
+	std::array<uint64_t, num_buckets> step_buckets{};
+
+	uint64_t cycles            = 0;
+	uint64_t misses            = 0;
+	double   worst_wake        = 0.0;
+	double   worst_step        = 0.0;
+	uint64_t allocating_cycles = 0;
+	uint64_t total_allocations = 0;
+	uint64_t max_allocations   = 0;
+
+	static size_t bucket_of(double latency) {
+		double us = std::max(latency * 1e6, 0.0);
+		if (us < 1.0) {
+			return 0;
+		}
+		size_t i = static_cast<size_t>(std::floor(std::log2(us))) + 1;
+		return std::min(i, num_buckets - 1);
+	}
+};
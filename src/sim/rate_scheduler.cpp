@@ -0,0 +1,104 @@
+#include "rate_scheduler.hpp"
+
+static int64_t to_ns(double seconds) {
+	return std::llround(seconds * 1e9);
+}
+
+rate_scheduler::task_id rate_scheduler::add_task(
+    std::string                 name,
+    double                      rate_hz,
+    std::function<void(double)> run,
+    catch_up_policy             policy,
+    double                      phase
+) {
+	if (!(rate_hz > 0.0) || !run) {
+		throw std::invalid_argument(
+		    "Task " + name + " needs a positive rate and a function."
+		);
+	}
+	int64_t period_ns = std::max<int64_t>(to_ns(1.0 / rate_hz), 1);
+	int64_t first_ns  = now_ns + to_ns(phase / rate_hz);
+
+	tasks.push_back({
+	    .name        = std::move(name),
+	    .period_ns   = period_ns,
+	    .next_due_ns = first_ns,
+	    .last_run_ns = first_ns - period_ns,
+	    .run         = std::move(run),
+	    .policy      = policy,
+	    .stats       = {},
+	});
+	return tasks.size() - 1;
+}
+
+void rate_scheduler::run_until(double time) {
+	using std::chrono::steady_clock;
+
+	int64_t until_ns = std::max(to_ns(time), now_ns);
+
+	while (true) {
+		// earliest due task, the first added one on ties
+		task *next = nullptr;
+		for (task &t : tasks) {
+			if (t.next_due_ns < until_ns &&
+			    (!next || t.next_due_ns < next->next_due_ns)) {
+				next = &t;
+			}
+		}
+		if (!next) {
+			break;
+		}
+
+		task   &t       = *next;
+		int64_t due_ns  = t.next_due_ns;
+		int64_t dt_ns   = t.period_ns;
+
+		// more ticks of this task due before until_ns
+		int64_t behind = (until_ns - due_ns - 1) / t.period_ns;
+		if (behind > 0 && t.policy == catch_up_policy::skip) {
+			// fold them all into this one
+			t.stats.skipped += behind;
+			due_ns          += behind * t.period_ns;
+			dt_ns            = due_ns - t.last_run_ns;
+		} else if (behind > 0) {
+			t.stats.caught_up++;
+		}
+		now_ns = due_ns;
+
+		auto start = steady_clock::now();
+		t.run(dt_ns * 1e-9);
+		auto   end     = steady_clock::now();
+		double seconds = std::chrono::duration<double>(end - start).count();
+
+		t.last_run_ns          = due_ns;
+		t.next_due_ns          = due_ns + t.period_ns;
+		t.stats.runs++;
+		t.stats.total_seconds += seconds;
+		t.stats.max_seconds    = std::max(t.stats.max_seconds, seconds);
+		if (seconds > t.period_ns * 1e-9) {
+			t.stats.overruns++;
+		}
+	}
+	now_ns = until_ns;
+}
+
+double rate_scheduler::get_time() const {
+	return now_ns * 1e-9;
+}
+
+const rate_scheduler::task_stats &
+rate_scheduler::get_stats(task_id id) const {
+	return tasks.at(id).stats;
+}
+
+void rate_scheduler::print_stats(std::ostream &out) const {
+	for (const task &t : tasks) {
+		const task_stats &s = t.stats;
+		double avg_seconds = s.runs ? s.total_seconds / s.runs : 0.0;
+		out << t.name << " @ " << 1e9 / t.period_ns << " Hz: " << s.runs
+		    << " runs, " << s.skipped << " skipped, " << s.caught_up
+		    << " caught up, " << s.overruns << " overruns, avg "
+		    << avg_seconds * 1e6 << " us, max " << s.max_seconds * 1e6
+		    << " us" << std::endl;
+	}
+}
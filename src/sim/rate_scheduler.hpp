@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../dynamics/pch.hpp"
+
+// Runs tasks registered at fixed rates off one clock. A tick due at t covers
+// [t, t + period), so run_until() executes every tick due before the new
+// time, earliest first, and tasks due at the same time in the order they were
+// added. A given timeline always produces the same sequence of calls.
+//
+// Time is whatever the caller advances it by, wall clock or simulation time.
+// Due times are kept in whole nanoseconds, so rates don't drift against each
+// other however long it runs.
+class rate_scheduler {
+public:
+	enum class catch_up_policy {
+		run_all, // every missed tick runs, each with its nominal dt
+		skip     // one run for however many were missed, with the real dt
+	};
+
+	// per task accounting, see get_stats()
+	struct task_stats {
+		uint64_t runs          = 0;
+		uint64_t skipped       = 0;   // ticks folded into a later run by skip
+		uint64_t caught_up     = 0;   // ran while a period or more behind
+		uint64_t overruns      = 0;   // took longer than a period, wall time
+		double   total_seconds = 0.0; // wall time spent in the task
+		double   max_seconds   = 0.0;
+	};
+
+	using task_id = size_t;
+
+	// Phase delays the first tick by that fraction of a period, to keep
+	// tasks with the same rate from all landing on the same tick.
+	task_id add_task(
+	    std::string                 name,
+	    double                      rate_hz,
+	    std::function<void(double)> run,
+	    catch_up_policy             policy = catch_up_policy::run_all,
+	    double                      phase  = 0.0
+	);
+
+	// runs everything due before time, in seconds since the start
+	void run_until(double time);
+
+	double get_time() const;
+
+	const task_stats &get_stats(task_id id) const;
+	void              print_stats(std::ostream &out) const;
+
+private:
+	struct task {
+		std::string                 name;
+		int64_t                     period_ns;
+		int64_t                     next_due_ns;
+		int64_t                     last_run_ns;
+		std::function<void(double)> run;
+		catch_up_policy             policy;
+		task_stats                  stats;
+	};
+
+	std::vector<task> tasks;
+	int64_t           now_ns = 0;
+};
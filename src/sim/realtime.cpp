@@ -0,0 +1,83 @@
+#include "realtime.hpp"
+
+#ifdef __linux__
+#include <alloca.h>
+#include <cerrno>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+bool lock_process_memory() {
+#ifdef __linux__
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+		return false;
+	}
+	// freed memory stays in the heap and big blocks don't get their own
+	// mappings, so later allocations don't fault in fresh pages
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void prefault_stack(size_t bytes) {
+#ifdef __linux__
+	// the frame is gone on return, the pages stay mapped and locked
+	auto *stack = static_cast<volatile uint8_t *>(alloca(bytes));
+	for (size_t i = 0; i < bytes; i += 4096) {
+		stack[i] = 0;
+	}
+#else
+	(void)bytes;
+#endif
+}
+
+bool pin_thread_to_cpu(int cpu) {
+#ifdef __linux__
+	long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpu < 0) {
+		cpu = static_cast<int>(num_cpus) - 1;
+	}
+	if (cpu < 0 || cpu >= num_cpus) {
+		return false;
+	}
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+bool set_thread_fifo_priority(int priority) {
+#ifdef __linux__
+	sched_param param{};
+	param.sched_priority = priority;
+	return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#else
+	(void)priority;
+	return false;
+#endif
+}
+
+void sleep_until_deadline(std::chrono::steady_clock::time_point deadline) {
+#ifdef __linux__
+	// steady_clock is CLOCK_MONOTONIC on Linux
+	std::chrono::nanoseconds ns = deadline.time_since_epoch();
+	timespec                 ts;
+	ts.tv_sec  = ns.count() / 1000000000;
+	ts.tv_nsec = ns.count() % 1000000000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+	       EINTR) {}
+#else
+	std::this_thread::sleep_until(deadline);
+#endif
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../pch.hpp"
+
+// Settings for sim_thread::start_realtime().
+struct realtime_options {
+	int    cpu         = -1;         // core to pin to, -1 for the last one
+	int    priority    = 80;         // SCHED_FIFO priority, 1 to 99
+	size_t stack_bytes = 256 * 1024; // touched up front, so it's resident
+};
+
+// The OS side of a hard real-time run. Linux only, elsewhere these do
+// nothing and return false. Each one returns false and leaves things as they
+// were when the OS doesn't allow it, e.g. SCHED_FIFO without CAP_SYS_NICE,
+// so callers can warn and carry on with what they got.
+
+// Locks all current and future pages in RAM and keeps malloc from handing
+// memory back to the OS, so nothing gets paged out or faulted in later.
+bool lock_process_memory();
+
+// Touches bytes of the calling thread's stack, so its pages are resident.
+void prefault_stack(size_t bytes);
+
+bool pin_thread_to_cpu(int cpu);
+bool set_thread_fifo_priority(int priority);
+
+// Sleeps until an absolute time, not for a duration, so wake-ups don't drift
+// by however long it took to get here.
+void sleep_until_deadline(std::chrono::steady_clock::time_point deadline);
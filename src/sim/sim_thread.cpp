@@ -0,0 +1,217 @@
+#include "sim_thread.hpp"
+
+#include "allocation_guard.hpp"
+
+// seconds as a steady_clock duration
+static std::chrono::steady_clock::duration to_duration(double seconds) {
+	return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+	    std::chrono::duration<double>(seconds)
+	);
+}
+
+sim_thread::sim_thread(jet_model &target, double step)
+    : target(target), clock(step), latencies(step) {
+	keyboard.set_throttle_rate(target.get_def().engine.throttle_rate);
+
+	// added in the order they run when due together, controls first
+	tasks.add_task("control", 200.0, [this](double dt) {
+		float control_dt = static_cast<float>(dt);
+		this->target.update_controls(
+		    source->poll(tasks.get_time(), control_dt), control_dt
+		);
+	});
+	tasks.add_task("physics", 1.0 / step, [this](double dt) {
+		this->target.update_physics(static_cast<float>(dt));
+	});
+}
+
+sim_thread::~sim_thread() {
+	stop();
+}
+
+void sim_thread::start() {
+	if (thread.joinable()) {
+		throw std::runtime_error("Simulation thread is already running.");
+	}
+
+	// the render thread has something to show from the first frame on
+	publish(std::chrono::steady_clock::now());
+	thread = std::jthread([this](std::stop_token stop) { run(stop); });
+}
+
+void sim_thread::start_realtime(const realtime_options &options) {
+	if (thread.joinable()) {
+		throw std::runtime_error("Simulation thread is already running.");
+	}
+
+	// snapshot vectors get their final size here, not in the first cycles
+	frames.for_each_slot([this](frame &f) { target.write_snapshot(f.jet); });
+	publish(std::chrono::steady_clock::now());
+
+	realtime = true;
+	thread   = std::jthread([this, options](std::stop_token stop) {
+		run_realtime(stop, options);
+	});
+}
+
+void sim_thread::stop() {
+	if (thread.joinable()) {
+		thread.request_stop();
+		thread.join();
+		tasks.print_stats(std::cout);
+		if (realtime) {
+			latencies.print(std::cout);
+		}
+		if (has_failed()) {
+			std::cerr << "Simulation stopped: " << error << std::endl;
+		}
+	}
+}
+
+bool sim_thread::has_failed() const {
+	return failed.load(std::memory_order_acquire);
+}
+
+uint64_t sim_thread::get_realtime_allocations() const {
+	return latencies.get_allocations();
+}
+
+void sim_thread::set_input_source(input_source *source) {
+	if (thread.joinable()) {
+		throw std::runtime_error("Simulation thread is already running.");
+	}
+	this->source = source ? source : &keyboard;
+}
+
+keyboard_input &sim_thread::get_keyboard() {
+	return keyboard;
+}
+
+bool sim_thread::send(const controls &c) {
+	return control_queue.try_push(c);
+}
+
+const sim_thread::frame &sim_thread::get_latest_frame() {
+	frames.update();
+	return frames.get_read_buffer();
+}
+
+float sim_thread::get_alpha(
+    const frame &f, std::chrono::steady_clock::time_point now
+) {
+	if (f.wall_step <= 0.0) {
+		return 1.0f;
+	}
+	// shown one step late, so there's always a next state to move towards
+	double since_due = std::chrono::duration<double>(now - f.due).count();
+	return std::clamp(static_cast<float>(since_due / f.wall_step), 0.0f, 1.0f);
+}
+
+void sim_thread::run(std::stop_token stop) {
+	using std::chrono::steady_clock;
+
+	auto last = steady_clock::now();
+	try {
+		while (!stop.stop_requested()) {
+			receive_controls();
+			clock.set_time_warp(current.time_warp);
+
+			auto   now = steady_clock::now();
+			double elapsed =
+			    std::chrono::duration<double>(now - last).count();
+			int    steps     = clock.advance(elapsed);
+			double wall_step = clock.get_step() / clock.get_time_warp();
+			last             = now;
+			tasks.run_until(clock.get_sim_time());
+			if (steps > 0) {
+				// the accumulator holds time the newest state doesn't cover
+				publish(now - to_duration(wall_step * clock.get_alpha()));
+			}
+
+			// wake up when the next step is due
+			std::this_thread::sleep_until(
+			    now + to_duration(wall_step * (1.0 - clock.get_alpha()))
+			);
+		}
+	} catch (const std::exception &e) {
+		fail(e);
+	}
+}
+
+void sim_thread::run_realtime(
+    std::stop_token stop, realtime_options options
+) {
+	using std::chrono::steady_clock;
+
+	prefault_stack(options.stack_bytes);
+	if (!pin_thread_to_cpu(options.cpu)) {
+		std::cerr << "Could not pin the simulation thread to a CPU."
+		          << std::endl;
+	}
+	if (!set_thread_fifo_priority(options.priority)) {
+		std::cerr << "SCHED_FIFO not permitted, running at normal priority."
+		          << std::endl;
+	}
+
+	const auto period   = to_duration(clock.get_step());
+	auto       deadline = steady_clock::now() + period;
+	uint64_t   cycle    = 0;
+	try {
+		while (!stop.stop_requested()) {
+			sleep_until_deadline(deadline);
+			auto     wake = steady_clock::now();
+			uint64_t allocations;
+			{
+				allocation_guard guard;
+				receive_controls();
+				cycle++;
+				tasks.run_until(cycle * clock.get_step());
+				publish(deadline);
+				allocations = guard.get_allocations();
+			}
+			auto done = steady_clock::now();
+			latencies.record(
+			    std::chrono::duration<double>(wake - deadline).count(),
+			    std::chrono::duration<double>(done - deadline).count(),
+			    allocations
+			);
+
+			// stay on the absolute grid, cycles already gone are dropped
+			// and simulation time falls behind by as much
+			deadline += period;
+			if (done > deadline) {
+				deadline += period * ((done - deadline) / period + 1);
+			}
+		}
+	} catch (const std::exception &e) {
+		// the failing cycle goes unrecorded, the thread ends here anyway
+		fail(e);
+	}
+}
+
+// ends the thread's loop for good, stop() prints why
+void sim_thread::fail(const std::exception &e) {
+	error = e.what();
+	failed.store(true, std::memory_order_release);
+}
+
+// controls are whole states, so only the newest one matters
+void sim_thread::receive_controls() {
+	while (std::optional<controls> c = control_queue.try_pop()) {
+		current = *c;
+	}
+	keyboard.set_keys(current.keys);
+	if (target.get_integrator() != current.method) {
+		target.set_integrator(current.method);
+	}
+}
+
+void sim_thread::publish(std::chrono::steady_clock::time_point due) {
+	frame &f    = frames.get_write_buffer();
+	f.due       = due;
+	f.wall_step = clock.get_step() / clock.get_time_warp();
+	f.sim_time  = tasks.get_time();
+	f.time_warp = clock.get_time_warp();
+	target.write_snapshot(f.jet);
+	frames.publish();
+}
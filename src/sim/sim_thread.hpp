@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../pch.hpp"
+
+#include "../dynamics/jet_model.hpp"
+#include "fixed_step_clock.hpp"
+#include "key_state.hpp"
+#include "keyboard_input.hpp"
+#include "latency_histogram.hpp"
+#include "rate_scheduler.hpp"
+#include "realtime.hpp"
+#include "spsc_queue.hpp"
+#include "triple_buffer.hpp"
+
+// Runs a jet model on its own thread, at its own rate, so physics time
+// doesn't add to frame time and a vsync wait doesn't stall physics. Within
+// the thread a rate_scheduler in simulation time runs the control laws at
+// 200 Hz and physics at the step rate. The thread never writes to stdout,
+// telemetry and input changes are for the render thread to print from the
+// frames, see log_telemetry() and log_input_changes().
+//
+// The render thread send()s controls over a lock-free queue and reads the
+// latest published frame through a triple buffer. Neither thread ever blocks
+// on the other. While running, only the simulation thread may touch the
+// model.
+class sim_thread {
+public:
+	// everything the render thread steers the simulation with
+	struct controls {
+		key_state          keys;
+		int                time_warp = 1;
+		integrator::method method    = integrator::method::semi_implicit_euler;
+	};
+
+	// published after every batch of physics steps
+	struct frame {
+		jet_snapshot jet;
+		// wall clock time the newest state belongs to and the wall clock
+		// length of one step, see get_alpha()
+		std::chrono::steady_clock::time_point due;
+		double                                wall_step = 0.0;
+		double                                sim_time  = 0.0;
+		int                                   time_warp = 1;
+	};
+
+	explicit sim_thread(jet_model &target, double step = 1.0 / 1000.0);
+	~sim_thread();
+
+	sim_thread(const sim_thread &)            = delete;
+	sim_thread &operator=(const sim_thread &) = delete;
+
+	void start();
+	// Hard real-time loop for hardware in the loop: one step per period on
+	// absolute deadlines, no time warp, pinned to a core and SCHED_FIFO
+	// where permitted, and every cycle's heap allocations counted in the
+	// timing report. Lock the process memory before, see
+	// lock_process_memory().
+	void start_realtime(const realtime_options &options);
+	// also prints the task stats, the timing report of a realtime run and
+	// what stopped the thread if it failed
+	void stop();
+
+	// render thread, true once the thread stopped because a task threw,
+	// e.g. a recording that doesn't match the control rate
+	bool has_failed() const;
+
+	// after stop(), allocations made inside realtime cycles, should be 0
+	uint64_t get_realtime_allocations() const;
+
+	// Flies from source instead of the keyboard, e.g. a recording, polled
+	// on the simulation thread. Set it before start(), nullptr goes back to
+	// the keyboard.
+	void set_input_source(input_source *source);
+	// the default source, e.g. to wrap in an input_recorder
+	keyboard_input &get_keyboard();
+
+	// render thread, returns false if the queue was full and it got dropped
+	bool send(const controls &c);
+
+	// render thread, the newest frame, never blocks
+	const frame &get_latest_frame();
+
+	// render thread, how far between the frame's two states to draw at now
+	static float get_alpha(
+	    const frame &f, std::chrono::steady_clock::time_point now
+	);
+
+private:
+	jet_model       &target;
+	fixed_step_clock clock;
+	rate_scheduler   tasks;
+	controls         current; // newest controls received, sim thread only
+	keyboard_input   keyboard; // current.keys to control input
+	input_source    *source = &keyboard;
+
+	spsc_queue<controls, 64> control_queue;
+	triple_buffer<frame>     frames;
+	std::jthread             thread;
+
+	// what() of the exception that ended the thread, set before failed
+	std::string       error;
+	std::atomic<bool> failed = false;
+
+	// realtime runs only
+	bool              realtime = false;
+	latency_histogram latencies;
+
+	void run(std::stop_token stop);
+	void run_realtime(std::stop_token stop, realtime_options options);
+	void fail(const std::exception &e);
+	void receive_controls();
+	void publish(std::chrono::steady_clock::time_point due);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../pch.hpp"
+
+// Bounded lock-free FIFO for exactly one producer and one consumer thread.
+// try_push() fails instead of waiting when the queue is full and try_pop()
+// returns nothing when it's empty. T is copied in and out, so keep it small
+// and trivially copyable.
+template <typename T, size_t Capacity> class spsc_queue {
+	static_assert(std::has_single_bit(Capacity), "capacity must be 2^n");
+
+public:
+	spsc_queue() = default;
+
+	spsc_queue(const spsc_queue &)            = delete;
+	spsc_queue &operator=(const spsc_queue &) = delete;
+
+	// producer only
+	bool try_push(const T &value) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+		slots[t & (Capacity - 1)] = value;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer only
+	std::optional<T> try_pop() {
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire)) {
+			return std::nullopt;
+		}
+		T value = slots[h & (Capacity - 1)];
+		head.store(h + 1, std::memory_order_release);
+		return value;
+	}
+
+private:
+	std::array<T, Capacity> slots{};
+
+	// free-running counters, on separate cache lines
+	alignas(64) std::atomic<size_t> head{0}; // next to pop
+	alignas(64) std::atomic<size_t> tail{0}; // next to push
+};
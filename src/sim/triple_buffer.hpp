@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../pch.hpp"
+
+// Lock-free handoff of the latest value from one writer thread to one reader
+// thread. The writer fills get_write_buffer() and publish()es it, the reader
+// calls update() and then looks at get_read_buffer(). Neither side ever
+// waits: three slots means there is always one the other side isn't using.
+// Values the reader doesn't get to in time are overwritten, only the newest
+// one matters.
+//
+// The slots are reused, so a T holding e.g. vectors stops allocating once the
+// vectors have grown to size.
+template <typename T> class triple_buffer {
+public:
+	triple_buffer() = default;
+
+	triple_buffer(const triple_buffer &)            = delete;
+	triple_buffer &operator=(const triple_buffer &) = delete;
+
+	// Calls f on all three slots, e.g. to size them up front. Only while
+	// neither side is using the buffer.
+	template <typename F> void for_each_slot(F &&f) {
+		for (slot &s : slots) {
+			f(s.value);
+		}
+	}
+
+	// writer only, the slot to fill for the next publish()
+	T &get_write_buffer() {
+		return slots[back].value;
+	}
+
+	// writer only, hands the filled slot over and takes the spare one back
+	void publish() {
+		uint8_t prev =
+		    middle.exchange(back | fresh_bit, std::memory_order_acq_rel);
+		back = prev & index_mask;
+	}
+
+	// reader only, picks up the newest published value if there is one,
+	// returns whether there was
+	bool update() {
+		if (!(middle.load(std::memory_order_relaxed) & fresh_bit)) {
+			return false;
+		}
+		uint8_t prev = middle.exchange(front, std::memory_order_acq_rel);
+		front        = prev & index_mask;
+		return true;
+	}
+
+	// reader only, stays valid until the next update()
+	const T &get_read_buffer() const {
+		return slots[front].value;
+	}
+
+private:
+	static constexpr uint8_t index_mask = 0b011;
+	static constexpr uint8_t fresh_bit  = 0b100; // middle not read yet
+
+	// one cache line each, so the threads don't share any
+	struct alignas(64) slot {
+		T value{};
+	};
+
+	std::array<slot, 3> slots;
+
+	alignas(64) std::atomic<uint8_t> middle{1}; // index | fresh_bit
+	alignas(64) uint8_t back  = 0;              // writer's slot
+	alignas(64) uint8_t front = 2;              // reader's slot
+};
@@ -0,0 +1,121 @@
+// aircraft_def rejects what would otherwise reach the model: unterminated
+// names and bad counts in binaries, NaN anywhere a value is range checked,
+// coefficient tables too big to bake and too few controls to mix into.
+
+#include "check.hpp"
+
+#include "dynamics/aircraft_def.hpp"
+
+static bool throws(const std::function<void()> &f) {
+	try {
+		f();
+	} catch (const std::exception &) {
+		return true;
+	}
+	return false;
+}
+
+static void check_binary(const aircraft_def &su34) {
+	const std::vector<uint8_t> good = su34.save_to_binary();
+	check(
+	    !throws([&] { aircraft_def().load_from_binary(good, "good"); }),
+	    "su34 round trip"
+	);
+
+	// the aircraft name directly follows the header
+	std::vector<uint8_t> data = good;
+	std::memset(
+	    data.data() + sizeof(aircraft_def::file_header),
+	    'x',
+	    aircraft_def::name_size
+	);
+	check(
+	    throws([&] { aircraft_def().load_from_binary(data, "name"); }),
+	    "unterminated name"
+	);
+
+	data = good;
+	aircraft_def::file_header hdr;
+	std::memcpy(&hdr, data.data(), sizeof(hdr));
+	hdr.num_sections = 0xffffffff;
+	std::memcpy(data.data(), &hdr, sizeof(hdr));
+	check(
+	    throws([&] { aircraft_def().load_from_binary(data, "count"); }),
+	    "huge section count"
+	);
+}
+
+static void check_nan(const aircraft_def &su34) {
+	check(su34.validate().empty(), "su34 is valid");
+
+	auto rejects = [&](const char *what, auto &&poison) {
+		aircraft_def def = su34;
+		poison(def);
+		check(!def.validate().empty(), std::string("NaN ") + what);
+	};
+	rejects("empty_mass", [](auto &d) { d.mass.empty_mass = NAN; });
+	rejects("inertia", [](auto &d) { d.mass.inertia.y = NAN; });
+	rejects("fuel_inertia", [](auto &d) { d.mass.fuel_inertia.z = NAN; });
+	rejects("center_of_mass", [](auto &d) { d.mass.center_of_mass.x = NAN; });
+	rejects("max_thrust", [](auto &d) { d.engine.max_thrust_wet = NAN; });
+	rejects("throttle_rate", [](auto &d) { d.engine.throttle_rate = NAN; });
+	rejects("tsfc", [](auto &d) { d.engine.tsfc_dry = NAN; });
+	rejects("curve_max_cl", [](auto &d) { d.airfoils[0].curve_max_cl = NAN; });
+	rejects("base_cd", [](auto &d) { d.airfoils[0].base_cd = NAN; });
+	rejects("span_efficiency", [](auto &d) {
+		d.wings[0].span_efficiency = NAN;
+	});
+	rejects("span", [](auto &d) { d.sections[0].span = NAN; });
+	rejects("incidence_axis", [](auto &d) {
+		d.surfaces[0].incidence_axis = glm::vec3(NAN);
+	});
+	rejects("mix gain", [](auto &d) {
+		d.surfaces[0].mix[aircraft_def::channel_aileron].gains[0] = NAN;
+	});
+}
+
+static void check_coeff_table(const aircraft_def &su34) {
+	auto table = [&](uint32_t aoa, uint32_t flap, uint32_t slat) {
+		aircraft_def def = su34;
+		def.airfoils[0].coeff_table[0] = aoa;
+		def.airfoils[0].coeff_table[1] = flap;
+		def.airfoils[0].coeff_table[2] = slat;
+		return def;
+	};
+	check(table(241, 3, 10).validate().empty(), "su34's own table");
+	check(!table(241, 1, 10).validate().empty(), "1 flap point");
+	check(!table(4097, 2, 2).validate().empty(), "4097 aoa points");
+	check(!table(4096, 4096, 4096).validate().empty(), "4096^3 entries");
+	check(!table(0xffffffff, 2, 2).validate().empty(), "uint32 max");
+
+	// and a binary can't get one past load_from_binary()
+	std::vector<uint8_t> huge = table(4096, 4096, 4096).save_to_binary();
+	check(
+	    throws([&] { aircraft_def().load_from_binary(huge, "huge"); }),
+	    "huge table in a binary"
+	);
+}
+
+static void check_mix_controls(const aircraft_def &su34) {
+	std::array<float, aircraft_def::num_inputs> inputs = {};
+	std::vector<aero_model::surface_controls>   out(su34.surfaces.size());
+	check(
+	    !throws([&] { su34.mix_controls<float>(inputs, out); }),
+	    "controls for every surface"
+	);
+	out.pop_back();
+	check(
+	    throws([&] { su34.mix_controls<float>(inputs, out); }),
+	    "too few controls"
+	);
+}
+
+int main() {
+	aircraft_def su34;
+	su34.load_from_file("aircraft/su34.acb");
+	check_binary(su34);
+	check_nan(su34);
+	check_coeff_table(su34);
+	check_mix_controls(su34);
+	return check_result();
+}
@@ -0,0 +1,82 @@
+// A physics step must not touch the heap, the realtime sim thread relies on
+// it (see sim/allocation_guard.hpp). Flies su34 to a steady state with every
+// integrator, then counts the allocations of a thousand more steps, and does
+// the same for a fleet stepped over a pool.
+
+#include "check.hpp"
+
+#include "dynamics/jet_model.hpp"
+#include "fleet/fleet.hpp"
+#include "sim/allocation_guard.hpp"
+
+static void check_steps(integrator::method method, const char *name) {
+	jet_model model;
+	model.init("aircraft/su34.acb");
+	model.set_integrator(method);
+
+	rigid_body start;
+	start.pos = glm::vec3(0.0f, 0.0f, 5000.0f);
+	start.vel = glm::vec3(250.0f, 0.0f, 0.0f);
+	model.set_body(start);
+
+	// some stick, so every surface deflects
+	control_input input;
+	input.throttle   = 0.8f;
+	input.pitch_down = -0.1f;
+	input.roll_right = 0.2f;
+
+	const float dt = 0.001f;
+	for (int i = 0; i < 100; ++i) {
+		model.update_physics_from_input(input, dt);
+	}
+
+	allocation_guard guard;
+	for (int i = 0; i < 1000; ++i) {
+		model.update_physics_from_input(input, dt);
+	}
+	uint64_t allocations = guard.get_allocations();
+
+	check(
+	    allocations == 0,
+	    std::string(name) + ": " + std::to_string(allocations) +
+	        " allocations in 1000 steps"
+	);
+}
+
+// The fleet the same, on the calling thread, the one the guard sees: that's
+// where parallel_for() would copy its callable, and where thread 0 works.
+static void check_fleet_steps() {
+	fleet f;
+	f.init("aircraft/su34.acb", 256);
+	fleet_inputs inputs;
+	inputs.resize(f.size());
+	for (size_t i = 0; i < f.size(); ++i) {
+		rigid_body start;
+		start.pos = glm::vec3(0.0f, float(i) * 100.0f, 5000.0f);
+		start.vel = glm::vec3(250.0f, 0.0f, 0.0f);
+		f.set_body(i, start);
+		inputs.throttle[i] = 0.8f;
+	}
+
+	work_stealing_pool pool(4);
+	f.step(inputs, 0.001f, pool);
+
+	allocation_guard guard;
+	for (int i = 0; i < 100; ++i) {
+		f.step(inputs, 0.001f, pool);
+	}
+	uint64_t allocations = guard.get_allocations();
+
+	check(
+	    allocations == 0,
+	    "fleet: " + std::to_string(allocations) + " allocations in 100 steps"
+	);
+}
+
+int main() {
+	check_steps(integrator::method::semi_implicit_euler, "euler");
+	check_steps(integrator::method::rk4, "rk4");
+	check_steps(integrator::method::rk45, "rk45");
+	check_fleet_steps();
+	return check_result();
+}
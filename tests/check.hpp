@@ -0,0 +1,48 @@
+#pragma once
+
+#include "dynamics/pch.hpp"
+
+#include <source_location>
+
+// Bare-bones checks for the test executables, run by ctest. A failed check
+// prints where and why and the test carries on, main() returns
+// check_result() so any failure fails the run.
+inline int num_failed_checks = 0;
+
+inline bool check(
+    bool                        ok,
+    const std::string          &what,
+    const std::source_location &where = std::source_location::current()
+) {
+	if (!ok) {
+		++num_failed_checks;
+		std::cerr << where.file_name() << ":" << where.line()
+		          << ": check failed: " << what << std::endl;
+	}
+	return ok;
+}
+
+// |actual - expected| <= tolerance, NaN never passes
+inline bool check_near(
+    double                      actual,
+    double                      expected,
+    double                      tolerance,
+    const std::string          &what,
+    const std::source_location &where = std::source_location::current()
+) {
+	if (std::abs(actual - expected) <= tolerance) {
+		return true;
+	}
+	std::ostringstream msg;
+	msg << what << ": " << actual << " vs " << expected << " (tolerance "
+	    << tolerance << ")";
+	return check(false, msg.str(), where);
+}
+
+inline int check_result() {
+	if (num_failed_checks > 0) {
+		std::cerr << num_failed_checks << " check(s) failed" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,166 @@
+// curve interpolation: the spline goes through its control points, the
+// derivative matches finite differences of sample(), sample_many() matches
+// sample() in every kernel and its tail, one-sample curves are refused
+
+#include "check.hpp"
+
+#include "curves/su34_lift_aoa.hpp"
+#include "dynamics/curve.hpp"
+
+static const auto &table = embedded_curves::su34_lift_aoa;
+
+// su34's lift curve in the ranges airfoil gives it
+static curve make_curve(
+    curve::interpolation   mode,
+    curve::spline_boundary boundary = curve::spline_boundary::natural
+) {
+	curve c;
+	c.load_from_table(table);
+	c.set_x_range(-30.0f, 30.0f);
+	c.set_y_range(-2.4f, 2.4f);
+	c.set_interpolation(mode, boundary);
+	return c;
+}
+
+static void check_spline_through_control_points() {
+	for (auto boundary :
+	     {curve::spline_boundary::natural, curve::spline_boundary::not_a_knot}
+	) {
+		curve c = make_curve(curve::interpolation::cubic_spline, boundary);
+		for (const curve::control_point &p : table.control_pts) {
+			double x = glm::mix(double(c.x_min), double(c.x_max), p.x);
+			double y = glm::mix(double(c.y_min), double(c.y_max), p.y);
+			check_near(c.sample<double>(x), y, 1e-5, "spline at a knot");
+		}
+	}
+}
+
+// tools/spline_generator samples scipy's not-a-knot spline, so ours should
+// land on the stored samples too
+static void check_not_a_knot_reproduces_samples() {
+	curve spline = make_curve(
+	    curve::interpolation::cubic_spline, curve::spline_boundary::not_a_knot
+	);
+	curve  linear = make_curve(curve::interpolation::linear_samples);
+	size_t last   = table.samples.size() - 1;
+	for (size_t i = 0; i <= last; ++i) {
+		double x = glm::mix(-30.0, 30.0, double(i) / last);
+		check_near(
+		    spline.sample<double>(x),
+		    linear.sample<double>(x),
+		    1e-4,
+		    "spline at sample " + std::to_string(i)
+		);
+	}
+}
+
+static void check_derivative(curve::interpolation mode, double h) {
+	curve c = make_curve(mode);
+
+	// at the middle of every sample interval, so a central difference of
+	// the piecewise linear curve doesn't straddle a kink
+	size_t last = table.samples.size() - 1;
+	for (size_t i = 0; i < last; ++i) {
+		double x     = glm::mix(-30.0, 30.0, (i + 0.5) / last);
+		double slope = (c.sample<double>(x + h) - c.sample<double>(x - h)) /
+		               (2.0 * h);
+		check_near(
+		    c.sample_derivative<double>(x),
+		    slope,
+		    1e-6 + 1e-4 * std::abs(slope),
+		    "derivative at " + std::to_string(x) + " deg"
+		);
+	}
+
+	// clamped outside the range
+	check(c.sample_derivative(-31.0f) == 0.0f, "derivative below the range");
+	check(c.sample_derivative(31.0f) == 0.0f, "derivative above the range");
+}
+
+// sample_many() against sample() for batches of every length up to a few
+// vector widths, so each kernel's tail gets every remainder
+static void check_sample_many(curve::interpolation mode) {
+	curve c = make_curve(mode);
+
+	std::vector<float> inputs;
+	for (float x = -35.0f; x <= 35.0f; x += 0.37f) {
+		inputs.push_back(x);
+	}
+	const float specials[] = {
+	    NAN,
+	    -NAN,
+	    INFINITY,
+	    -INFINITY,
+	    -30.0f,
+	    30.0f,
+	    std::nextafter(30.0f, 0.0f),
+	    1e30f,
+	    -1e30f,
+	};
+	// spread out, so they show up in vector lanes and tails alike
+	for (size_t i = 0; i < std::size(specials); ++i) {
+		inputs.insert(inputs.begin() + i * 7, specials[i]);
+	}
+
+	// the documented bound, sample_many_max_ulp ULPs of the largest |y|
+	float y_abs     = std::max(std::abs(c.y_min), std::abs(c.y_max));
+	float ulp       = std::nextafter(y_abs, INFINITY) - y_abs;
+	float tolerance = curve::sample_many_max_ulp * ulp;
+
+	std::vector<float> out(inputs.size());
+	for (size_t length = 0; length <= 40; ++length) {
+		for (size_t begin : {size_t(0), size_t(3)}) {
+			std::span<const float> x(inputs.data() + begin, length);
+			std::fill(out.begin(), out.end(), NAN);
+			c.sample_many(x, std::span(out).first(length));
+			for (size_t i = 0; i < length; ++i) {
+				check_near(
+				    out[i],
+				    c.sample(x[i]),
+				    tolerance,
+				    "sample_many(" + std::to_string(x[i]) + "), " +
+				        std::to_string(i) + " of " + std::to_string(length)
+				);
+			}
+		}
+	}
+
+	// all of them at once, mostly in the widest kernel
+	c.sample_many(inputs, out);
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		check_near(out[i], c.sample(inputs[i]), tolerance, "batch");
+	}
+
+	// NaN lands on the low end of the range, like -inf
+	check(c.sample(NAN) == c.sample(-INFINITY), "sample(NaN)");
+	check(c.sample_derivative(NAN) == 0.0f, "sample_derivative(NaN)");
+}
+
+// a single sample has no interval to take a slope over; load_from_file()
+// accepts one, so the linear path must refuse it instead of reading past it
+static void check_one_sample() {
+	static const float samples[] = {0.5f};
+	curve              c;
+	c.load_from_memory(samples, nullptr);
+	c.set_x_range(-30.0f, 30.0f);
+	c.set_y_range(-2.4f, 2.4f);
+
+	bool threw = false;
+	try {
+		c.sample_derivative(0.0f);
+	} catch (const std::runtime_error &) {
+		threw = true;
+	}
+	check(threw, "sample_derivative() with one sample");
+}
+
+int main() {
+	check_spline_through_control_points();
+	check_not_a_knot_reproduces_samples();
+	check_derivative(curve::interpolation::linear_samples, 1e-3);
+	check_derivative(curve::interpolation::cubic_spline, 1e-3);
+	check_sample_many(curve::interpolation::linear_samples);
+	check_sample_many(curve::interpolation::cubic_spline);
+	check_one_sample();
+	return check_result();
+}
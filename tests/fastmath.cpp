@@ -0,0 +1,256 @@
+// fastmath.hpp against double precision libm: every fast_*() function in its
+// scalar, SSE2 and AVX2 forms (whichever the build has) stays within its
+// documented fast_*_max_error over the ranges the header states, and the
+// special cases it promises hold.
+
+#include "check.hpp"
+
+#include "dynamics/fastmath.hpp"
+
+#include <random>
+
+// one form of a fast_*() function over a batch, out[i] = f(y[i], x[i]).
+// Unary functions ignore y. Batches are a whole number of 8 lanes.
+using batch_fn = std::function<
+    void(std::span<const float>, std::span<const float>, std::span<float>)>;
+
+struct form {
+	const char *name;
+	batch_fn    run;
+};
+
+template <typename F> static form scalar_form(F f) {
+	return {"scalar", [f](auto y, auto x, auto out) {
+		        for (size_t i = 0; i < x.size(); ++i) {
+			        out[i] = f(y[i], x[i]);
+		        }
+	        }};
+}
+
+#if defined(__SSE2__)
+template <typename F> static form sse2_form(F f) {
+	return {"sse2", [f](auto y, auto x, auto out) {
+		        for (size_t i = 0; i < x.size(); i += 4) {
+			        _mm_storeu_ps(
+			            out.data() + i,
+			            f(_mm_loadu_ps(y.data() + i),
+			              _mm_loadu_ps(x.data() + i))
+			        );
+		        }
+	        }};
+}
+#endif
+
+#if defined(__AVX2__)
+template <typename F> static form avx2_form(F f) {
+	return {"avx2", [f](auto y, auto x, auto out) {
+		        for (size_t i = 0; i < x.size(); i += 8) {
+			        _mm256_storeu_ps(
+			            out.data() + i,
+			            f(_mm256_loadu_ps(y.data() + i),
+			              _mm256_loadu_ps(x.data() + i))
+			        );
+		        }
+	        }};
+}
+#endif
+
+// every form of name over the batch, within max_error of reference(y, x),
+// relative to it if asked
+template <typename Reference>
+static void check_forms(
+    const char               *name,
+    const std::vector<form>  &forms,
+    const std::vector<float> &y,
+    const std::vector<float> &x,
+    Reference               &&reference,
+    double                    max_error,
+    bool                      relative = false
+) {
+	std::vector<float> out(x.size());
+	for (const form &f : forms) {
+		f.run(y, x, out);
+		double worst = 0.0;
+		size_t at    = 0;
+		for (size_t i = 0; i < x.size(); ++i) {
+			double ref   = reference(double(y[i]), double(x[i]));
+			double error = std::abs(double(out[i]) - ref);
+			if (relative) {
+				error /= std::abs(ref);
+			}
+			// NaN counts as over the bound
+			if (!(error <= worst)) {
+				worst = error;
+				at    = i;
+			}
+		}
+		std::ostringstream what;
+		what << name << ' ' << f.name << ": error " << worst << " over "
+		     << max_error << " at y " << y[at] << ", x " << x[at];
+		check(worst <= max_error, what.str());
+	}
+}
+
+// n uniform samples of [lo, hi], both ends included, padded to whole lanes
+static std::vector<float> sweep(float lo, float hi, size_t n) {
+	std::vector<float> v;
+	for (size_t i = 0; i < n; ++i) {
+		v.push_back(lo + (hi - lo) * float(i) / float(n - 1));
+	}
+	v.back() = hi;
+	while (v.size() % 8 != 0) {
+		v.push_back(hi);
+	}
+	return v;
+}
+
+static void check_atan2() {
+	std::vector<form> forms = {
+	    scalar_form([](float y, float x) { return fast_atan2(y, x); }),
+#if defined(__SSE2__)
+	    sse2_form([](__m128 y, __m128 x) { return fast_atan2(y, x); }),
+#endif
+#if defined(__AVX2__)
+	    avx2_form([](__m256 y, __m256 x) { return fast_atan2(y, x); }),
+#endif
+	};
+
+	// around the circle at radii from 1e-30 to 1e30, plus both axes
+	std::mt19937                          rng(1);
+	std::uniform_real_distribution<float> angle(-3.2f, 3.2f);
+	std::uniform_real_distribution<float> exponent(-100.0f, 100.0f);
+	std::vector<float>                    y, x;
+	for (size_t i = 0; i < 400000; ++i) {
+		float a = angle(rng);
+		float r = std::exp2(exponent(rng));
+		y.push_back(r * std::sin(a));
+		x.push_back(r * std::cos(a));
+	}
+	for (float v : {1.0f, -1.0f, 1e-30f, -1e30f}) {
+		y.insert(y.end(), {v, 0.0f, v, -0.0f});
+		x.insert(x.end(), {0.0f, v, v, v});
+	}
+	check_forms(
+	    "fast_atan2",
+	    forms,
+	    y,
+	    x,
+	    [](double y, double x) { return std::atan2(y, x); },
+	    fast_atan2_max_error
+	);
+
+	// returns 0 for (0, 0) and keeps the sign of y
+	check(fast_atan2(0.0f, 0.0f) == 0.0f, "fast_atan2(0, 0)");
+	check(std::signbit(fast_atan2(-0.0f, 1.0f)), "fast_atan2(-0, 1)");
+	check(fast_atan2(-0.0f, -1.0f) < 0.0f, "fast_atan2(-0, -1)");
+
+	// the batched form, every tail length
+	std::vector<float> out(y.size());
+	for (size_t n = 0; n <= 20; ++n) {
+		std::span<const float> ys(y.data(), n), xs(x.data(), n);
+		fast_atan2_many(ys, xs, std::span(out).first(n));
+		for (size_t i = 0; i < n; ++i) {
+			check_near(
+			    out[i],
+			    fast_atan2(y[i], x[i]),
+			    fast_atan2_max_error,
+			    "fast_atan2_many, " + std::to_string(i) + " of " +
+			        std::to_string(n)
+			);
+		}
+	}
+}
+
+static void check_acos() {
+	std::vector<form> forms = {
+	    scalar_form([](float, float x) { return fast_acos(x); }),
+#if defined(__SSE2__)
+	    sse2_form([](__m128, __m128 x) { return fast_acos(x); }),
+#endif
+#if defined(__AVX2__)
+	    avx2_form([](__m256, __m256 x) { return fast_acos(x); }),
+#endif
+	};
+	std::vector<float> x = sweep(-1.0f, 1.0f, 400000);
+	check_forms(
+	    "fast_acos",
+	    forms,
+	    x,
+	    x,
+	    [](double, double x) { return std::acos(x); },
+	    fast_acos_max_error
+	);
+
+	// clamped to [-1, 1]
+	check_near(fast_acos(1.5f), 0.0f, fast_acos_max_error, "fast_acos(1.5)");
+	check_near(
+	    fast_acos(-1.5f), M_PI, fast_acos_max_error, "fast_acos(-1.5)"
+	);
+}
+
+static void check_cos() {
+	std::vector<form> forms = {
+	    scalar_form([](float, float x) { return fast_cos(x); }),
+#if defined(__SSE2__)
+	    sse2_form([](__m128, __m128 x) { return fast_cos(x); }),
+#endif
+#if defined(__AVX2__)
+	    avx2_form([](__m256, __m256 x) { return fast_cos(x); }),
+#endif
+	};
+	std::vector<float> x = sweep(-100.0f, 100.0f, 400000);
+	check_forms(
+	    "fast_cos",
+	    forms,
+	    x,
+	    x,
+	    [](double, double x) { return std::cos(x); },
+	    fast_cos_max_error
+	);
+}
+
+static void check_rsqrt() {
+	std::vector<form> forms = {
+	    scalar_form([](float, float x) { return fast_rsqrt(x); }),
+#if defined(__SSE2__)
+	    sse2_form([](__m128, __m128 x) { return fast_rsqrt(x); }),
+#endif
+#if defined(__AVX2__)
+	    avx2_form([](__m256, __m256 x) { return fast_rsqrt(x); }),
+#endif
+	};
+
+	// normal floats from 2^-126 to 2^127
+	std::mt19937                          rng(2);
+	std::uniform_real_distribution<float> exponent(-126.0f, 127.0f);
+	std::vector<float>                    x;
+	for (size_t i = 0; i < 400000; ++i) {
+		x.push_back(std::exp2(exponent(rng)));
+	}
+	check_forms(
+	    "fast_rsqrt",
+	    forms,
+	    x,
+	    x,
+	    [](double, double x) { return 1.0 / std::sqrt(x); },
+	    fast_rsqrt_max_rel_error,
+	    true
+	);
+
+	// a zero vector normalizes to NaN like glm::normalize()
+	check(std::isnan(fast_rsqrt(0.0f)), "fast_rsqrt(0)");
+	check(std::isnan(fast_normalize(glm::vec3(0.0f)).x), "normalize(0)");
+
+	glm::vec3 v = fast_normalize(glm::vec3(3.0f, -4.0f, 12.0f));
+	check_near(
+	    glm::length(v), 1.0f, 2.0f * fast_rsqrt_max_rel_error, "normalize"
+	);
+}
+
+int main() {
+	check_atan2();
+	check_acos();
+	check_cos();
+	check_rsqrt();
+	return check_result();
+}
@@ -0,0 +1,124 @@
+// Input files: what write_input() writes, read_inputs() reads back as the
+// same bits, subnormals included, e.g. a released stick the smoothing has
+// decayed to almost nothing. Hand-written rows may have blanks around fields.
+
+#include "check.hpp"
+
+#include "dynamics/input_source.hpp"
+
+static bool same_bits(float a, float b) {
+	return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+}
+
+static bool same_bits(double a, double b) {
+	return std::bit_cast<uint64_t>(a) == std::bit_cast<uint64_t>(b);
+}
+
+static void check_round_trip(const std::filesystem::path &path) {
+	const float floats[] = {
+	    0.0f,
+	    -0.0f,
+	    0.1f,
+	    -0.7f,
+	    1.12103877e-43f, // where a released stick's smoothing gets stuck
+	    std::numeric_limits<float>::denorm_min(),
+	    -std::numeric_limits<float>::denorm_min(),
+	    std::numeric_limits<float>::min() / 3.0f,
+	    std::numeric_limits<float>::min(),
+	    std::numeric_limits<float>::max(),
+	    std::numeric_limits<float>::lowest(),
+	};
+
+	std::vector<timed_input> written;
+	double                   time = 0.0;
+	for (float f : floats) {
+		timed_input row;
+		row.time               = time;
+		row.input.throttle     = f;
+		row.input.afterburner  = written.size() % 2 == 0;
+		row.input.pitch_down   = f;
+		row.input.roll_right   = -f;
+		row.input.rudder_left  = f;
+		row.input.flaps_down   = written.size() % 3 == 0;
+		row.input.debug_turn.x = f;
+		row.input.debug_turn.y = -f;
+		written.push_back(row);
+		time += 0.005;
+	}
+	{
+		std::ofstream out(path);
+		write_input_header(out);
+		for (const timed_input &row : written) {
+			write_input(out, row);
+		}
+	}
+
+	std::vector<timed_input> read;
+	try {
+		read = read_inputs(path);
+	} catch (const std::exception &e) {
+		check(false, std::string("read back: ") + e.what());
+		return;
+	}
+	if (!check(read.size() == written.size(), "row count")) {
+		return;
+	}
+	for (size_t i = 0; i < read.size(); ++i) {
+		const control_input &a = written[i].input;
+		const control_input &b = read[i].input;
+		std::ostringstream   what;
+		what << "row " << i << " (" << a.throttle << ")";
+		check(
+		    same_bits(written[i].time, read[i].time) &&
+		        same_bits(a.throttle, b.throttle) &&
+		        a.afterburner == b.afterburner &&
+		        same_bits(a.pitch_down, b.pitch_down) &&
+		        same_bits(a.roll_right, b.roll_right) &&
+		        same_bits(a.rudder_left, b.rudder_left) &&
+		        a.flaps_down == b.flaps_down &&
+		        same_bits(a.debug_turn.x, b.debug_turn.x) &&
+		        same_bits(a.debug_turn.y, b.debug_turn.y),
+		    what.str()
+		);
+	}
+}
+
+static void check_hand_written(const std::filesystem::path &path) {
+	{
+		std::ofstream out(path);
+		write_input_header(out);
+		out << "0, 0.5,0, -0.25,0,0,1,0,0\r\n"
+		    << "1.5 ,1,1,0,0.5 ,0,0,0,0 \r\n";
+	}
+	try {
+		std::vector<timed_input> rows = read_inputs(path);
+		check(rows.size() == 2, "hand-written row count");
+		check(rows[0].input.pitch_down == -0.25f, "blank before a field");
+		check(rows[1].time == 1.5, "blank after a field");
+		check(rows[1].input.afterburner, "afterburner");
+	} catch (const std::exception &e) {
+		check(false, std::string("hand-written: ") + e.what());
+	}
+
+	{
+		std::ofstream out(path);
+		write_input_header(out);
+		out << "0,0.5x,0,0,0,0,0,0,0\n";
+	}
+	bool threw = false;
+	try {
+		read_inputs(path);
+	} catch (const std::exception &) {
+		threw = true;
+	}
+	check(threw, "trailing garbage in a field");
+}
+
+int main() {
+	// in the build directory, like the aircraft the other tests load
+	std::filesystem::path path = "test_input_source.csv";
+	check_round_trip(path);
+	check_hand_written(path);
+	std::filesystem::remove(path);
+	return check_result();
+}
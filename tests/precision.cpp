@@ -0,0 +1,138 @@
+// Float against double: flies su34 through the same manoeuvres with
+// step_jet_body<float> and step_jet_body<double>, prints how far apart
+// position, velocity and attitude drift, and fails once the float flight
+// strays further than the bounds below. The double flight stands for the
+// exact one, so this is the error the float build flies with.
+
+#include "check.hpp"
+
+#include "dynamics/jet_model.hpp"
+
+// one aircraft's worth of dynamics in scalar type T
+template <typename T> struct precision_flight {
+	using vec3 = glm::vec<3, T>;
+
+	basic_aero_model<T>                  aero;
+	std::vector<jet_surface_controls<T>> controls;
+	basic_integrator<T>                  stepper;
+	basic_mass_properties<T>             mass;
+	basic_rigid_body<T>                  body;
+
+	explicit precision_flight(const aircraft_def &def)
+	    : aero(build_aero_model<T>(def)), mass(def.mass) {
+		controls.resize(aero.num_surfaces());
+		stepper.set_method(basic_integrator<T>::method::rk4);
+
+		body.pos = vec3(0, 0, 5000);
+		body.vel = vec3(250, 0, 0);
+	}
+
+	void step(
+	    const aircraft_def &def, const std::array<T, 4> &inputs, T dt
+	) {
+		def.mix_controls<T>(inputs, controls);
+		step_jet_body<T>(
+		    def.engine,
+		    aero,
+		    controls,
+		    T(0.8),
+		    false,
+		    stepper,
+		    body,
+		    mass,
+		    dt
+		);
+	}
+};
+
+struct manoeuvre {
+	const char *name;
+	// pitch, roll, yaw and flaps at t seconds
+	std::array<double, aircraft_def::num_inputs> (*inputs)(double t);
+	// largest allowed drift at the end, about 5x what a FAST_MATH build
+	// drifts, where float takes the fastmath.hpp kernels and double doesn't
+	double max_pos; // m
+	double max_rot; // deg
+};
+
+static void fly(const aircraft_def &def, const manoeuvre &m) {
+	const double duration = 60.0;
+	const double dt       = 0.005;
+
+	precision_flight<float>  f(def);
+	precision_flight<double> d(def);
+
+	std::cout << m.name << std::endl
+	          << "     t   |dpos| m  |dvel| m/s  drot deg" << std::endl;
+	double pos = 0.0, rot = 0.0;
+	size_t steps = static_cast<size_t>(std::round(duration / dt));
+	for (size_t i = 1; i <= steps; ++i) {
+		std::array<double, aircraft_def::num_inputs> in = m.inputs(i * dt);
+		d.step(def, in, dt);
+		f.step(
+		    def,
+		    {float(in[0]), float(in[1]), float(in[2]), float(in[3])},
+		    float(dt)
+		);
+
+		pos        = glm::length(glm::dvec3(f.body.pos) - d.body.pos);
+		double vel = glm::length(glm::dvec3(f.body.vel) - d.body.vel);
+		// angle of the rotation between the two, from its vector part, as
+		// acos() of the dot product drowns in the float norm error
+		glm::dquat delta = glm::normalize(glm::dquat(f.body.rot)) *
+		                   glm::conjugate(d.body.rot);
+		double sin_half =
+		    std::min(1.0, glm::length(glm::dvec3(delta.x, delta.y, delta.z)));
+		rot = glm::degrees(2.0 * std::asin(sin_half));
+		if (i % (steps / 6) == 0) {
+			std::cout << std::fixed << std::setprecision(0) << std::setw(6)
+			          << i * dt << std::setprecision(4) << std::setw(11)
+			          << pos << std::setw(12) << vel << std::setw(10) << rot
+			          << std::endl;
+		}
+	}
+
+	check(
+	    pos <= m.max_pos,
+	    std::string(m.name) + ": position drifted " + std::to_string(pos) +
+	        " m"
+	);
+	check(
+	    rot <= m.max_rot,
+	    std::string(m.name) + ": attitude drifted " + std::to_string(rot) +
+	        " deg"
+	);
+}
+
+int main() {
+	aircraft_def def;
+	def.load_from_file("aircraft/su34.acb");
+
+	const manoeuvre manoeuvres[] = {
+	    {
+	        "cruise",
+	        [](double) {
+		        return std::array<double, aircraft_def::num_inputs>{};
+	        },
+	        0.5,
+	        0.005,
+	    },
+	    {
+	        "weave", // rolling and pitching both ways
+	        [](double t) {
+		        return std::array<double, aircraft_def::num_inputs>{
+		            0.3 * std::sin(t * 0.7),
+		            0.5 * std::sin(t * 0.31),
+		            0.2 * std::cos(t * 0.13),
+		            0.0,
+		        };
+	        },
+	        2.0,
+	        0.05,
+	    },
+	};
+	for (const manoeuvre &m : manoeuvres) {
+		fly(def, m);
+	}
+	return check_result();
+}
@@ -0,0 +1,324 @@
+// Times one evaluation of all of an aircraft's lifting surfaces through
+// aero_model against the per-surface path it replaced, one
+// calc_wing_forces_3d() per surface. It also times the same airframe built
+// at compile time, the static_aero_model CMake generates from the aircraft
+// file of the same name (static_aircraft/<name>.hpp), where there's one.
+// All paths first fly the same set of states and control inputs, and the
+// run fails unless their forces and torques match to float rounding.
+//
+//   flight-sim-aero <aircraft> [--evals=<n>]
+
+#include "dynamics/pch.hpp"
+
+#include "dynamics/airfoil_registry.hpp"
+#include "dynamics/jet_model.hpp"
+
+#include "static_aircraft/registry.hpp"
+
+static void print_usage() {
+	std::cerr << "usage: flight-sim-aero <aircraft> [--evals=<n>]"
+	          << std::endl;
+}
+
+struct bench_options {
+	std::filesystem::path aircraft_path;
+	size_t                evals = 200000;
+};
+
+static bench_options parse_options(const std::vector<std::string> &args) {
+	if (args.empty() || args[0].starts_with("--")) {
+		throw std::runtime_error("No aircraft given.");
+	}
+
+	bench_options o;
+	o.aircraft_path = args[0];
+	for (size_t i = 1; i < args.size(); ++i) {
+		const std::string &arg = args[i];
+		if (arg.starts_with("--evals=")) {
+			o.evals = std::stoul(arg.substr(8));
+		} else {
+			throw std::runtime_error("Unknown option: " + arg);
+		}
+	}
+	if (o.evals == 0) {
+		throw std::runtime_error("Evals must be > 0.");
+	}
+	return o;
+}
+
+// one of the airfoils jet_model::init() registered
+static airfoil_handle get_airfoil(const aircraft_def &def, uint32_t index) {
+	airfoil_registry                &registry = airfoil_registry::shared();
+	const aircraft_def::airfoil_def &a        = def.airfoils[index];
+	return registry.get_airfoil(aircraft_def::get_airfoil_key(a), [&] {
+		return a.build(load_airfoil_curve(registry, a.curve));
+	});
+}
+
+// the surfaces of an aircraft as separate wings, evaluated one after another
+class per_surface_model {
+public:
+	explicit per_surface_model(const aircraft_def &def) {
+		for (const aircraft_def::surface_def &s : def.surfaces) {
+			const aircraft_def::wing_def &w    = def.wings[s.wing];
+			airfoil_handle                foil = get_airfoil(def, w.airfoil);
+			surfaces.push_back({
+			    .surface_wing =
+			        wing(foil, def.get_wing_sections(w), w.span_efficiency),
+			    .root_pos       = s.root_pos,
+			    .is_right_wing  = s.is_right_wing != 0,
+			    .incidence_axis = s.incidence_axis,
+			});
+			num_forces += wing_num_forces_3d(surfaces.back().surface_wing);
+		}
+		forces.resize(num_forces);
+	}
+
+	aero_model::totals evaluate(
+	    std::span<const aero_model::surface_controls> controls,
+	    glm::vec3                                     linear_velocity,
+	    glm::vec3                                     angular_velocity,
+	    glm::vec3                                     center_of_mass
+	) {
+		size_t offset = 0;
+		for (size_t s = 0; s < surfaces.size(); ++s) {
+			const mounted_wing                 &m = surfaces[s];
+			const aero_model::surface_controls &c = controls[s];
+			size_t n = wing_num_forces_3d(m.surface_wing);
+			calc_wing_forces_3d(
+			    m.surface_wing,
+			    linear_velocity,
+			    angular_velocity,
+			    center_of_mass,
+			    m.root_pos,
+			    glm::angleAxis(glm::radians(c.incidence_deg), m.incidence_axis),
+			    m.is_right_wing,
+			    c.aileron_deg,
+			    c.flap_deg,
+			    c.slat_deg,
+			    1.225f,
+			    scratch,
+			    std::span(forces).subspan(offset, n)
+			);
+			offset += n;
+		}
+
+		aero_model::totals result;
+		for (const wing_force_vec_3d &f : forces) {
+			result.force  += f.force;
+			result.torque += glm::cross(f.origin - center_of_mass, f.force);
+		}
+		return result;
+	}
+
+private:
+	struct mounted_wing {
+		wing      surface_wing;
+		glm::vec3 root_pos;
+		bool      is_right_wing;
+		glm::vec3 incidence_axis;
+	};
+
+	std::vector<mounted_wing>      surfaces;
+	size_t                         num_forces = 0;
+	wing_scratch                   scratch;
+	std::vector<wing_force_vec_3d> forces;
+};
+
+// a generated static_aero_model with the airfoils and buffers evaluate()
+// needs
+template <typename Model> class static_model_path {
+public:
+	static_model_path(const aircraft_def &def, const Model &model)
+	    : model(model) {
+		if (def.surfaces.size() != Model::num_surfaces) {
+			throw std::runtime_error(
+			    "The static model doesn't have the aircraft's surfaces."
+			);
+		}
+		for (uint32_t i = 0; i < def.airfoils.size(); ++i) {
+			foils.push_back(get_airfoil(def, i));
+			foil_ptrs.push_back(foils.back().get());
+		}
+	}
+
+	aero_model::totals evaluate(
+	    std::span<const aero_model::surface_controls> controls,
+	    glm::vec3                                     linear_velocity,
+	    glm::vec3                                     angular_velocity,
+	    glm::vec3                                     center_of_mass
+	) {
+		std::copy(controls.begin(), controls.end(), static_controls.begin());
+		return model.evaluate(
+		    foil_ptrs,
+		    static_controls,
+		    linear_velocity,
+		    angular_velocity,
+		    center_of_mass,
+		    forces
+		);
+	}
+
+private:
+	const Model                   &model;
+	std::vector<airfoil_handle>    foils;
+	std::vector<const airfoil *>   foil_ptrs;
+	typename Model::controls_array static_controls = {};
+	typename Model::forces_array   forces          = {};
+};
+
+// what the surfaces see in a step, body frame
+struct flight_state {
+	glm::vec3                                 linear_velocity;
+	glm::vec3                                 angular_velocity;
+	std::vector<aero_model::surface_controls> controls;
+};
+
+// from a stall on one side to the other, slipping and rotating, with the
+// sticks all over the place and the flaps in and out
+static std::vector<flight_state> make_states(const aircraft_def &def) {
+	std::vector<flight_state> states(64);
+	for (size_t i = 0; i < states.size(); ++i) {
+		float u     = static_cast<float>(i) / (states.size() - 1); // [0, 1]
+		float speed = 60.0f + 240.0f * u;
+		float aoa   = glm::radians(-20.0f + 45.0f * std::fmod(u * 7.0f, 1.0f));
+		float slip  = glm::radians(10.0f * std::sin(i * 1.3f));
+
+		flight_state &s   = states[i];
+		s.linear_velocity = speed * glm::vec3(
+		    std::cos(aoa) * std::cos(slip),
+		    std::sin(slip),
+		    -std::sin(aoa) * std::cos(slip)
+		);
+		s.angular_velocity = glm::vec3(
+		    0.5f * std::sin(i * 0.7f),
+		    0.3f * std::cos(i * 1.1f),
+		    0.2f * std::sin(i * 2.3f)
+		);
+
+		std::array<float, aircraft_def::num_inputs> inputs = {};
+		inputs[aircraft_def::input_pitch] = std::sin(i * 0.9f);
+		inputs[aircraft_def::input_roll]  = std::cos(i * 0.4f);
+		inputs[aircraft_def::input_yaw]   = std::sin(i * 1.7f);
+		inputs[aircraft_def::input_flaps] = static_cast<float>(i % 2);
+		s.controls.resize(def.surfaces.size());
+		def.mix_controls<float>(inputs, s.controls);
+	}
+	return states;
+}
+
+// |a - b| over |b|, with 1 N (N m) of slack for totals near zero
+static float difference(glm::vec3 a, glm::vec3 b) {
+	return glm::length(a - b) / (glm::length(b) + 1.0f);
+}
+
+template <typename F>
+static double time_evals(
+    const std::vector<flight_state> &states, size_t evals, F &&evaluate
+) {
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < evals; ++i) {
+		evaluate(states[i % states.size()]);
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() /
+	       static_cast<double>(evals);
+}
+
+int main(int argc, char **argv) {
+	std::vector<std::string> args(argv + 1, argv + argc);
+	bench_options            o;
+	try {
+		o = parse_options(args);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		print_usage();
+		return 2;
+	}
+
+	try {
+		jet_model model;
+		model.init(o.aircraft_path);
+		const aircraft_def &def = model.get_def();
+		glm::vec3           com = def.mass.center_of_mass;
+
+		aero_model                aero = model.get_aero();
+		per_surface_model         per_surface(def);
+		std::vector<flight_state> states = make_states(def);
+
+		std::cout << def.name << ": " << aero.num_surfaces() << " surfaces, "
+		          << aero.num_sections() << " sections, " << states.size()
+		          << " states" << std::endl;
+
+		// every path sees the same states, in the same order; a NaN or
+		// infinite force on either side counts as a mismatch
+		auto check_matches = [&](const char *name, auto &path) {
+			const float tolerance  = 1e-4f;
+			float       max_force  = 0.0f, max_torque = 0.0f;
+			size_t      mismatches = 0;
+			for (const flight_state &s : states) {
+				aero_model::totals a = aero.evaluate(
+				    s.controls, s.linear_velocity, s.angular_velocity, com
+				);
+				aero_model::totals b = path.evaluate(
+				    s.controls, s.linear_velocity, s.angular_velocity, com
+				);
+				float force  = difference(a.force, b.force);
+				float torque = difference(a.torque, b.torque);
+				if (!(force <= tolerance && torque <= tolerance)) {
+					mismatches++;
+				}
+				max_force  = std::max(max_force, force);
+				max_torque = std::max(max_torque, torque);
+			}
+			std::cout << name << ": max difference " << max_force
+			          << " of the force, " << max_torque << " of the torque, "
+			          << mismatches << " states off" << std::endl;
+			if (mismatches > 0) {
+				throw std::runtime_error(
+				    std::string("aero_model doesn't match ") + name + "."
+				);
+			}
+		};
+		auto time_path = [&](auto &path) {
+			return time_evals(states, o.evals, [&](const flight_state &s) {
+				path.evaluate(
+				    s.controls, s.linear_velocity, s.angular_velocity, com
+				);
+			});
+		};
+
+		check_matches("per-surface", per_surface);
+		double per_surface_ns = time_path(per_surface);
+		double aero_ns        = time_path(aero);
+
+		// the model types differ per aircraft, so it's checked and timed
+		// where its type is known
+		std::optional<double> static_ns;
+		static_aircraft::find(
+		    o.aircraft_path.stem().string(),
+		    [&](const auto &model) {
+			    static_model_path path(def, model);
+			    check_matches("static", path);
+			    static_ns = time_path(path);
+		    }
+		);
+
+		std::cout << "path             ns/eval   speedup" << std::endl;
+		auto row = [&](const char *name, double ns) {
+			std::cout << std::left << std::setw(14) << name << std::right
+			          << std::fixed << std::setprecision(1) << std::setw(10)
+			          << ns << std::setprecision(2) << std::setw(10)
+			          << per_surface_ns / ns << std::endl;
+		};
+		row("per-surface", per_surface_ns);
+		row("aero_model", aero_ns);
+		if (static_ns) {
+			row("static", *static_ns);
+		}
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
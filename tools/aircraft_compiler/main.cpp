@@ -0,0 +1,175 @@
+// Validates an aircraft definition and writes its binary form. Airfoils with
+// a coeff_table get it baked and compared against the analytic model, the
+// error is printed so a table too coarse for the airfoil shows in the build.
+//
+// With --static it writes a header instead, the aircraft's surfaces as a
+// constexpr static_aero_model in namespace static_aircraft::<name>.
+//
+//   flight-sim-aircraft-compiler <input.aircraft> <output.acb>
+//   flight-sim-aircraft-compiler --check <input.aircraft>...
+//   flight-sim-aircraft-compiler --static <input.aircraft> <output.hpp> <name>
+
+#include "dynamics/pch.hpp"
+
+#include "dynamics/aircraft_def.hpp"
+#include "dynamics/airfoil_registry.hpp"
+#include "dynamics/jet_model.hpp"
+#include "dynamics/wing.hpp"
+
+static void print_usage() {
+	std::cerr << "usage: flight-sim-aircraft-compiler <input> <output>\n"
+	          << "       flight-sim-aircraft-compiler --check <input>...\n"
+	          << "       flight-sim-aircraft-compiler --static <input> "
+	             "<output.hpp> <name>"
+	          << std::endl;
+}
+
+// a float literal that reads back as the same float, e.g. "3.0f"
+static std::string float_literal(float x) {
+	std::ostringstream out;
+	out << std::setprecision(std::numeric_limits<float>::max_digits10) << x;
+	std::string text = out.str();
+	if (text.find_first_of(".e") == std::string::npos) {
+		text += ".0";
+	}
+	return text + "f";
+}
+
+static std::string vec3_literal(glm::vec3 v) {
+	return "{" + float_literal(v.x) + ", " + float_literal(v.y) + ", " +
+	       float_literal(v.z) + "}";
+}
+
+// The surfaces of def as static_wing and static_aero_model declarations,
+// wings and surfaces in definition order, so the model matches
+// build_aero_model(def) surface for surface.
+static void write_static_header(
+    const aircraft_def &def,
+    const std::string  &source,
+    const std::string  &name,
+    std::ostream       &out
+) {
+	out << std::boolalpha << "// generated from " << source
+	    << " by\n// flight-sim-aircraft-compiler --static, do not edit\n"
+	    << "#pragma once\n\n"
+	    << "#include \"dynamics/static_wing.hpp\"\n\n"
+	    << "namespace static_aircraft::" << name << " {\n";
+
+	for (size_t w = 0; w < def.wings.size(); ++w) {
+		const aircraft_def::wing_def    &wing = def.wings[w];
+		const aircraft_def::airfoil_def &foil = def.airfoils[wing.airfoil];
+		out << "\n// " << wing.name << ", airfoil " << foil.name << "\n"
+		    << "constexpr static_wing<" << wing.num_sections << "> wing_" << w
+		    << "(\n    {\n";
+		for (const wing_section &sec : def.get_wing_sections(wing)) {
+			out << "        wing_section{\n"
+			    << "            .span            = "
+			    << float_literal(sec.span) << ",\n"
+			    << "            .chord           = "
+			    << float_literal(sec.chord) << ",\n"
+			    << "            .chordwise_shift = "
+			    << float_literal(sec.chordwise_shift) << ",\n"
+			    << "            .has_aileron     = " << sec.has_aileron
+			    << ",\n"
+			    << "            .has_flap        = " << sec.has_flap << ",\n"
+			    << "            .has_slat        = " << sec.has_slat << ",\n"
+			    << "        },\n";
+		}
+		out << "    },\n"
+		    << "    " << float_literal(foil.sweep_deg) << ",\n"
+		    << "    " << float_literal(wing.span_efficiency) << "\n"
+		    << ");\n";
+	}
+
+	out << "\nconstexpr static_aero_model model(";
+	for (size_t i = 0; i < def.surfaces.size(); ++i) {
+		const aircraft_def::surface_def &surf = def.surfaces[i];
+		const aircraft_def::wing_def    &wing = def.wings[surf.wing];
+		out << (i == 0 ? "\n" : ",\n") << "    // " << surf.name << "\n"
+		    << "    static_surface<" << wing.num_sections << ">{\n"
+		    << "        wing_" << surf.wing << ",\n"
+		    << "        " << wing.airfoil << ",\n"
+		    << "        " << vec3_literal(surf.root_pos) << ",\n"
+		    << "        " << (surf.is_right_wing != 0) << ",\n"
+		    << "        " << vec3_literal(surf.incidence_axis) << ",\n"
+		    << "    }";
+	}
+	out << "\n);\n\n"
+	    << "using model_type = std::remove_const_t<decltype(model)>;\n\n"
+	    << "} // namespace static_aircraft::" << name << "\n";
+}
+
+static void report_coeff_tables(const aircraft_def &def) {
+	airfoil_registry registry;
+	for (const aircraft_def::airfoil_def &a : def.airfoils) {
+		if (a.coeff_table[0] == 0) {
+			continue;
+		}
+		airfoil built = a.build(load_airfoil_curve(registry, a.curve));
+		airfoil::coeff_table_error err = built.report_coeff_table_error();
+		std::cout << def.name << ": airfoil " << a.name << " coeff table "
+		          << a.coeff_table[0] << "x" << a.coeff_table[1] << "x"
+		          << a.coeff_table[2] << ", cl error max " << err.max_cl_error
+		          << " rms " << err.rms_cl_error << ", cd error max "
+		          << err.max_cd_error << " rms " << err.rms_cd_error
+		          << std::endl;
+	}
+}
+
+int main(int argc, char **argv) {
+	std::vector<std::string> args(argv + 1, argv + argc);
+	if (args.size() >= 2 && args[0] == "--check") {
+		int failed = 0;
+		for (size_t i = 1; i < args.size(); ++i) {
+			try {
+				aircraft_def def;
+				def.load_from_file(args[i]);
+				report_coeff_tables(def);
+				std::cout << args[i] << ": OK" << std::endl;
+			} catch (const std::exception &e) {
+				std::cerr << e.what() << std::endl;
+				failed++;
+			}
+		}
+		return failed == 0 ? 0 : 1;
+	}
+	if (args.size() == 4 && args[0] == "--static") {
+		try {
+			aircraft_def def;
+			def.load_from_file(args[1]);
+			if (def.surfaces.empty()) {
+				throw std::runtime_error(args[1] + " has no surfaces.");
+			}
+			std::ofstream file(args[2]);
+			write_static_header(def, args[1], args[3], file);
+			if (!file) {
+				throw std::runtime_error("Failed to write " + args[2]);
+			}
+		} catch (const std::exception &e) {
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+	if (args.size() != 2) {
+		print_usage();
+		return 2;
+	}
+
+	try {
+		aircraft_def def;
+		def.load_from_file(args[0]);
+		report_coeff_tables(def);
+		std::vector<uint8_t> data = def.save_to_binary();
+
+		std::ofstream file(args[1], std::ios::binary);
+		file.write(reinterpret_cast<const char *>(data.data()), data.size());
+		if (!file) {
+			throw std::runtime_error("Failed to write " + args[1]);
+		}
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
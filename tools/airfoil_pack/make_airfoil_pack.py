@@ -0,0 +1,117 @@
+"""
+Convert text curve files (as saved by tools/spline_generator) into a packed
+binary airfoil pack that src/dynamics/airfoil_pack.hpp memory-maps.
+
+Usage:
+    python make_airfoil_pack.py <output.afpk> <name>=<curve.txt>[:x_min:x_max:y_min:y_max] ...
+
+Example:
+    python make_airfoil_pack.py ../../curves/airfoils.afpk \\
+        su34_lift_aoa=../../curves/su34_lift_aoa.txt:-30:30:-2.4:2.4
+
+Ranges default to the ones jet uses for lift curves (+-30 deg, +-2.4 CL).
+"""
+
+import struct
+import sys
+
+MAGIC = b"AFPK"
+VERSION = 1
+HEADER_FMT = "<4sIII"
+ENTRY_FMT = "<48s8fIIQ"
+SAMPLE_ALIGN = 64
+DEFAULT_RANGES = (-30.0, 30.0, -2.4, 2.4)
+
+
+def load_curve_samples(path):
+    """Read the samples of a text curve file, skipping the control points"""
+    with open(path, "r") as f:
+        tokens = f.read().split()
+    num_control_points, num_samples = int(tokens[0]), int(tokens[1])
+    first_sample = 2 + 2 * num_control_points
+    samples = [float(t) for t in tokens[first_sample : first_sample + num_samples]]
+    if len(samples) != num_samples:
+        raise ValueError(f"{path}: expected {num_samples} samples, got {len(samples)}")
+    return samples
+
+
+def find_stall(samples, x_min, x_max, y_min, y_max):
+    """Return (max_x, max_y, min_x, min_y) of the curve in range units"""
+    n = len(samples)
+    i_max = max(range(n), key=lambda i: samples[i])
+    i_min = min(range(n), key=lambda i: samples[i])
+
+    def x_at(i):
+        return x_min + (x_max - x_min) * i / (n - 1)
+
+    def y_at(i):
+        return y_min + (y_max - y_min) * samples[i]
+
+    return x_at(i_max), y_at(i_max), x_at(i_min), y_at(i_min)
+
+
+def parse_arg(arg):
+    name, _, spec = arg.partition("=")
+    if not name or not spec:
+        raise ValueError(f"Invalid curve argument: {arg}")
+    parts = spec.split(":")
+    path = parts[0]
+    ranges = tuple(float(p) for p in parts[1:]) if len(parts) > 1 else DEFAULT_RANGES
+    if len(ranges) != 4:
+        raise ValueError(f"Expected x_min:x_max:y_min:y_max in: {arg}")
+    if len(name.encode()) >= 48:
+        raise ValueError(f"Curve name too long (max 47 bytes): {name}")
+    return name, path, ranges
+
+
+def align(offset):
+    return (offset + SAMPLE_ALIGN - 1) // SAMPLE_ALIGN * SAMPLE_ALIGN
+
+
+def write_pack(out_path, curves):
+    header_size = struct.calcsize(HEADER_FMT)
+    entry_size = struct.calcsize(ENTRY_FMT)
+
+    entries = []
+    offset = align(header_size + entry_size * len(curves))
+    for name, samples, ranges in curves:
+        stall = find_stall(samples, *ranges)
+        entries.append((name, ranges, stall, len(samples), offset))
+        offset = align(offset + 4 * len(samples))
+
+    with open(out_path, "wb") as f:
+        f.write(struct.pack(HEADER_FMT, MAGIC, VERSION, len(curves), entry_size))
+        for name, ranges, stall, num_samples, sample_offset in entries:
+            f.write(
+                struct.pack(
+                    ENTRY_FMT,
+                    name.encode(),
+                    *ranges,
+                    *stall,
+                    num_samples,
+                    0,
+                    sample_offset,
+                )
+            )
+        for (_, samples, _), (*_, sample_offset) in zip(curves, entries):
+            f.write(b"\0" * (sample_offset - f.tell()))
+            f.write(struct.pack(f"<{len(samples)}f", *samples))
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+
+    curves = []
+    for arg in sys.argv[2:]:
+        name, path, ranges = parse_arg(arg)
+        curves.append((name, load_curve_samples(path), ranges))
+        print(f"  {name}: {path} ({len(curves[-1][1])} samples)")
+
+    write_pack(sys.argv[1], curves)
+    print(f"Wrote {len(curves)} curves to {sys.argv[1]}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,215 @@
+// Steps a fleet of one aircraft type on 1, 2, 4, ... threads up to all of
+// them and reports aircraft-steps per second at each, to see how the fleet
+// engine scales with cores. With --scripted, every aircraft also flies a
+// scenario script, flights of four climbing out in formation, to see what
+// scripted traffic adds.
+//
+//   flight-sim-fleet <aircraft> [--count=<n>] [--steps=<n>] [--step=<s>]
+//                    [--threads=<n>] [--integrator=euler|rk4] [--scripted]
+
+#include "dynamics/pch.hpp"
+
+#include "fleet/fleet.hpp"
+#include "script/script_director.hpp"
+
+static void print_usage() {
+	std::cerr << "usage: flight-sim-fleet <aircraft> [--count=<n>] "
+	             "[--steps=<n>] [--step=<s>]\n"
+	          << "           [--threads=<n>] [--integrator=euler|rk4] "
+	             "[--scripted]"
+	          << std::endl;
+}
+
+struct bench_options {
+	std::filesystem::path aircraft_path;
+	size_t                count       = 10000;
+	size_t                steps       = 200;
+	float                 step        = 1.0f / 1000.0f;
+	size_t                max_threads = 0; // all hardware threads
+	integrator::method    method = integrator::method::semi_implicit_euler;
+	bool                  scripted = false;
+};
+
+static bench_options parse_options(const std::vector<std::string> &args) {
+	if (args.empty() || args[0].starts_with("--")) {
+		throw std::runtime_error("No aircraft given.");
+	}
+
+	bench_options o;
+	o.aircraft_path = args[0];
+	for (size_t i = 1; i < args.size(); ++i) {
+		const std::string &arg   = args[i];
+		size_t             eq    = arg.find('=');
+		std::string        key   = arg.substr(0, eq);
+		std::string        value = eq == std::string::npos
+		                               ? std::string()
+		                               : arg.substr(eq + 1);
+		if (key == "--count") {
+			o.count = std::stoul(value);
+		} else if (key == "--steps") {
+			o.steps = std::stoul(value);
+		} else if (key == "--step") {
+			o.step = std::stof(value);
+		} else if (key == "--threads") {
+			o.max_threads = std::stoul(value);
+		} else if (key == "--integrator" && value == "euler") {
+			o.method = integrator::method::semi_implicit_euler;
+		} else if (key == "--integrator" && value == "rk4") {
+			o.method = integrator::method::rk4;
+		} else if (key == "--scripted") {
+			o.scripted = true;
+		} else {
+			throw std::runtime_error("Unknown option: " + arg);
+		}
+	}
+	if (o.count == 0 || o.steps == 0 || o.step <= 0.0f) {
+		throw std::runtime_error("Count, steps and step must be > 0.");
+	}
+	return o;
+}
+
+// spread out and each on slightly different inputs, so no two aircraft take
+// quite the same path through the force model
+static void set_up(fleet &f, fleet_inputs &inputs, size_t count) {
+	inputs.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		float      u = static_cast<float>(i % 97) / 96.0f; // [0, 1]
+		rigid_body body;
+		body.pos = glm::vec3(
+		    static_cast<float>(i % 100) * 200.0f,
+		    static_cast<float>(i / 100) * 200.0f,
+		    1000.0f + 500.0f * u
+		);
+		body.vel = glm::vec3(120.0f + 100.0f * u, 0.0f, 0.0f);
+		f.set_body(i, body);
+
+		control_input input;
+		input.throttle   = 0.5f + 0.5f * u;
+		input.pitch_down = 0.2f * u - 0.1f;
+		input.roll_right = 0.1f * u;
+		inputs.set(i, input);
+	}
+}
+
+// the lead of a flight: climbs out, turns around and comes back down
+static script_task climb_out(agent a) {
+	a.hold_speed(220.0f);
+	a.climb_to(3000.0f);
+	co_await until_altitude(2950.0f);
+	a.turn_to(90.0f);
+	co_await until_heading(90.0f);
+	co_await wait(20.0);
+	a.turn_to(-90.0f);
+	co_await until_heading(-90.0f);
+	a.hold_speed(180.0f);
+	a.climb_to(1500.0f);
+	co_await until_altitude(1500.0f);
+}
+
+// the other three, in echelon behind the lead until it's done
+static script_task wingman(agent a, agent lead, glm::vec3 offset) {
+	a.follow(lead, offset);
+	co_await until_in_position(30.0f);
+	co_await wait(600.0);
+}
+
+static void set_up_scripts(script_director &director, size_t count) {
+	director.init(count);
+	for (size_t i = 0; i < count; ++i) {
+		size_t slot = i % 4;
+		agent  a    = director.get_agent(i);
+		if (slot == 0) {
+			director.run(i, climb_out(a));
+			continue;
+		}
+		float     side = slot % 2 ? 1.0f : -1.0f;
+		glm::vec3 offset(-50.0f * slot, side * 40.0f * slot, 0.0f);
+		director.run(i, wingman(a, director.get_agent(i - slot), offset));
+	}
+}
+
+// one step of the fleet, scripts first if there are any
+static void advance(
+    fleet              &f,
+    fleet_inputs       &inputs,
+    script_director    *scripts,
+    float               dt,
+    work_stealing_pool &pool
+) {
+	if (scripts) {
+		scripts->tick(f, inputs, dt, pool);
+	}
+	f.step(inputs, dt, pool);
+}
+
+int main(int argc, char **argv) {
+	std::vector<std::string> args(argv + 1, argv + argc);
+	bench_options            o;
+	try {
+		o = parse_options(args);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		print_usage();
+		return 2;
+	}
+
+	try {
+		size_t max_threads =
+		    o.max_threads
+		        ? o.max_threads
+		        : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		std::vector<size_t> thread_counts;
+		for (size_t n = 1; n < max_threads; n *= 2) {
+			thread_counts.push_back(n);
+		}
+		thread_counts.push_back(max_threads);
+
+		std::cout << o.count << " aircraft, " << o.steps << " steps of "
+		          << o.step * 1e3f << " ms, "
+		          << integrator::get_method_name(o.method)
+		          << (o.scripted ? ", scripted" : "") << std::endl;
+		std::cout << "threads  aircraft-steps/s   speedup  efficiency"
+		          << "     steals" << std::endl;
+
+		double base_rate = 0.0;
+		for (size_t n : thread_counts) {
+			fleet           f;
+			fleet_inputs    inputs;
+			script_director director;
+			f.init(o.aircraft_path, o.count);
+			f.set_integrator(o.method);
+			set_up(f, inputs, o.count);
+			if (o.scripted) {
+				set_up_scripts(director, o.count);
+			}
+
+			work_stealing_pool pool(n);
+			script_director   *scripts = o.scripted ? &director : nullptr;
+			// warm up, sizes the scratch
+			advance(f, inputs, scripts, o.step, pool);
+
+			auto start = std::chrono::steady_clock::now();
+			for (size_t s = 0; s < o.steps; ++s) {
+				advance(f, inputs, scripts, o.step, pool);
+			}
+			auto   end = std::chrono::steady_clock::now();
+			double seconds =
+			    std::chrono::duration<double>(end - start).count();
+
+			double rate = static_cast<double>(o.count * o.steps) / seconds;
+			if (n == 1) {
+				base_rate = rate;
+			}
+			double speedup = rate / base_rate;
+			std::cout << std::setw(7) << n << std::setw(18) << std::fixed
+			          << std::setprecision(0) << rate << std::setw(10)
+			          << std::setprecision(2) << speedup << std::setw(12)
+			          << speedup / static_cast<double>(n) << std::setw(11)
+			          << pool.get_steals() << std::defaultfloat << std::endl;
+		}
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
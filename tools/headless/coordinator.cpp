@@ -0,0 +1,336 @@
+#include "coordinator.hpp"
+
+#ifdef __linux__
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+// In front of the slots when they're backed by a file, so the file can be
+// read without the batch that wrote it. Padded to keep the slots aligned.
+struct result_file_header {
+	char     magic[8]    = {'F', 'S', 'R', 'E', 'S', 'U', 'L', 'T'};
+	uint32_t version     = 1;
+	uint32_t record_size = sizeof(scenario_result);
+	uint64_t count       = 0;
+	uint8_t  padding[40] = {};
+};
+static_assert(sizeof(result_file_header) == 64);
+
+// The result slots, in a file mapping or in anonymous shared memory, either
+// way inherited by forked workers and zeroed, i.e. pending, to begin with.
+class result_slots {
+public:
+	result_slots(const std::filesystem::path &path, size_t count)
+	    : count(count) {
+		size_t offset = path.empty() ? 0 : sizeof(result_file_header);
+		size          = offset + count * sizeof(scenario_result);
+
+		int fd = -1;
+		if (!path.empty()) {
+			fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+				if (fd >= 0) {
+					::close(fd);
+				}
+				throw std::runtime_error(
+				    "Failed to create result file: " + path.string()
+				);
+			}
+		}
+		int   flags = fd < 0 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED;
+		void *ptr   = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+		if (fd >= 0) {
+			::close(fd); // the mapping stays valid after close
+		}
+		if (ptr == MAP_FAILED) {
+			throw std::runtime_error("Failed to map the result slots.");
+		}
+		mapping = static_cast<uint8_t *>(ptr);
+
+		if (offset > 0) {
+			result_file_header header;
+			header.count = count;
+			std::memcpy(mapping, &header, sizeof(header));
+		}
+		slots = reinterpret_cast<scenario_result *>(mapping + offset);
+	}
+
+	~result_slots() {
+		munmap(mapping, size);
+	}
+
+	result_slots(const result_slots &)            = delete;
+	result_slots &operator=(const result_slots &) = delete;
+
+	scenario_result &operator[](size_t i) {
+		return slots[i];
+	}
+
+	std::vector<scenario_result> copy() const {
+		return std::vector<scenario_result>(slots, slots + count);
+	}
+
+private:
+	uint8_t         *mapping = nullptr;
+	size_t           size    = 0;
+	size_t           count   = 0;
+	scenario_result *slots   = nullptr;
+};
+
+// "0-3,8-11" to {0, 1, 2, 3, 8, 9, 10, 11}
+static std::vector<int> parse_cpu_list(const std::string &list) {
+	std::vector<int>  cpus;
+	std::stringstream stream(list);
+	std::string       range;
+	while (std::getline(stream, range, ',')) {
+		if (range.empty() || range == "\n") {
+			continue;
+		}
+		size_t dash  = range.find('-');
+		int    first = std::stoi(range.substr(0, dash));
+		int    last  = dash == std::string::npos
+		                   ? first
+		                   : std::stoi(range.substr(dash + 1));
+		for (int cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(cpu);
+		}
+	}
+	return cpus;
+}
+
+// CPUs of every NUMA node that has any, in node order, from sysfs. Empty if
+// sysfs doesn't say, memory-only nodes are left out.
+static std::vector<std::vector<int>> read_numa_nodes() {
+	std::vector<std::pair<int, std::vector<int>>> nodes;
+	std::error_code                                error;
+	for (const auto &entry : std::filesystem::directory_iterator(
+	         "/sys/devices/system/node", error
+	     )) {
+		std::string name = entry.path().filename().string();
+		if (!name.starts_with("node") || name.size() == 4 ||
+		    !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+			continue;
+		}
+		std::ifstream file(entry.path() / "cpulist");
+		std::string   list;
+		std::getline(file, list);
+		std::vector<int> cpus = parse_cpu_list(list);
+		if (!cpus.empty()) {
+			nodes.emplace_back(std::stoi(name.substr(4)), std::move(cpus));
+		}
+	}
+	std::sort(nodes.begin(), nodes.end());
+
+	std::vector<std::vector<int>> result;
+	for (auto &node : nodes) {
+		result.push_back(std::move(node.second));
+	}
+	return result;
+}
+
+static bool pin_process_to_cpus(const std::vector<int> &cpus) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int cpu : cpus) {
+		CPU_SET(cpu, &set);
+	}
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+// What a worker process does, runs the shard's scenarios that aren't
+// finished yet. A scenario that throws fails on its own, the shard goes on.
+static void run_shard(
+    const std::vector<scenario> &scenarios,
+    result_slots                &slots,
+    size_t                       shard,
+    size_t                       num_shards
+) {
+	for (size_t i = shard; i < scenarios.size(); i += num_shards) {
+		scenario_result &slot = slots[i];
+		if (slot.status != scenario_result::pending) {
+			continue;
+		}
+		slot.attempts++;
+
+		scenario_result result;
+		try {
+			result = run_scenario(scenarios[i], nullptr);
+		} catch (const std::exception &e) {
+			result        = scenario_result();
+			result.status = scenario_result::failed;
+			std::strncpy(result.error, e.what(), sizeof(result.error) - 1);
+		}
+		result.attempts = slot.attempts;
+
+		// everything else first, a worker dying in between leaves the
+		// slot pending
+		uint32_t status = result.status;
+		result.status   = scenario_result::pending;
+		slot            = result;
+		std::atomic_ref<uint32_t>(slot.status)
+		    .store(status, std::memory_order_release);
+	}
+}
+
+static std::string describe_exit(int status) {
+	if (WIFSIGNALED(status)) {
+		return "died of signal " + std::to_string(WTERMSIG(status)) + " (" +
+		       strsignal(WTERMSIG(status)) + ")";
+	}
+	return "exited with " + std::to_string(WEXITSTATUS(status));
+}
+
+// The scenario a dead worker was running: the slot of its shard that was
+// started but is still pending. None if it died between scenarios.
+static std::optional<size_t> find_in_flight(
+    const std::vector<scenario> &scenarios,
+    result_slots                &slots,
+    size_t                       shard,
+    size_t                       num_shards
+) {
+	for (size_t i = shard; i < scenarios.size(); i += num_shards) {
+		if (slots[i].status == scenario_result::pending &&
+		    slots[i].attempts > 0) {
+			return i;
+		}
+	}
+	return std::nullopt;
+}
+
+static bool has_pending(
+    const std::vector<scenario> &scenarios,
+    result_slots                &slots,
+    size_t                       shard,
+    size_t                       num_shards
+) {
+	for (size_t i = shard; i < scenarios.size(); i += num_shards) {
+		if (slots[i].status == scenario_result::pending) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<scenario_result> run_batch(
+    const std::vector<scenario> &scenarios, const batch_options &options
+) {
+	if (scenarios.empty()) {
+		return {};
+	}
+	size_t workers = options.workers
+	                     ? options.workers
+	                     : static_cast<size_t>(
+	                           std::max(sysconf(_SC_NPROCESSORS_ONLN), 1L)
+	                       );
+	workers = std::min(workers, scenarios.size());
+
+	result_slots slots(options.results_path, scenarios.size());
+
+	std::vector<std::vector<int>> nodes;
+	if (options.numa) {
+		nodes = read_numa_nodes();
+	}
+	std::cerr << scenarios.size() << " scenarios on " << workers
+	          << " workers";
+	if (nodes.size() > 1) {
+		std::cerr << " over " << nodes.size() << " NUMA nodes";
+	}
+	std::cerr << std::endl;
+
+	std::vector<int>                  idle_deaths(workers, 0);
+	std::unordered_map<pid_t, size_t> shard_of; // running workers
+	auto start_shard = [&](size_t shard) {
+		// nothing buffered gets written twice by the child
+		std::cout.flush();
+		std::cerr.flush();
+		pid_t pid = fork();
+		if (pid < 0) {
+			throw std::runtime_error("Failed to fork a worker.");
+		}
+		if (pid == 0) {
+			int code = 0;
+			try {
+				if (nodes.size() > 1) {
+					pin_process_to_cpus(nodes[shard % nodes.size()]);
+				}
+				run_shard(scenarios, slots, shard, workers);
+			} catch (...) {
+				code = 1;
+			}
+			// no destructors or atexit handlers of the coordinator's state
+			_exit(code);
+		}
+		shard_of[pid] = shard;
+	};
+
+	for (size_t shard = 0; shard < workers; ++shard) {
+		start_shard(shard);
+	}
+	while (!shard_of.empty()) {
+		int   status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::runtime_error("Lost track of the workers.");
+		}
+		auto it = shard_of.find(pid);
+		if (it == shard_of.end()) {
+			continue;
+		}
+		size_t shard = it->second;
+		shard_of.erase(it);
+
+		if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+			continue;
+		}
+		std::cerr << "worker of shard " << shard << " "
+		          << describe_exit(status);
+
+		// a scenario that keeps killing its worker fails on its own once
+		// out of retries, like one that throws, and the shard goes on
+		std::optional<size_t> in_flight =
+		    find_in_flight(scenarios, slots, shard, workers);
+		bool retry = true;
+		if (in_flight) {
+			scenario_result &slot = slots[*in_flight];
+			std::cerr << " in scenario " << *in_flight;
+			if (static_cast<int>(slot.attempts) > options.retries) {
+				std::string error = "worker " + describe_exit(status);
+				std::strncpy(slot.error, error.c_str(), sizeof(slot.error) - 1);
+				std::atomic_ref<uint32_t>(slot.status)
+				    .store(scenario_result::failed, std::memory_order_release);
+				std::cerr << ", failed after " << slot.attempts << " attempts";
+			}
+		} else {
+			retry = idle_deaths[shard]++ < options.retries;
+		}
+
+		if (!has_pending(scenarios, slots, shard, workers)) {
+			std::cerr << std::endl;
+		} else if (retry) {
+			std::cerr << ", restarting it" << std::endl;
+			start_shard(shard);
+		} else {
+			std::cerr << ", giving up on it" << std::endl;
+		}
+	}
+	return slots.copy();
+}
+
+#else
+
+std::vector<scenario_result>
+run_batch(const std::vector<scenario> &, const batch_options &) {
+	throw std::runtime_error("Batch runs need Linux.");
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "dynamics/pch.hpp"
+
+#include "scenario.hpp"
+
+// Settings for run_batch().
+struct batch_options {
+	size_t workers = 0;    // processes, 0 for one per online CPU
+	int    retries = 2;    // reruns of a scenario its worker died in
+	bool   numa    = true; // pin each worker to the CPUs of one node
+
+	// memory-mapped result file, left behind for later, or anonymous shared
+	// memory if empty
+	std::filesystem::path results_path;
+};
+
+// Runs scenarios in forked worker processes, scenario i in shard
+// i % workers, so a batch spreads over all sockets without the workers
+// sharing an allocator or anything else but the results.
+//
+// Results go into a shared mapping, one scenario_result slot per scenario,
+// each written by the one worker owning it with its status last. A worker
+// that dies, by signal or with a non-zero exit, is started again for what
+// its shard hasn't finished. The scenario it died in is run again up to
+// retries times, then marked failed so the rest of the shard still runs.
+// Deaths outside any scenario get retries restarts of the shard, slots still
+// pending after those are lost. With numa on a machine with more than one
+// node, workers go round-robin over the nodes, each pinned to its node's
+// CPUs, so memory it touches first is local to it.
+//
+// Linux only, throws elsewhere.
+std::vector<scenario_result> run_batch(
+    const std::vector<scenario> &scenarios, const batch_options &options
+);
@@ -0,0 +1,220 @@
+// Flies scenarios without a window, as fast as the CPU allows. Uses the same
+// model, integrators and task rates as the interactive sim, so a run here
+// matches a run there with the same input.
+//
+// One scenario writes its trajectory as CSV:
+//
+//   flight-sim-headless <aircraft> [options]
+//
+//   --duration=<s>          simulated time, 60 by default
+//   --step=<s>              physics step, 0.001 by default
+//   --integrator=<name>     euler, rk4 or rk45
+//   --altitude=<m>          level flight along +x to start with
+//   --speed=<m/s>
+//   --throttle=<0..1>       held for the whole run, like the inputs below
+//   --afterburner
+//   --flaps
+//   --pitch=<-1..1>         pitch down
+//   --roll=<-1..1>          roll right
+//   --rudder=<-1..1>        rudder left
+//   --replay=<file>         fly recorded inputs instead, see input_source.hpp
+//   --timeline=<file>       or input keyframes
+//   --record=<file>         write the inputs flown, for a later --replay,
+//                           in a batch <name>.<n>.<ext> for scenario n
+//   --sample-rate=<Hz>      CSV rows per simulated second, 10 by default
+//   --out=<file>            CSV path, stdout by default
+//
+// A batch runs one scenario per line of a file, each line options like the
+// above on top of those given on the command line, over worker processes.
+// It writes one CSV row of results per scenario, see coordinator.hpp:
+//
+//   flight-sim-headless <aircraft> --batch=<file> [options]
+//
+//   --workers=<n>           processes, one per CPU by default
+//   --retries=<n>           reruns of a scenario whose worker died, 2
+//   --results=<file>        keep the raw result slots in this file
+//   --no-numa               don't pin workers to NUMA nodes
+
+#include "dynamics/pch.hpp"
+
+#include "coordinator.hpp"
+#include "scenario.hpp"
+
+#include <set>
+
+static void print_usage() {
+	std::cerr << "usage: flight-sim-headless <aircraft> [--duration=<s>] "
+	             "[--step=<s>]\n"
+	          << "           [--integrator=euler|rk4|rk45] [--altitude=<m>] "
+	             "[--speed=<m/s>]\n"
+	          << "           [--throttle=<0..1>] [--afterburner] [--flaps]\n"
+	          << "           [--pitch=<-1..1>] [--roll=<-1..1>] "
+	             "[--rudder=<-1..1>]\n"
+	          << "           [--replay=<file> | --timeline=<file>] "
+	             "[--record=<file>]\n"
+	          << "           [--sample-rate=<Hz>] [--out=<file>]\n"
+	          << "       flight-sim-headless <aircraft> --batch=<file> "
+	             "[--workers=<n>] [--retries=<n>]\n"
+	          << "           [--results=<file>] [--no-numa] [scenario "
+	             "options] [--out=<file>]"
+	          << std::endl;
+}
+
+struct command_line {
+	scenario              base;
+	std::filesystem::path out_path;   // stdout if empty
+	std::filesystem::path batch_path; // one scenario if empty
+	batch_options         batch;
+};
+
+// throws on anything it doesn't know, main() prints the usage then
+static command_line parse_command_line(const std::vector<std::string> &args) {
+	if (args.empty() || args[0].starts_with("--")) {
+		throw std::runtime_error("No aircraft given.");
+	}
+
+	command_line c;
+	c.base.aircraft_path = args[0];
+	for (size_t i = 1; i < args.size(); ++i) {
+		const std::string &arg = args[i];
+		if (arg.starts_with("--out=")) {
+			c.out_path = arg.substr(6);
+		} else if (arg.starts_with("--batch=")) {
+			c.batch_path = arg.substr(8);
+		} else if (arg.starts_with("--workers=")) {
+			c.batch.workers = std::stoul(arg.substr(10));
+		} else if (arg.starts_with("--retries=")) {
+			c.batch.retries = std::stoi(arg.substr(10));
+		} else if (arg.starts_with("--results=")) {
+			c.batch.results_path = arg.substr(10);
+		} else if (arg == "--no-numa") {
+			c.batch.numa = false;
+		} else {
+			apply_scenario_option(c.base, arg);
+		}
+	}
+	check_scenario(c.base);
+	return c;
+}
+
+// "in.csv" for scenario 3 to "in.3.csv"
+static std::filesystem::path
+numbered_path(const std::filesystem::path &path, size_t index) {
+	std::filesystem::path result = path;
+	result.replace_filename(
+	    path.stem().string() + "." + std::to_string(index) +
+	    path.extension().string()
+	);
+	return result;
+}
+
+// One scenario per line, blank lines and # comments skipped. Workers run at
+// once, so no two scenarios may record to the same file: a --record on the
+// command line goes to a file per scenario, numbered like the results.
+static std::vector<scenario>
+read_batch(const std::filesystem::path &path, const scenario &base) {
+	std::ifstream file(path);
+	if (!file) {
+		throw std::runtime_error("Failed to open " + path.string());
+	}
+
+	std::vector<scenario> scenarios;
+	std::string           line;
+	for (int line_no = 1; std::getline(file, line); ++line_no) {
+		std::istringstream words(line.substr(0, line.find('#')));
+		scenario           s = base;
+		bool               empty = true;
+		try {
+			for (std::string word; words >> word;) {
+				apply_scenario_option(s, word);
+				empty = false;
+			}
+			check_scenario(s);
+		} catch (const std::exception &e) {
+			throw std::runtime_error(
+			    path.string() + ":" + std::to_string(line_no) + ": " +
+			    e.what()
+			);
+		}
+		if (empty) {
+			continue;
+		}
+		if (!s.record_path.empty() && s.record_path == base.record_path) {
+			s.record_path = numbered_path(base.record_path, scenarios.size());
+		}
+		scenarios.push_back(s);
+	}
+
+	std::set<std::filesystem::path> recorded;
+	for (const scenario &s : scenarios) {
+		if (!s.record_path.empty() && !recorded.insert(s.record_path).second) {
+			throw std::runtime_error(
+			    path.string() + ": more than one scenario records to " +
+			    s.record_path.string()
+			);
+		}
+	}
+	return scenarios;
+}
+
+// 0 if every scenario is done
+static int run_batch_file(const command_line &c, std::ostream &out) {
+	std::vector<scenario> scenarios = read_batch(c.batch_path, c.base);
+
+	auto start_time = std::chrono::steady_clock::now();
+	std::vector<scenario_result> results = run_batch(scenarios, c.batch);
+	auto end_time = std::chrono::steady_clock::now();
+
+	size_t done = 0;
+	write_result_header(out);
+	for (size_t i = 0; i < results.size(); ++i) {
+		write_result(out, i, results[i]);
+		done += results[i].status == scenario_result::done;
+	}
+	out.flush();
+
+	double wall = std::chrono::duration<double>(end_time - start_time).count();
+	std::cerr << done << " of " << results.size() << " scenarios done in "
+	          << wall << " s" << std::endl;
+	return done == results.size() ? 0 : 1;
+}
+
+static int run_one(const command_line &c, std::ostream &out) {
+	scenario_result r = run_scenario(c.base, &out);
+	std::cerr << c.base.duration << " s simulated in " << r.wall_seconds
+	          << " s, " << c.base.duration / r.wall_seconds
+	          << "x real time, " << r.steps << " steps with "
+	          << integrator::get_method_name(c.base.method) << std::endl;
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	std::vector<std::string> args(argv + 1, argv + argc);
+	command_line             c;
+	try {
+		c = parse_command_line(args);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		print_usage();
+		return 2;
+	}
+
+	try {
+		auto run = c.batch_path.empty() ? run_one : run_batch_file;
+		if (c.out_path.empty()) {
+			return run(c, std::cout);
+		}
+		std::ofstream file(c.out_path);
+		if (!file) {
+			throw std::runtime_error("Failed to open " + c.out_path.string());
+		}
+		int code = run(c, file);
+		if (!file) {
+			throw std::runtime_error("Failed to write " + c.out_path.string());
+		}
+		return code;
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,187 @@
+#include "scenario.hpp"
+
+#include "sim/rate_scheduler.hpp"
+
+static integrator::method parse_method(const std::string &name) {
+	if (name == "euler") {
+		return integrator::method::semi_implicit_euler;
+	}
+	if (name == "rk4") {
+		return integrator::method::rk4;
+	}
+	if (name == "rk45") {
+		return integrator::method::rk45;
+	}
+	throw std::runtime_error("Unknown integrator: " + name);
+}
+
+void apply_scenario_option(scenario &s, const std::string &arg) {
+	size_t      eq    = arg.find('=');
+	std::string key   = arg.substr(0, eq);
+	std::string value = eq == std::string::npos ? std::string()
+	                                            : arg.substr(eq + 1);
+	if (key == "--duration") {
+		s.duration = std::stod(value);
+	} else if (key == "--step") {
+		s.step = std::stod(value);
+	} else if (key == "--integrator") {
+		s.method = parse_method(value);
+	} else if (key == "--altitude") {
+		s.altitude = std::stof(value);
+	} else if (key == "--speed") {
+		s.speed = std::stof(value);
+	} else if (key == "--throttle") {
+		s.input.throttle = std::stof(value);
+	} else if (arg == "--afterburner") {
+		s.input.afterburner = true;
+	} else if (arg == "--flaps") {
+		s.input.flaps_down = true;
+	} else if (key == "--pitch") {
+		s.input.pitch_down = std::stof(value);
+	} else if (key == "--roll") {
+		s.input.roll_right = std::stof(value);
+	} else if (key == "--rudder") {
+		s.input.rudder_left = std::stof(value);
+	} else if (key == "--replay") {
+		s.replay_path = value;
+	} else if (key == "--timeline") {
+		s.timeline_path = value;
+	} else if (key == "--record") {
+		s.record_path = value;
+	} else if (key == "--sample-rate") {
+		s.sample_rate = std::stod(value);
+	} else {
+		throw std::runtime_error("Unknown option: " + arg);
+	}
+}
+
+void check_scenario(const scenario &s) {
+	if (s.duration <= 0.0 || s.step <= 0.0 || s.sample_rate <= 0.0) {
+		throw std::runtime_error("Duration, step and rate must be > 0.");
+	}
+	if (!s.replay_path.empty() && !s.timeline_path.empty()) {
+		throw std::runtime_error("Replay or timeline, not both.");
+	}
+}
+
+static void write_sample_header(std::ostream &out) {
+	out << "t,x,y,z,vx,vy,vz,roll,pitch,yaw,airspeed,g,throttle,fuel"
+	    << std::endl;
+}
+
+static float get_g(const jet_model &model) {
+	glm::vec3 accel = model.get_acceleration() + glm::vec3(0.0f, 0.0f, 9.81f);
+	return glm::length(accel) / 9.81f;
+}
+
+static void write_sample(std::ostream &out, double t, const jet_model &model) {
+	const rigid_body &body = model.get_body();
+	glm::vec3         rpy  = glm::degrees(glm::eulerAngles(body.rot));
+	out << t << ',' << body.pos.x << ',' << body.pos.y << ',' << body.pos.z
+	    << ',' << body.vel.x << ',' << body.vel.y << ',' << body.vel.z << ','
+	    << rpy.x << ',' << rpy.y << ',' << rpy.z << ','
+	    << glm::length(body.vel) << ',' << get_g(model) << ','
+	    << model.get_throttle() << ',' << model.get_mass().get_fuel() << '\n';
+}
+
+scenario_result run_scenario(const scenario &s, std::ostream *trajectory) {
+	check_scenario(s);
+
+	jet_model model;
+	model.init(s.aircraft_path);
+	model.set_integrator(s.method);
+
+	rigid_body start;
+	start.pos = glm::vec3(0.0f, 0.0f, s.altitude);
+	start.vel = glm::vec3(s.speed, 0.0f, 0.0f);
+	model.set_body(start);
+
+	// held inputs, a file's or, around either, a recorder of them
+	programmatic_input            held(s.input);
+	recorded_input                replay;
+	timeline_input                timeline;
+	std::optional<input_recorder> recorder;
+	input_source                 *source = &held;
+	if (!s.replay_path.empty()) {
+		replay.load(s.replay_path);
+		source = &replay;
+	} else if (!s.timeline_path.empty()) {
+		timeline.load(s.timeline_path);
+		source = &timeline;
+	}
+	if (!s.record_path.empty()) {
+		recorder.emplace(*source, s.record_path);
+		source = &*recorder;
+	}
+
+	scenario_result result;
+	result.min_altitude = s.altitude;
+
+	// the interactive sim's tasks and rates, with sampling in place of the
+	// telemetry printout, added first so a sample sees the state at its
+	// own time, before the steps due with it
+	rate_scheduler tasks;
+	if (trajectory) {
+		tasks.add_task("sample", s.sample_rate, [&](double) {
+			write_sample(*trajectory, tasks.get_time(), model);
+		});
+	}
+	tasks.add_task("control", 200.0, [&](double dt) {
+		float control_dt = static_cast<float>(dt);
+		model.update_controls(
+		    source->poll(tasks.get_time(), control_dt), control_dt
+		);
+	});
+	tasks.add_task("physics", 1.0 / s.step, [&](double dt) {
+		model.update_physics(static_cast<float>(dt));
+		result.steps++;
+		result.max_g = std::max(result.max_g, get_g(model));
+		result.min_altitude =
+		    std::min(result.min_altitude, model.get_body().pos.z);
+	});
+
+	if (trajectory) {
+		write_sample_header(*trajectory);
+	}
+	auto start_time = std::chrono::steady_clock::now();
+	tasks.run_until(s.duration);
+	auto end_time = std::chrono::steady_clock::now();
+	if (trajectory) {
+		write_sample(*trajectory, s.duration, model);
+		trajectory->flush();
+	}
+
+	const rigid_body &body = model.get_body();
+	result.sim_time        = s.duration;
+	result.wall_seconds =
+	    std::chrono::duration<double>(end_time - start_time).count();
+	result.pos    = body.pos;
+	result.vel    = body.vel;
+	result.rpy    = glm::degrees(glm::eulerAngles(body.rot));
+	result.fuel   = model.get_mass().get_fuel();
+	result.status = scenario_result::done;
+	return result;
+}
+
+void write_result_header(std::ostream &out) {
+	out << "scenario,status,attempts,t,x,y,z,vx,vy,vz,roll,pitch,yaw,"
+	       "airspeed,fuel,max_g,min_altitude,steps,wall_seconds,error"
+	    << std::endl;
+}
+
+void write_result(std::ostream &out, size_t index, const scenario_result &r) {
+	// still pending once the batch is over means its runs kept dying
+	static const char *const status_names[] = {"lost", "done", "failed"};
+
+	// the error is the last column, keep commas out of it
+	std::string error(r.error, strnlen(r.error, sizeof(r.error)));
+	std::replace(error.begin(), error.end(), ',', ';');
+
+	out << index << ',' << status_names[std::min(r.status, 2u)] << ','
+	    << r.attempts << ',' << r.sim_time << ',' << r.pos.x << ','
+	    << r.pos.y << ',' << r.pos.z << ',' << r.vel.x << ',' << r.vel.y
+	    << ',' << r.vel.z << ',' << r.rpy.x << ',' << r.rpy.y << ','
+	    << r.rpy.z << ',' << glm::length(r.vel) << ',' << r.fuel << ','
+	    << r.max_g << ',' << r.min_altitude << ',' << r.steps << ','
+	    << r.wall_seconds << ',' << error << '\n';
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "dynamics/pch.hpp"
+
+#include "dynamics/input_source.hpp"
+#include "dynamics/jet_model.hpp"
+
+// One headless run: aircraft, initial state, inputs and how long. The inputs
+// are held unless a replay or timeline file gives them.
+struct scenario {
+	std::filesystem::path aircraft_path;
+
+	double             duration    = 60.0;
+	double             step        = 1.0 / 1000.0;
+	double             sample_rate = 10.0; // trajectory rows per second
+	integrator::method method      = integrator::method::semi_implicit_euler;
+
+	float         altitude = 1000.0f;
+	float         speed    = 100.0f;
+	control_input input;
+
+	// see input_source.hpp, empty if not used
+	std::filesystem::path replay_path;   // recorded_input
+	std::filesystem::path timeline_path; // timeline_input
+	std::filesystem::path record_path;   // input_recorder of what's flown
+};
+
+// How a scenario ended up. Plain data of a fixed size, so a worker process
+// can write it straight into a shared result file, status last.
+struct scenario_result {
+	enum status_t : uint32_t { pending, done, failed };
+
+	uint32_t  status       = pending;
+	uint32_t  attempts     = 0; // runs started, more than 1 after a crash
+	uint64_t  steps        = 0;
+	double    sim_time     = 0.0;
+	double    wall_seconds = 0.0;
+	glm::vec3 pos          = glm::vec3(0.0f);
+	glm::vec3 vel          = glm::vec3(0.0f);
+	glm::vec3 rpy          = glm::vec3(0.0f); // degrees
+	float     fuel         = 0.0f;
+	float     max_g        = 0.0f;
+	float     min_altitude = 0.0f;
+	char      error[96]    = {}; // what() of a failed run, cut short
+};
+
+// Sets the scenario field one "--name=value" option stands for, throws for
+// options it doesn't know.
+void apply_scenario_option(scenario &s, const std::string &arg);
+
+// Throws for scenarios that can't run, e.g. a step of 0 or both a replay
+// and a timeline.
+void check_scenario(const scenario &s);
+
+// Flies the scenario, writing the trajectory as CSV if given a stream.
+scenario_result run_scenario(const scenario &s, std::ostream *trajectory);
+
+void write_result_header(std::ostream &out);
+void write_result(std::ostream &out, size_t index, const scenario_result &r);
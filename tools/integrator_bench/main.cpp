@@ -0,0 +1,179 @@
+// Accuracy against cost of the integrators on standard manoeuvres. Every
+// manoeuvre starts in level flight with the controls held, and is flown in
+// double with each method at a few step sizes. The position error at the end
+// is against RK4 at a step far below the others, the cost is the number of
+// loads evaluations. The engine burns no fuel here: mass_properties rebuilds
+// at step boundaries, which would add the same O(dt) error to every method.
+//
+//   flight-sim-integrators <aircraft> [--duration=<s>] [--reference=<s>]
+
+#include "dynamics/pch.hpp"
+
+#include "dynamics/jet_model.hpp"
+
+static void print_usage() {
+	std::cerr << "usage: flight-sim-integrators <aircraft> [--duration=<s>] "
+	             "[--reference=<s>]"
+	          << std::endl;
+}
+
+struct bench_options {
+	std::filesystem::path aircraft_path;
+	double                duration  = 10.0;   // s per manoeuvre
+	double                reference = 0.0001; // s, RK4 step of the reference
+};
+
+static bench_options parse_options(const std::vector<std::string> &args) {
+	if (args.empty() || args[0].starts_with("--")) {
+		throw std::runtime_error("No aircraft given.");
+	}
+
+	bench_options o;
+	o.aircraft_path = args[0];
+	for (size_t i = 1; i < args.size(); ++i) {
+		const std::string &arg = args[i];
+		if (arg.starts_with("--duration=")) {
+			o.duration = std::stod(arg.substr(11));
+		} else if (arg.starts_with("--reference=")) {
+			o.reference = std::stod(arg.substr(12));
+		} else {
+			throw std::runtime_error("Unknown option: " + arg);
+		}
+	}
+	if (!(o.duration > 0.0)) {
+		throw std::runtime_error("Duration must be > 0.");
+	}
+	if (!(o.reference > 0.0 && o.reference < 0.001)) {
+		throw std::runtime_error("Reference step must be in (0, 0.001) s.");
+	}
+	return o;
+}
+
+using integrator_d = basic_integrator<double>;
+
+struct manoeuvre {
+	const char *name;
+	// pitch, roll, yaw and flaps, held for the whole run
+	std::array<double, aircraft_def::num_inputs> inputs;
+	glm::dvec3                                   ang_vel; // rad/s at start
+};
+
+static const manoeuvre manoeuvres[] = {
+    {"cruise", {0.0, 0.0, 0.0, 0.0}, glm::dvec3(0.0)},
+    {"pull", {-0.6, 0.0, 0.0, 0.0}, glm::dvec3(0.0)},
+    {"roll+pull", {-0.6, 0.8, 0.0, 0.0}, glm::dvec3(0.0)},
+    // thrown into a spin about all three axes, the gyroscopic term at work
+    {"tumble", {0.0, 0.0, 0.0, 0.0}, glm::dvec3(2.0, 1.5, 1.0)},
+};
+
+struct run_result {
+	basic_rigid_body<double> body;
+	uint64_t                 evaluations = 0;
+	double                   wall_ms     = 0.0;
+};
+
+static run_result fly(
+    const aircraft_def             &def,
+    const basic_aero_model<double> &aero_template,
+    const manoeuvre                &m,
+    integrator_d::method            method,
+    double                          dt,
+    double                          duration
+) {
+	basic_aero_model<double>                  aero = aero_template;
+	std::vector<jet_surface_controls<double>> controls(aero.num_surfaces());
+	def.mix_controls<double>(m.inputs, controls);
+
+	integrator_d                  stepper(method);
+	basic_mass_properties<double> mass(def.mass);
+	basic_rigid_body<double>      body;
+	body.pos     = glm::dvec3(0.0, 0.0, 5000.0);
+	body.vel     = glm::dvec3(250.0, 0.0, 0.0);
+	body.ang_vel = m.ang_vel;
+
+	auto   start = std::chrono::steady_clock::now();
+	size_t steps = static_cast<size_t>(std::llround(duration / dt));
+	for (size_t i = 0; i < steps; ++i) {
+		step_jet_body<double>(
+		    def.engine, aero, controls, 0.8, false, stepper, body, mass, dt
+		);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	return {
+	    body,
+	    stepper.get_evaluations(),
+	    std::chrono::duration<double, std::milli>(end - start).count(),
+	};
+}
+
+int main(int argc, char **argv) {
+	std::vector<std::string> args(argv + 1, argv + argc);
+	bench_options            o;
+	try {
+		o = parse_options(args);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		print_usage();
+		return 2;
+	}
+
+	try {
+		aircraft_def def;
+		def.load_from_file(o.aircraft_path);
+		def.engine.tsfc_dry = 0.0f;
+		def.engine.tsfc_wet = 0.0f;
+		basic_aero_model<double> aero = build_aero_model<double>(def);
+
+		const integrator_d::method methods[] = {
+		    integrator_d::method::semi_implicit_euler,
+		    integrator_d::method::rk4,
+		    integrator_d::method::rk45,
+		};
+		const double steps[] = {0.001, 0.02, 0.05}; // s
+
+		std::cout << def.name << ", " << o.duration
+		          << " s per manoeuvre, position error in m against RK4 at "
+		          << o.reference * 1000.0 << " ms" << std::endl
+		          << std::endl
+		          << "manoeuvre   method                    1 ms     20 ms"
+		             "     50 ms   evals@20ms  ms@20ms"
+		          << std::endl;
+		for (const manoeuvre &m : manoeuvres) {
+			run_result reference = fly(
+			    def,
+			    aero,
+			    m,
+			    integrator_d::method::rk4,
+			    o.reference,
+			    o.duration
+			);
+			for (integrator_d::method method : methods) {
+				std::cout << std::left << std::setw(12)
+				          << (method == methods[0] ? m.name : "")
+				          << std::setw(22)
+				          << integrator_d::get_method_name(method)
+				          << std::right;
+				run_result at_20ms;
+				for (double dt : steps) {
+					run_result r =
+					    fly(def, aero, m, method, dt, o.duration);
+					double error =
+					    glm::length(r.body.pos - reference.body.pos);
+					std::cout << std::scientific << std::setprecision(1)
+					          << std::setw(10) << error;
+					if (dt == 0.02) {
+						at_20ms = r;
+					}
+				}
+				std::cout << std::setw(13) << at_20ms.evaluations << std::fixed
+				          << std::setprecision(1) << std::setw(9)
+				          << at_20ms.wall_ms << std::endl;
+			}
+		}
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}